@@ -1,3 +1,5 @@
+#include "transcode.hpp"
+
 #include <cereal/archives/binary.hpp>
 #include <cereal/archives/json.hpp>
 #include <cereal/archives/portable_binary.hpp>
@@ -10,10 +12,12 @@
 
 #include <algorithm>
 #include <cctype>
+#include <chrono>
 #include <iostream>
 #include <iterator>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace po = boost::program_options;
 
@@ -60,6 +64,28 @@ void print_serialized(const std::string& txt)
     std::cout << "BinaryOutputArchive:\n" << to_string<cereal::BinaryOutputArchive>(txt) << '\n';
     std::cout << "PortableBinaryOutputArchive:\n" << to_string<cereal::PortableBinaryOutputArchive>(txt) << '\n';
 }
+
+void print_profile(const cereal::Profile& profile)
+{
+    if (!cereal::Profile::enabled())
+    {
+        std::cout << "profiling is not compiled in, use app_profiled_exe (built with CEREAL_PROFILING=1)\n";
+        return;
+    }
+
+    std::cout << "Profile:\n";
+    profile.printFlat(std::cout);
+    std::cout << "Call tree:\n";
+    profile.printTree(std::cout);
+}
+
+void print_stats(const xzr::app::transcode_stats& stats, double seconds)
+{
+    std::cout << "transcoded " << stats.records << " records from " << stats.files << " files, " << stats.bytes_in
+              << " bytes in, " << stats.bytes_out << " bytes out, in " << seconds << " s\n";
+    std::cout << static_cast<double>(stats.records) / seconds << " records/s, "
+              << static_cast<double>(stats.bytes_in) / seconds / 1e6 << " MB/s\n";
+}
 } // namespace
 int main(int ac, char* av[])
 {
@@ -68,7 +94,19 @@ int main(int ac, char* av[])
     try
     {
         po::options_description desc("Allowed options");
-        desc.add_options()("help", "help message")("interactive", "serializes input in diffenrent formats");
+        desc.add_options()("help", "help message")("interactive", "serializes input in diffenrent formats")(
+            "profile", "prints where serializing spent its time, per type, after serializing")(
+            "batch",
+            po::value<std::vector<std::string>>()->multitoken(),
+            "transcodes the records of these files from --from to --to format, into --output-dir")(
+            "from",
+            po::value<std::string>()->default_value("binary"),
+            "format of the batch input: binary, portable_binary, json, xml or lines")(
+            "to",
+            po::value<std::string>()->default_value("json"),
+            "format of the batch output: binary, portable_binary, json or xml")(
+            "output-dir", po::value<std::string>()->default_value("."), "directory to write batch output to")(
+            "jobs", po::value<unsigned>()->default_value(0), "files to transcode at once, 0 for one per core");
 
         po::variables_map vm;
         po::store(po::parse_command_line(ac, av, desc), vm);
@@ -84,7 +122,28 @@ int main(int ac, char* av[])
             std::string txt{};
             std::getline(std::cin, txt);
 
+            cereal::Profile::reset();
             print_serialized(txt);
+
+            if (vm.count("profile"))
+                print_profile(cereal::Profile::collect());
+        }
+
+        if (vm.count("batch"))
+        {
+            const auto start = std::chrono::steady_clock::now();
+
+            cereal::Profile::reset();
+            const auto stats = xzr::app::transcode_files(vm["batch"].as<std::vector<std::string>>(),
+                                                         vm["output-dir"].as<std::string>(),
+                                                         xzr::app::parse_format(vm["from"].as<std::string>()),
+                                                         xzr::app::parse_format(vm["to"].as<std::string>()),
+                                                         vm["jobs"].as<unsigned>());
+
+            print_stats(stats, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+            if (vm.count("profile"))
+                print_profile(cereal::Profile::collect());
         }
     }
     catch (const std::exception& e)
@@ -0,0 +1,336 @@
+#include "transcode.hpp"
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/archives/binary_buffer.hpp>
+#include <cereal/archives/json.hpp>
+#include <cereal/archives/json_stream.hpp>
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/archives/xml_stream.hpp>
+#include <cereal/types/string.hpp>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace xzr
+{
+namespace app
+{
+namespace
+{
+namespace ipc = boost::interprocess;
+
+constexpr std::size_t output_buffer_size{std::size_t{1} << 20};
+
+/// \brief a read only, memory mapped file.
+class mapped_file
+{
+  public:
+    explicit mapped_file(const std::string& path)
+    {
+        // mapping an empty file fails, and there is nothing to map anyway
+        if (std::filesystem::file_size(path) == 0)
+            return;
+
+        region_ = ipc::mapped_region{ipc::file_mapping{path.c_str(), ipc::read_only}, ipc::read_only};
+        region_.advise(ipc::mapped_region::advice_sequential);
+    }
+
+    const char* data() const
+    {
+        return static_cast<const char*>(region_.get_address());
+    }
+
+    std::size_t size() const
+    {
+        return region_.get_size();
+    }
+
+  private:
+    ipc::mapped_region region_{};
+};
+
+/// \brief an input stream buffer reading from memory it does not own.
+///
+/// Can be repositioned, which the streaming JSON and XML archives use to scan ahead.
+class memory_buffer : public std::streambuf
+{
+  public:
+    memory_buffer(const char* data, std::size_t size)
+    {
+        auto begin = const_cast<char*>(data);
+        setg(begin, begin, begin + size);
+    }
+
+  protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+    {
+        if (!(which & std::ios_base::in))
+            return pos_type(off_type(-1));
+
+        const auto base = dir == std::ios_base::beg ? eback() : dir == std::ios_base::cur ? gptr() : egptr();
+        const auto pos = base - eback() + off;
+        if (pos < 0 || pos > egptr() - eback())
+            return pos_type(off_type(-1));
+
+        setg(eback(), eback() + pos, egptr());
+        return pos_type(pos);
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+    {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+};
+
+/// \brief calls f with each record of data, reusing one string for all of them.
+template <class F>
+void read_records(format from, const char* data, std::size_t size, F&& f)
+{
+    // archives that saved no records may have written nothing at all, not even their header
+    if (size == 0)
+        return;
+
+    std::string record{};
+
+    switch (from)
+    {
+    case format::binary:
+    {
+        cereal::BinaryBufferInputArchive ar{data, size};
+        while (ar.position() < size)
+        {
+            ar(record);
+            f(record);
+        }
+        return;
+    }
+    case format::portable_binary:
+    {
+        memory_buffer buffer{data, size};
+        std::istream str{&buffer};
+        cereal::PortableBinaryInputArchive ar{str};
+        while (buffer.sgetc() != std::streambuf::traits_type::eof())
+        {
+            ar(record);
+            f(record);
+        }
+        return;
+    }
+    case format::json:
+    {
+        memory_buffer buffer{data, size};
+        std::istream str{&buffer};
+        cereal::JSONStreamInputArchive ar{str};
+        while (ar.getNodeName())
+        {
+            ar(record);
+            f(record);
+        }
+        return;
+    }
+    case format::xml:
+    {
+        memory_buffer buffer{data, size};
+        std::istream str{&buffer};
+        cereal::XMLStreamInputArchive ar{str};
+        while (ar.getNodeName())
+        {
+            ar(record);
+            f(record);
+        }
+        return;
+    }
+    case format::lines:
+    {
+        const auto end = data + size;
+        for (auto begin = data; begin != end;)
+        {
+            const auto eol = std::find(begin, end, '\n');
+            record.assign(begin, eol);
+            if (!record.empty() && record.back() == '\r')
+                record.pop_back();
+            f(record);
+            begin = eol == end ? end : eol + 1;
+        }
+        return;
+    }
+    }
+}
+
+/// \brief writes each record read from data to str, returning how many there were.
+template <class OArchive, class... Options>
+std::uint64_t write_records(std::ostream& str, format from, const char* data, std::size_t size, Options&&... options)
+{
+    std::uint64_t records{};
+
+    OArchive ar{str, std::forward<Options>(options)...};
+    read_records(from, data, size, [&](const std::string& record) {
+        ar(record);
+        ++records;
+    });
+
+    return records;
+}
+} // namespace
+
+format parse_format(const std::string& name)
+{
+    for (auto f : {format::binary, format::portable_binary, format::json, format::xml, format::lines})
+        if (to_string(f) == name)
+            return f;
+
+    throw std::invalid_argument{"unknown format " + name};
+}
+
+std::string to_string(format f)
+{
+    switch (f)
+    {
+    case format::binary:
+        return "binary";
+    case format::portable_binary:
+        return "portable_binary";
+    case format::json:
+        return "json";
+    case format::xml:
+        return "xml";
+    case format::lines:
+        return "lines";
+    }
+
+    return "unknown";
+}
+
+transcode_stats transcode_file(const std::string& input, const std::string& output, format from, format to)
+{
+    const mapped_file in{input};
+
+    // the buffer has to be set before the file is opened to take effect
+    std::vector<char> buffer(output_buffer_size);
+    std::ofstream str{};
+    str.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    str.open(output, std::ios::binary);
+    if (!str)
+        throw std::runtime_error{"cannot open " + output};
+
+    transcode_stats stats{};
+    stats.files = 1;
+    stats.bytes_in = in.size();
+
+    switch (to)
+    {
+    case format::binary:
+        stats.records = write_records<cereal::BinaryOutputArchive>(str, from, in.data(), in.size());
+        break;
+    case format::portable_binary:
+        stats.records = write_records<cereal::PortableBinaryOutputArchive>(str, from, in.data(), in.size());
+        break;
+    case format::json:
+        stats.records = write_records<cereal::JSONOutputArchive>(
+            str, from, in.data(), in.size(), cereal::JSONOutputArchive::Options::NoIndent());
+        break;
+    case format::xml:
+        stats.records = write_records<cereal::XMLStreamOutputArchive>(str, from, in.data(), in.size());
+        break;
+    case format::lines:
+        throw std::invalid_argument{"lines can only be read, not written"};
+    }
+
+    str.close();
+    if (!str)
+        throw std::runtime_error{"cannot write " + output};
+
+    stats.bytes_out = std::filesystem::file_size(output);
+
+    return stats;
+}
+
+transcode_stats transcode_files(const std::vector<std::string>& inputs,
+                                const std::string& output_dir,
+                                format from,
+                                format to,
+                                unsigned jobs)
+{
+    if (to == format::lines)
+        throw std::invalid_argument{"lines can only be read, not written"};
+
+    // all outputs are chosen up front, so that no two jobs ever write the same file
+    std::vector<std::string> outputs{};
+    std::map<std::filesystem::path, std::string> written_by{};
+    for (const auto& input : inputs)
+    {
+        auto output = std::filesystem::path{output_dir} / std::filesystem::path{input}.filename();
+        output.replace_extension(to_string(to));
+        if (std::filesystem::exists(output) && std::filesystem::equivalent(output, input))
+            throw std::invalid_argument{"transcoding " + input + " would overwrite it"};
+
+        const auto written = written_by.emplace(std::filesystem::absolute(output).lexically_normal(), input);
+        if (!written.second)
+            throw std::invalid_argument{"transcoding " + written.first->second + " and " + input + " would both write "
+                                        + output.string()};
+
+        outputs.push_back(output.string());
+    }
+
+    if (jobs == 0)
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+    jobs = static_cast<unsigned>(std::min<std::size_t>(jobs, inputs.size()));
+
+    std::atomic<std::size_t> next{0};
+    std::mutex mutex{};
+    transcode_stats total{};
+    std::exception_ptr error{};
+
+    const auto work = [&] {
+        for (auto i = next++; i < inputs.size(); i = next++)
+        {
+            try
+            {
+                const auto stats = transcode_file(inputs[i], outputs[i], from, to);
+
+                const std::lock_guard<std::mutex> lock{mutex};
+                total.files += stats.files;
+                total.records += stats.records;
+                total.bytes_in += stats.bytes_in;
+                total.bytes_out += stats.bytes_out;
+            }
+            catch (...)
+            {
+                const std::lock_guard<std::mutex> lock{mutex};
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads{};
+    for (unsigned i = 1; i < jobs; ++i)
+        threads.emplace_back(work);
+    work();
+    for (auto& t : threads)
+        t.join();
+
+    if (error)
+        std::rethrow_exception(error);
+
+    return total;
+}
+} // namespace app
+} // namespace xzr
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace xzr
+{
+namespace app
+{
+/// \brief a file format records are read from or written to.
+enum class format
+{
+    binary,
+    portable_binary,
+    json,
+    xml,
+    lines ///< one record per line of text, for input only
+};
+
+/// \brief returns the format called name, as printed by to_string.
+///
+/// \throws std::invalid_argument if there is no such format
+format parse_format(const std::string& name);
+
+std::string to_string(format f);
+
+/// \brief what transcoding one or more files did.
+struct transcode_stats
+{
+    std::uint64_t files{};
+    std::uint64_t records{};
+    std::uint64_t bytes_in{};
+    std::uint64_t bytes_out{};
+};
+
+/// \brief reads the records of input in format from and writes them to output in format to.
+///
+/// Records are strings, as serialized by --interactive. The input is memory mapped and
+/// read sequentially, and the output is written through a large buffer, so that neither
+/// file has to fit into memory. The binary format is loaded from the mapping without
+/// copying it into a stream, JSON and XML are read with the streaming input archives.
+transcode_stats transcode_file(const std::string& input, const std::string& output, format from, format to);
+
+/// \brief transcodes each input to the file of the same name, with the extension of format to,
+/// in output_dir.
+///
+/// Up to jobs files are transcoded at once, on their own threads, or one per core if jobs
+/// is 0. If any file fails, the others are still transcoded before the first error is thrown.
+///
+/// \throws std::invalid_argument before transcoding anything if two inputs have the same
+/// file name, and so would be written to the same output, or an output would overwrite its input
+transcode_stats transcode_files(const std::vector<std::string>& inputs,
+                                const std::string& output_dir,
+                                format from,
+                                format to,
+                                unsigned jobs);
+} // namespace app
+} // namespace xzr
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/base_class.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/memory.hpp>
+#include <cereal/types/polymorphic.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace xzr
+{
+namespace bench
+{
+/// \brief a trivially copyable value, serialized as one block by the binary archives.
+struct point
+{
+    template <class Archive>
+    void serialize(Archive& ar)
+    {
+        ar(CEREAL_NVP(x), CEREAL_NVP(y), CEREAL_NVP(z), CEREAL_NVP(id));
+    }
+
+    float x{};
+    float y{};
+    float z{};
+    std::int32_t id{};
+};
+
+/// \brief a node of a graph whose nodes are shared between parents.
+struct node
+{
+    template <class Archive>
+    void serialize(Archive& ar)
+    {
+        ar(CEREAL_NVP(value), CEREAL_NVP(children));
+    }
+
+    std::int64_t value{};
+    std::vector<std::shared_ptr<node>> children{};
+};
+
+/// \brief the base of a polymorphic hierarchy.
+struct shape
+{
+    virtual ~shape() = default;
+
+    template <class Archive>
+    void serialize(Archive& ar)
+    {
+        ar(CEREAL_NVP(id));
+    }
+
+    std::int32_t id{};
+};
+
+struct circle : shape
+{
+    template <class Archive>
+    void serialize(Archive& ar)
+    {
+        ar(cereal::base_class<shape>(this), CEREAL_NVP(radius));
+    }
+
+    double radius{};
+};
+
+struct rectangle : shape
+{
+    template <class Archive>
+    void serialize(Archive& ar)
+    {
+        ar(cereal::base_class<shape>(this), CEREAL_NVP(width), CEREAL_NVP(height));
+    }
+
+    double width{};
+    double height{};
+};
+
+/// \brief a versioned class, whose version is written once per archive.
+struct record
+{
+    template <class Archive>
+    void serialize(Archive& ar, const std::uint32_t version)
+    {
+        ar(CEREAL_NVP(id), CEREAL_NVP(name));
+        if (version >= 2)
+            ar(CEREAL_NVP(score));
+    }
+
+    std::int32_t id{};
+    std::string name{};
+    double score{};
+};
+
+/// \brief the values every archive is benchmarked with.
+///
+/// Generated from a fixed seed, so the serialized sizes are the same on every run.
+struct data
+{
+    data();
+
+    std::vector<double> doubles{};
+    std::vector<std::int32_t> ints{};
+    std::vector<point> points{};
+    std::vector<std::string> strings{};
+    std::map<std::string, std::int32_t> map{};
+    std::vector<std::shared_ptr<node>> graph{};
+    std::vector<std::shared_ptr<shape>> shapes{};
+    std::vector<record> records{};
+};
+
+inline data::data()
+{
+    std::mt19937 gen{42};
+    const auto random_int = [&] { return std::uniform_int_distribution<std::int32_t>{}(gen); };
+    const auto random_double = [&] { return std::uniform_real_distribution<double>{-1e4, 1e4}(gen); };
+    const auto random_string = [&] {
+        std::string s(std::uniform_int_distribution<std::size_t>{3, 30}(gen), ' ');
+        for (char& c : s)
+            c = static_cast<char>(std::uniform_int_distribution<int>{'a', 'z'}(gen));
+        return s;
+    };
+
+    doubles.resize(16384);
+    for (auto& d : doubles)
+        d = random_double();
+
+    ints.resize(16384);
+    for (auto& i : ints)
+        i = random_int();
+
+    points.resize(4096);
+    for (auto& p : points)
+        p = {static_cast<float>(random_double()),
+             static_cast<float>(random_double()),
+             static_cast<float>(random_double()),
+             random_int()};
+
+    strings.resize(1024);
+    for (auto& s : strings)
+        s = random_string();
+
+    while (map.size() < 1024)
+        map.emplace(random_string(), random_int());
+
+    // ten layers of nodes, each node sharing two children from the next layer,
+    // so that serializing the graph does not recurse deeply
+    constexpr std::size_t layers{10};
+    constexpr std::size_t width{100};
+    for (std::size_t i = 0; i < layers * width; ++i)
+        graph.push_back(std::make_shared<node>(node{random_int(), {}}));
+    for (std::size_t layer = 0; layer + 1 < layers; ++layer)
+        for (std::size_t i = 0; i < width; ++i)
+            for (int child = 0; child < 2; ++child)
+                graph[layer * width + i]->children.push_back(
+                    graph[(layer + 1) * width + std::uniform_int_distribution<std::size_t>{0, width - 1}(gen)]);
+
+    for (std::size_t i = 0; i < 1024; ++i)
+    {
+        if (i % 2)
+        {
+            auto c = std::make_shared<circle>();
+            c->radius = random_double();
+            shapes.push_back(c);
+        }
+        else
+        {
+            auto r = std::make_shared<rectangle>();
+            r->width = random_double();
+            r->height = random_double();
+            shapes.push_back(r);
+        }
+        shapes.back()->id = random_int();
+    }
+
+    records.resize(1024);
+    for (auto& r : records)
+        r = {random_int(), random_string(), random_double()};
+}
+} // namespace bench
+} // namespace xzr
+
+CEREAL_MEMCPY_SERIALIZABLE(xzr::bench::point)
+CEREAL_CLASS_VERSION(xzr::bench::record, 2)
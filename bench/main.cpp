@@ -0,0 +1,326 @@
+#include "data.hpp"
+#include "measure.hpp"
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/archives/binary_buffer.hpp>
+#include <cereal/archives/delta.hpp>
+#include <cereal/archives/json.hpp>
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/archives/xml.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <istream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+CEREAL_REGISTER_TYPE(xzr::bench::circle)
+CEREAL_REGISTER_TYPE(xzr::bench::rectangle)
+
+namespace po = boost::program_options;
+
+namespace
+{
+using xzr::bench::result;
+
+struct runner
+{
+    std::string filter{};
+    double min_time{};
+    std::vector<result> results{};
+
+    bool selected(const std::string& name) const
+    {
+        return name.find(filter) != std::string::npos;
+    }
+
+    void add(result r)
+    {
+        std::printf("%-44s %12.0f ns/op %10.1f MB/s %10.1f allocs/op %10llu bytes\n",
+                    r.name.c_str(),
+                    r.ns_per_op,
+                    r.mb_per_s,
+                    r.allocs_per_op,
+                    static_cast<unsigned long long>(r.bytes));
+        std::fflush(stdout);
+
+        results.push_back(std::move(r));
+    }
+};
+
+/// \brief benchmarks saving value with OArchive and loading it back with IArchive.
+template <class OArchive, class IArchive, class T>
+void run(runner& r, const std::string& archive, const std::string& type, const T& value)
+{
+    const auto name = archive + "/" + type;
+    if (!r.selected(name + "/save") && !r.selected(name + "/load"))
+        return;
+
+    xzr::bench::output_buffer out{};
+    const auto save = [&] {
+        out.clear();
+        std::ostream str{&out};
+        OArchive ar{str};
+
+        ar(cereal::make_nvp(type, value));
+    };
+
+    const auto load = [&] {
+        xzr::bench::input_buffer in{out.data(), out.size()};
+        std::istream str{&in};
+        IArchive ar{str};
+
+        T loaded{};
+        ar(cereal::make_nvp(type, loaded));
+    };
+
+    save();
+    if (r.selected(name + "/save"))
+        r.add(xzr::bench::measure(name + "/save", out.size(), r.min_time, save));
+    if (r.selected(name + "/load"))
+        r.add(xzr::bench::measure(name + "/load", out.size(), r.min_time, load));
+}
+
+/// \brief benchmarks loading value with IArchive into a T that allocates from an arena.
+///
+/// T is the std::pmr counterpart of the type of value. The archive is given the arena too,
+/// so that loaded shared pointers allocate from it, and the arena is released after each
+/// load instead of freeing what was loaded piece by piece.
+template <class OArchive, class IArchive, class T, class U>
+void run_arena(runner& r, const std::string& archive, const std::string& type, const U& value)
+{
+    const auto name = archive + "/" + type + "_arena/load";
+    if (!r.selected(name))
+        return;
+
+    xzr::bench::output_buffer out{};
+    {
+        std::ostream str{&out};
+        OArchive ar{str};
+
+        ar(cereal::make_nvp(type, value));
+    }
+
+    std::pmr::monotonic_buffer_resource arena{};
+    const auto load = [&] {
+        {
+            xzr::bench::input_buffer in{out.data(), out.size()};
+            std::istream str{&in};
+            IArchive ar{str};
+            ar.setMemoryResource(&arena);
+
+            T loaded{&arena};
+            ar(cereal::make_nvp(type, loaded));
+        }
+        arena.release();
+    };
+
+    r.add(xzr::bench::measure(name, out.size(), r.min_time, load));
+}
+
+/// \brief benchmarks saving value with a compressed OArchive and loading it back with IArchive.
+///
+/// Compression runs on the calling thread only, so that the timings do not depend on how many
+/// hardware threads the machine has.
+template <class OArchive, class IArchive, class T>
+void run_compressed(runner& r, const std::string& archive, const std::string& type, const T& value)
+{
+    const auto name = archive + "/" + type;
+    if (!r.selected(name + "/save") && !r.selected(name + "/load"))
+        return;
+
+    const auto compression = cereal::Compression::LZ(1);
+
+    xzr::bench::output_buffer out{};
+    const auto save = [&] {
+        out.clear();
+        std::ostream str{&out};
+        OArchive ar{str, compression};
+
+        ar(cereal::make_nvp(type, value));
+    };
+
+    const auto load = [&] {
+        xzr::bench::input_buffer in{out.data(), out.size()};
+        std::istream str{&in};
+        IArchive ar{str, compression};
+
+        T loaded{};
+        ar(cereal::make_nvp(type, loaded));
+    };
+
+    save();
+    if (r.selected(name + "/save"))
+        r.add(xzr::bench::measure(name + "/save", out.size(), r.min_time, save));
+    if (r.selected(name + "/load"))
+        r.add(xzr::bench::measure(name + "/load", out.size(), r.min_time, load));
+}
+
+/// \brief benchmarks saving the change from value to changed as a delta, and applying it.
+///
+/// The archive saves value and changed in turn, so that each delta holds one change, while
+/// the full serialization still runs each time. Loading applies the deltas in the same order
+/// and loads the snapshot with a BinaryBufferInputArchive.
+template <class T>
+void run_delta(runner& r, const std::string& type, const T& value, const T& changed)
+{
+    const auto name = "binary_delta/" + type;
+    if (!r.selected(name + "/save") && !r.selected(name + "/load"))
+        return;
+
+    cereal::DeltaSnapshot saved{};
+    xzr::bench::output_buffer out[2]{};
+    std::size_t turn{};
+    const auto save = [&] {
+        auto& o = out[turn % 2];
+        o.clear();
+        std::ostream str{&o};
+        cereal::DeltaOutputArchive ar{str, saved};
+
+        ar(cereal::make_nvp(type, turn % 2 ? changed : value));
+        ++turn;
+    };
+
+    // the first delta holds everything, the two after it one change each, from value to
+    // changed and back, which loading applies in turn
+    cereal::DeltaSnapshot loaded{};
+    {
+        save();
+        xzr::bench::input_buffer in{out[0].data(), out[0].size()};
+        std::istream str{&in};
+        loaded.apply(str);
+    }
+    save();
+    save();
+    const std::vector<char> deltas[2]{{out[1].data(), out[1].data() + out[1].size()},
+                                      {out[0].data(), out[0].data() + out[0].size()}};
+
+    std::size_t applied{};
+    const auto load = [&] {
+        const auto& delta = deltas[applied++ % 2];
+        xzr::bench::input_buffer in{delta.data(), delta.size()};
+        std::istream str{&in};
+        loaded.apply(str);
+
+        cereal::BinaryBufferInputArchive ar{loaded.data()};
+        T result{};
+        ar(cereal::make_nvp(type, result));
+    };
+
+    if (r.selected(name + "/save"))
+        r.add(xzr::bench::measure(name + "/save", deltas[0].size(), r.min_time, save));
+    if (r.selected(name + "/load"))
+        r.add(xzr::bench::measure(name + "/load", deltas[0].size(), r.min_time, load));
+}
+
+template <class OArchive, class IArchive>
+void run_archive(runner& r, const std::string& archive, const xzr::bench::data& d)
+{
+    run<OArchive, IArchive>(r, archive, "vector_double", d.doubles);
+    run<OArchive, IArchive>(r, archive, "vector_int", d.ints);
+    run<OArchive, IArchive>(r, archive, "vector_point", d.points);
+    run<OArchive, IArchive>(r, archive, "vector_string", d.strings);
+    run<OArchive, IArchive>(r, archive, "map_string_int", d.map);
+    run<OArchive, IArchive>(r, archive, "shared_ptr_graph", d.graph);
+    run<OArchive, IArchive>(r, archive, "polymorphic", d.shapes);
+    run<OArchive, IArchive>(r, archive, "versioned", d.records);
+
+    run_arena<OArchive, IArchive, std::pmr::vector<std::pmr::string>>(r, archive, "vector_string", d.strings);
+    run_arena<OArchive, IArchive, std::pmr::map<std::pmr::string, std::int32_t>>(r, archive, "map_string_int", d.map);
+    run_arena<OArchive, IArchive, std::pmr::vector<std::shared_ptr<xzr::bench::node>>>(
+        r, archive, "shared_ptr_graph", d.graph);
+}
+} // namespace
+
+int main(int ac, char* av[])
+{
+    try
+    {
+        po::options_description desc("Allowed options");
+        desc.add_options()("help", "help message")(
+            "filter", po::value<std::string>()->default_value(""), "only run benchmarks whose name contains this")(
+            "min-time", po::value<double>()->default_value(0.2), "seconds to spend timing each benchmark")(
+            "json", po::value<std::string>(), "write the results as JSON to this file")(
+            "baseline", po::value<std::string>(), "fail if a result regresses past this JSON file of results")(
+            "time-tolerance",
+            po::value<double>()->default_value(0),
+            "how many times slower than the baseline a result may be, 0 to not compare times");
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(ac, av, desc), vm);
+        po::notify(vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc << "\n";
+            return 0;
+        }
+
+        runner r{};
+        r.filter = vm["filter"].as<std::string>();
+        r.min_time = vm["min-time"].as<double>();
+
+        const xzr::bench::data d{};
+        run_archive<cereal::BinaryOutputArchive, cereal::BinaryInputArchive>(r, "binary", d);
+        run_compressed<cereal::BinaryOutputArchive, cereal::BinaryInputArchive>(r, "binary_lz", "vector_double", d.doubles);
+        run_compressed<cereal::BinaryOutputArchive, cereal::BinaryInputArchive>(r, "binary_lz", "vector_string", d.strings);
+        run_compressed<cereal::BinaryOutputArchive, cereal::BinaryInputArchive>(r, "binary_lz", "map_string_int", d.map);
+
+        auto changed_doubles = d.doubles;
+        changed_doubles[changed_doubles.size() / 2] += 1.0;
+        run_delta(r, "vector_double", d.doubles, changed_doubles);
+
+        auto changed_map = d.map;
+        changed_map.erase(std::next(changed_map.begin(), static_cast<std::ptrdiff_t>(changed_map.size() / 2)));
+        changed_map.emplace("changed", 1);
+        run_delta(r, "map_string_int", d.map, changed_map);
+
+        run_archive<cereal::PortableBinaryOutputArchive, cereal::PortableBinaryInputArchive>(r, "portable_binary", d);
+        run_archive<cereal::JSONOutputArchive, cereal::JSONInputArchive>(r, "json", d);
+        run_archive<cereal::XMLOutputArchive, cereal::XMLInputArchive>(r, "xml", d);
+
+        if (vm.count("json"))
+        {
+            std::ofstream str{vm["json"].as<std::string>()};
+            xzr::bench::write_json(str, r.results);
+        }
+
+        if (vm.count("baseline"))
+        {
+            std::ifstream str{vm["baseline"].as<std::string>()};
+            if (!str)
+                throw std::runtime_error{"cannot open baseline " + vm["baseline"].as<std::string>()};
+
+            const auto baseline = xzr::bench::read_json(str);
+            if (baseline.toolchain != xzr::bench::toolchain())
+                std::cout << "not comparing allocations, the baseline was recorded with " << baseline.toolchain
+                          << ", not " << xzr::bench::toolchain() << "\n";
+
+            const auto found = xzr::bench::regressions(r.results, baseline, vm["time-tolerance"].as<double>());
+            for (const auto& f : found)
+                std::cerr << "regression: " << f << "\n";
+
+            if (!found.empty())
+                return 1;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "measure.hpp"
+
+#include <cereal/archives/json.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+namespace xzr
+{
+namespace bench
+{
+output_buffer::output_buffer()
+    : buffer_(4096)
+{
+    clear();
+}
+
+void output_buffer::clear()
+{
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+}
+
+const char* output_buffer::data() const
+{
+    return pbase();
+}
+
+std::size_t output_buffer::size() const
+{
+    return static_cast<std::size_t>(pptr() - pbase());
+}
+
+output_buffer::int_type output_buffer::overflow(int_type c)
+{
+    if (traits_type::eq_int_type(c, traits_type::eof()))
+        return traits_type::not_eof(c);
+
+    const auto used = size();
+    buffer_.resize(buffer_.size() * 2);
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+    pbump(static_cast<int>(used));
+
+    return sputc(traits_type::to_char_type(c));
+}
+
+input_buffer::input_buffer(const char* data, std::size_t size)
+{
+    auto begin = const_cast<char*>(data);
+    setg(begin, begin, begin + size);
+}
+
+std::string toolchain()
+{
+    std::ostringstream str{};
+#if defined(__clang__)
+    str << "clang " << __clang_major__ << '.' << __clang_minor__ << '.' << __clang_patchlevel__;
+#elif defined(__GNUC__)
+    str << "gcc " << __GNUC__ << '.' << __GNUC_MINOR__ << '.' << __GNUC_PATCHLEVEL__;
+#elif defined(_MSC_VER)
+    str << "msvc " << _MSC_FULL_VER;
+#else
+    str << "unknown compiler";
+#endif
+
+#if defined(_LIBCPP_VERSION)
+    str << ", libc++ " << _LIBCPP_VERSION;
+#elif defined(__GLIBCXX__)
+    str << ", libstdc++ " << __GLIBCXX__;
+#elif defined(_MSVC_STL_VERSION)
+    str << ", msvc stl " << _MSVC_STL_VERSION;
+#endif
+
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+    str << ", sanitized";
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || __has_feature(memory_sanitizer)
+    str << ", sanitized";
+#endif
+#endif
+
+    return str.str();
+}
+
+void write_json(std::ostream& str, const std::vector<result>& results)
+{
+    cereal::JSONOutputArchive archive{str};
+
+    archive(cereal::make_nvp("toolchain", toolchain()), cereal::make_nvp("results", results));
+}
+
+recorded read_json(std::istream& str)
+{
+    recorded r{};
+    {
+        cereal::JSONInputArchive archive{str};
+
+        archive(cereal::make_nvp("toolchain", r.toolchain), cereal::make_nvp("results", r.results));
+    }
+
+    return r;
+}
+
+std::vector<std::string> regressions(const std::vector<result>& results,
+                                     const recorded& baseline,
+                                     double time_tolerance)
+{
+    std::vector<std::string> found{};
+    const auto same_toolchain = baseline.toolchain == toolchain();
+
+    for (const auto& r : results)
+    {
+        const auto b = std::find_if(baseline.results.cbegin(), baseline.results.cend(), [&](const result& other) {
+            return other.name == r.name;
+        });
+        if (b == baseline.results.cend())
+            continue;
+
+        const auto report = [&](const char* what, double value, double limit) {
+            std::ostringstream str{};
+            str << r.name << ": " << what << " " << value << " exceeds " << limit;
+            found.push_back(str.str());
+        };
+
+        if (r.bytes > b->bytes)
+            report("bytes", static_cast<double>(r.bytes), static_cast<double>(b->bytes));
+        if (same_toolchain && r.allocs_per_op > b->allocs_per_op)
+            report("allocs/op", r.allocs_per_op, b->allocs_per_op);
+        if (time_tolerance > 0 && r.ns_per_op > b->ns_per_op * time_tolerance)
+            report("ns/op", r.ns_per_op, b->ns_per_op * time_tolerance);
+    }
+
+    return found;
+}
+} // namespace bench
+} // namespace xzr
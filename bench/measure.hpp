@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cereal/cereal.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace xzr
+{
+namespace bench
+{
+/// \brief returns the number of heap allocations made so far.
+///
+/// Counted by the replacement global operator new in allocations.cpp, which every
+/// standard allocator (and so every container cereal loads into) ends up calling.
+std::uint64_t allocation_count();
+
+/// \brief an output stream buffer that keeps its memory between runs.
+///
+/// Lets a benchmark measure the allocations of an archive rather than those of a
+/// growing std::stringbuf.
+class output_buffer : public std::streambuf
+{
+  public:
+    output_buffer();
+
+    /// \brief discards the written data, keeping the memory.
+    void clear();
+
+    const char* data() const;
+    std::size_t size() const;
+
+  protected:
+    int_type overflow(int_type c) override;
+
+  private:
+    std::vector<char> buffer_;
+};
+
+/// \brief an input stream buffer reading from memory it does not own.
+class input_buffer : public std::streambuf
+{
+  public:
+    input_buffer(const char* data, std::size_t size);
+};
+
+/// \brief the cost of one benchmark.
+struct result
+{
+    template <class Archive>
+    void serialize(Archive& ar)
+    {
+        ar(CEREAL_NVP(name),
+           CEREAL_NVP(bytes),
+           CEREAL_NVP(iterations),
+           CEREAL_NVP(ns_per_op),
+           CEREAL_NVP(mb_per_s),
+           CEREAL_NVP(allocs_per_op));
+    }
+
+    std::string name{};
+    std::uint64_t bytes{};      ///< size of the serialized data
+    std::uint64_t iterations{}; ///< number of times the operation was timed
+    double ns_per_op{};         ///< best time of one operation
+    double mb_per_s{};          ///< bytes processed per second at the best time
+    double allocs_per_op{};     ///< heap allocations made by one operation
+};
+
+/// \brief times op until min_time has passed, reporting the best of several batches.
+///
+/// The operation runs once before measuring, so first use costs (e.g. registering
+/// polymorphic types) are not counted.
+template <class F>
+result measure(std::string name, std::uint64_t bytes, double min_time, F&& op)
+{
+    using clock = std::chrono::steady_clock;
+    constexpr int batches{5};
+
+    op();
+
+    const auto allocations = allocation_count();
+    op();
+
+    result r{};
+    r.name = std::move(name);
+    r.bytes = bytes;
+    r.allocs_per_op = static_cast<double>(allocation_count() - allocations);
+
+    const auto time = [&](std::uint64_t n) {
+        const auto start = clock::now();
+        for (std::uint64_t i = 0; i < n; ++i)
+            op();
+        r.iterations += n;
+        return std::chrono::duration<double>(clock::now() - start).count();
+    };
+
+    // find a batch size that takes a fair share of min_time
+    std::uint64_t n{1};
+    for (auto seconds = time(n); seconds < min_time / batches && n < (std::uint64_t{1} << 30); seconds = time(n))
+        n *= 2;
+
+    auto best = std::numeric_limits<double>::max();
+    for (int i = 0; i < batches; ++i)
+        best = std::min(best, time(n) / static_cast<double>(n));
+
+    r.ns_per_op = best * 1e9;
+    r.mb_per_s = static_cast<double>(bytes) / best / 1e6;
+
+    return r;
+}
+
+/// \brief returns the compiler, standard library and sanitizers bench_exe was built with.
+///
+/// Allocation counts depend on these, e.g. on how a standard library grows its containers.
+std::string toolchain();
+
+/// \brief results, and the toolchain of the bench_exe that measured them.
+struct recorded
+{
+    std::string toolchain{};
+    std::vector<result> results{};
+};
+
+/// \brief writes results as JSON, together with the toolchain.
+void write_json(std::ostream& str, const std::vector<result>& results);
+
+/// \brief reads results written by write_json.
+recorded read_json(std::istream& str);
+
+/// \brief describes each result that is worse than the baseline result of the same name.
+///
+/// Sizes must not grow at all, since they do not depend on the machine. Allocations must
+/// not grow either, but are only compared when the baseline was recorded with the same
+/// toolchain. Times may grow up to time_tolerance times the baseline, to absorb noise and
+/// differences between machines and build types, and are not compared if it is 0.
+std::vector<std::string> regressions(const std::vector<result>& results,
+                                     const recorded& baseline,
+                                     double time_tolerance);
+} // namespace bench
+} // namespace xzr
@@ -30,6 +30,7 @@
 #define CEREAL_ARCHIVES_BINARY_HPP_
 
 #include "cereal/cereal.hpp"
+#include "cereal/details/compression.hpp"
 #include <sstream>
 
 namespace cereal
@@ -56,15 +57,31 @@ namespace cereal
                         even cout! */
       BinaryOutputArchive(std::ostream & stream) :
         OutputArchive<BinaryOutputArchive, AllowEmptyClassElision>(this),
-        itsStream(stream)
+        itsStream(stream),
+        itsBuffer(stream.rdbuf())
       { }
 
-      ~BinaryOutputArchive() CEREAL_NOEXCEPT = default;
+      //! Construct, compressing the output to the provided stream
+      /*! @param stream The stream to output to
+          @param compression How to compress the output.  Load it with a BinaryInputArchive
+                             given the same codec.  See Compression for details. */
+      BinaryOutputArchive(std::ostream & stream, Compression const & compression) :
+        OutputArchive<BinaryOutputArchive, AllowEmptyClassElision>(this),
+        itsStream(stream),
+        itsCompressor(compression_detail::makeOutputBuffer(stream, compression)),
+        itsBuffer(itsCompressor ? itsCompressor.get() : stream.rdbuf())
+      { }
+
+      ~BinaryOutputArchive() CEREAL_NOEXCEPT
+      {
+        compression_detail::finish( itsCompressor.get(), itsStream );
+      }
 
       //! Writes size bytes of data to the output stream
       void saveBinary( const void * data, std::streamsize size )
       {
-        auto const writtenSize = itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ), size );
+        CEREAL_PROFILE_BYTES( size );
+        auto const writtenSize = itsBuffer->sputn( reinterpret_cast<const char*>( data ), size );
 
         if(writtenSize != size)
           throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
@@ -72,6 +89,8 @@ namespace cereal
 
     private:
       std::ostream & itsStream;
+      std::unique_ptr<compression_detail::OutputBuffer> itsCompressor; //!< Compresses the output, if compressing
+      std::streambuf * itsBuffer; //!< Where the output is written: the stream's buffer, or itsCompressor
   };
 
   // ######################################################################
@@ -91,7 +110,17 @@ namespace cereal
       //! Construct, loading from the provided stream
       BinaryInputArchive(std::istream & stream) :
         InputArchive<BinaryInputArchive, AllowEmptyClassElision>(this),
-        itsStream(stream)
+        itsBuffer(stream.rdbuf())
+      { }
+
+      //! Construct, loading compressed data from the provided stream
+      /*! @param stream The stream to read from
+          @param compression How the data was compressed.  Its codec must be the one the data
+                             was saved with; the block size and threads need not match. */
+      BinaryInputArchive(std::istream & stream, Compression const & compression) :
+        InputArchive<BinaryInputArchive, AllowEmptyClassElision>(this),
+        itsDecompressor(compression_detail::makeInputBuffer(stream, compression)),
+        itsBuffer(itsDecompressor ? itsDecompressor.get() : stream.rdbuf())
       { }
 
       ~BinaryInputArchive() CEREAL_NOEXCEPT = default;
@@ -99,14 +128,16 @@ namespace cereal
       //! Reads size bytes of data from the input stream
       void loadBinary( void * const data, std::streamsize size )
       {
-        auto const readSize = itsStream.rdbuf()->sgetn( reinterpret_cast<char*>( data ), size );
+        CEREAL_PROFILE_BYTES( size );
+        auto const readSize = itsBuffer->sgetn( reinterpret_cast<char*>( data ), size );
 
         if(readSize != size)
           throw Exception("Failed to read " + std::to_string(size) + " bytes from input stream! Read " + std::to_string(readSize));
       }
 
     private:
-      std::istream & itsStream;
+      std::unique_ptr<compression_detail::InputBuffer> itsDecompressor; //!< Decompresses the input, if compressed
+      std::streambuf * itsBuffer; //!< Where the input is read from: the stream's buffer, or itsDecompressor
   };
 
   // ######################################################################
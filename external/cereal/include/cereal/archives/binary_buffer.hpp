@@ -0,0 +1,220 @@
+/*! \file binary_buffer.hpp
+    \brief Binary input and output archives operating directly on memory buffers */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_BINARY_BUFFER_HPP_
+#define CEREAL_ARCHIVES_BINARY_BUFFER_HPP_
+
+#include "cereal/cereal.hpp"
+#include <cstring>
+#include <vector>
+
+namespace cereal
+{
+  // ######################################################################
+  //! An output archive designed to save data in a compact binary representation into memory
+  /*! This archive produces exactly the same output as BinaryOutputArchive, but
+      appends it to a caller owned std::vector<char> instead of writing to a
+      stream.  Each primitive is copied directly into the buffer, avoiding the
+      per call overhead of std::streambuf.
+
+      The buffer is never cleared by the archive.  To serialize many messages
+      without touching the heap, keep one buffer around, clear() it between
+      messages and let it retain its capacity:
+
+      @code{.cpp}
+      std::vector<char> buffer;
+      for( auto const & message : messages )
+      {
+        buffer.clear();
+        {
+          cereal::BinaryBufferOutputArchive ar( buffer );
+          ar( message );
+        }
+        send( buffer.data(), buffer.size() );
+      }
+      @endcode
+
+      This archive does nothing to ensure that the endianness of the saved
+      and loaded data is the same.
+
+      \ingroup Archives */
+  class BinaryBufferOutputArchive : public OutputArchive<BinaryBufferOutputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! Construct, appending to the provided buffer
+      /*! @param buffer The buffer to append to.  It must outlive the archive. */
+      BinaryBufferOutputArchive(std::vector<char> & buffer) :
+        OutputArchive<BinaryBufferOutputArchive, AllowEmptyClassElision>(this),
+        itsBuffer(buffer)
+      { }
+
+      ~BinaryBufferOutputArchive() CEREAL_NOEXCEPT = default;
+
+      //! Appends size bytes of data to the buffer
+      void saveBinary( const void * data, std::size_t size )
+      {
+        CEREAL_PROFILE_BYTES( size );
+        if( size == 0 )
+          return;
+
+        auto const offset = itsBuffer.size();
+        itsBuffer.resize( offset + size );
+        std::memcpy( itsBuffer.data() + offset, data, size );
+      }
+
+      //! Returns the buffer this archive appends to
+      std::vector<char> const & buffer() const
+      { return itsBuffer; }
+
+    private:
+      std::vector<char> & itsBuffer;
+  };
+
+  // ######################################################################
+  //! An input archive designed to load data saved using BinaryOutputArchive or BinaryBufferOutputArchive
+  /*! This archive reads from a caller owned, contiguous block of memory such as
+      a std::vector<char>, a network packet or a memory mapped file.  The memory is
+      not copied and must remain valid and unchanged for as long as the archive,
+      or anything loaded as a view into it (e.g. std::string_view), is in use.
+
+      This archive does nothing to ensure that the endianness of the saved
+      and loaded data is the same.
+
+      \ingroup Archives */
+  class BinaryBufferInputArchive : public InputArchive<BinaryBufferInputArchive, AllowEmptyClassElision>,
+                                   public traits::ContiguousInputArchive
+  {
+    public:
+      //! Construct, loading from the provided memory
+      /*! @param data Pointer to the first byte to load
+          @param size The number of bytes available at data */
+      BinaryBufferInputArchive(const void * data, std::size_t size) :
+        InputArchive<BinaryBufferInputArchive, AllowEmptyClassElision>(this),
+        itsBegin(reinterpret_cast<const char*>(data)),
+        itsPosition(itsBegin),
+        itsEnd(itsBegin + size)
+      { }
+
+      //! Construct, loading from the contents of the provided buffer
+      BinaryBufferInputArchive(std::vector<char> const & buffer) :
+        BinaryBufferInputArchive(buffer.data(), buffer.size())
+      { }
+
+      ~BinaryBufferInputArchive() CEREAL_NOEXCEPT = default;
+
+      //! Reads size bytes of data from the buffer
+      void loadBinary( void * const data, std::size_t size )
+      {
+        auto const bytes = borrowBinary( size );
+        if( size != 0 )
+          std::memcpy( data, bytes, size );
+      }
+
+      //! Skips over size bytes of data, returning a pointer to them inside the buffer
+      /*! @throw Exception if fewer than size bytes remain */
+      const void * borrowBinary( std::size_t size )
+      {
+        CEREAL_PROFILE_BYTES( size );
+        auto const remaining = static_cast<std::size_t>( itsEnd - itsPosition );
+        if( size > remaining )
+          throw Exception("Failed to read " + std::to_string(size) + " bytes from input buffer! Only " + std::to_string(remaining) + " bytes remain");
+
+        auto const data = itsPosition;
+        itsPosition += size;
+        return data;
+      }
+
+      //! Returns the number of bytes consumed so far
+      /*! Useful when several archives were written back to back into the same buffer */
+      std::size_t position() const
+      { return static_cast<std::size_t>( itsPosition - itsBegin ); }
+
+    private:
+      const char * itsBegin;
+      const char * itsPosition;
+      const char * itsEnd;
+  };
+
+  // ######################################################################
+  // Common BinaryBufferArchive serialization functions
+
+  //! Saving for POD types to a binary buffer
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(BinaryBufferOutputArchive & ar, T const & t)
+  {
+    ar.saveBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Loading for POD types from a binary buffer
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(BinaryBufferInputArchive & ar, T & t)
+  {
+    ar.loadBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Serializing NVP types to a binary buffer
+  template <class Archive, class T> inline
+  CEREAL_ARCHIVE_RESTRICT(BinaryBufferInputArchive, BinaryBufferOutputArchive)
+  CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar, NameValuePair<T> & t )
+  {
+    ar( t.value );
+  }
+
+  //! Serializing SizeTags to a binary buffer
+  template <class Archive, class T> inline
+  CEREAL_ARCHIVE_RESTRICT(BinaryBufferInputArchive, BinaryBufferOutputArchive)
+  CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar, SizeTag<T> & t )
+  {
+    ar( t.size );
+  }
+
+  //! Saving binary data to a binary buffer
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME(BinaryBufferOutputArchive & ar, BinaryData<T> const & bd)
+  {
+    ar.saveBinary( bd.data, static_cast<std::size_t>( bd.size ) );
+  }
+
+  //! Loading binary data from a binary buffer
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME(BinaryBufferInputArchive & ar, BinaryData<T> & bd)
+  {
+    ar.loadBinary( bd.data, static_cast<std::size_t>( bd.size ) );
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::BinaryBufferOutputArchive)
+CEREAL_REGISTER_ARCHIVE(cereal::BinaryBufferInputArchive)
+
+// tie input and output archives together
+CEREAL_SETUP_ARCHIVE_TRAITS(cereal::BinaryBufferInputArchive, cereal::BinaryBufferOutputArchive)
+
+#endif // CEREAL_ARCHIVES_BINARY_BUFFER_HPP_
@@ -0,0 +1,464 @@
+/*! \file compact_binary.hpp
+    \brief Compact, endian independent binary input and output archives using variable length integers */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_COMPACT_BINARY_HPP_
+#define CEREAL_ARCHIVES_COMPACT_BINARY_HPP_
+
+#include "cereal/cereal.hpp"
+#include "cereal/archives/portable_binary.hpp"
+#include <cstring>
+#include <sstream>
+#include <limits>
+
+namespace cereal
+{
+  namespace compact_binary_detail
+  {
+    //! The maximum number of bytes used to encode a 64 bit integer as a varint
+    /*! @ingroup Internal */
+    static const std::size_t max_varint_size = 10;
+
+    //! Maps signed integers onto unsigned ones so that values of small magnitude stay small
+    /*! 0 -> 0, -1 -> 1, 1 -> 2, -2 -> 3, ...
+        @ingroup Internal */
+    inline std::uint64_t zigzag_encode( std::int64_t value )
+    {
+      return ( static_cast<std::uint64_t>( value ) << 1 ) ^ static_cast<std::uint64_t>( value >> 63 );
+    }
+
+    //! Encodes value as unsigned LEB128 into buffer, returning the number of bytes used
+    /*! @param buffer Must have room for at least max_varint_size bytes
+        @ingroup Internal */
+    inline std::streamsize encode_varint( std::uint64_t value, std::uint8_t * buffer )
+    {
+      std::streamsize size = 0;
+      while( value >= 0x80 )
+      {
+        buffer[size++] = static_cast<std::uint8_t>( value | 0x80 );
+        value >>= 7;
+      }
+      buffer[size++] = static_cast<std::uint8_t>( value );
+      return size;
+    }
+
+    //! Reverses zigzag_encode
+    /*! @ingroup Internal */
+    inline std::int64_t zigzag_decode( std::uint64_t value )
+    {
+      return static_cast<std::int64_t>( value >> 1 ) ^ -static_cast<std::int64_t>( value & 1 );
+    }
+
+    //! Converts an unsigned integer to its varint representation
+    /*! @ingroup Internal */
+    template <class T> inline
+    typename std::enable_if<std::is_unsigned<T>::value, std::uint64_t>::type
+    to_varint( T value )
+    {
+      return static_cast<std::uint64_t>( value );
+    }
+
+    //! Converts a signed integer to its varint representation
+    /*! @ingroup Internal */
+    template <class T> inline
+    typename std::enable_if<std::is_signed<T>::value, std::uint64_t>::type
+    to_varint( T value )
+    {
+      return zigzag_encode( static_cast<std::int64_t>( value ) );
+    }
+
+    //! Converts a varint back to an unsigned integer
+    /*! @throw Exception if the value does not fit into T
+        @ingroup Internal */
+    template <class T> inline
+    typename std::enable_if<std::is_unsigned<T>::value, T>::type
+    from_varint( std::uint64_t value )
+    {
+      if( value > static_cast<std::uint64_t>( std::numeric_limits<T>::max() ) )
+        throw Exception("Value " + std::to_string(value) + " read from compact binary archive does not fit into a " + std::to_string(sizeof(T)) + " byte integer");
+      return static_cast<T>( value );
+    }
+
+    //! Converts a varint back to a signed integer
+    /*! @throw Exception if the value does not fit into T
+        @ingroup Internal */
+    template <class T> inline
+    typename std::enable_if<std::is_signed<T>::value, T>::type
+    from_varint( std::uint64_t value )
+    {
+      auto const decoded = zigzag_decode( value );
+      if( decoded < static_cast<std::int64_t>( std::numeric_limits<T>::lowest() ) ||
+          decoded > static_cast<std::int64_t>( std::numeric_limits<T>::max() ) )
+        throw Exception("Value " + std::to_string(decoded) + " read from compact binary archive does not fit into a " + std::to_string(sizeof(T)) + " byte integer");
+      return static_cast<T>( decoded );
+    }
+  } // end namespace compact_binary_detail
+
+  // ######################################################################
+  //! An output archive designed to save data in a very compact, endian independent binary representation
+  /*! This archive trades a little processing time for size.  Sizes of
+      containers and all integers wider than one byte are written as
+      variable length integers (unsigned LEB128; signed values are zigzag
+      encoded first), so that small values take a single byte regardless
+      of their type.  Floating point values are written as little endian
+      IEEE 754, and contiguous blocks of them (e.g. std::vector<double>) are
+      copied in one piece on little endian machines.
+
+      The encoding does not depend on the endianness or word size of either
+      machine, so no extra metadata is stored.  Loading an integer into a type
+      that cannot represent it throws an Exception.
+
+      When using a binary archive and a file stream, you must use the
+      std::ios::binary format flag to avoid having your data altered
+      inadvertently.
+
+      \ingroup Archives */
+  class CompactBinaryOutputArchive : public OutputArchive<CompactBinaryOutputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! Construct, outputting to the provided stream
+      /*! @param stream The stream to output to. Should be opened with std::ios::binary flag. */
+      CompactBinaryOutputArchive(std::ostream & stream) :
+        OutputArchive<CompactBinaryOutputArchive, AllowEmptyClassElision>(this),
+        itsStream(stream)
+      { }
+
+      ~CompactBinaryOutputArchive() CEREAL_NOEXCEPT = default;
+
+      //! Writes size bytes of data to the output stream
+      void saveBinary( const void * data, std::streamsize size )
+      {
+        CEREAL_PROFILE_BYTES( size );
+        auto const writtenSize = itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ), size );
+
+        if(writtenSize != size)
+          throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+      }
+
+      //! Writes an unsigned integer using as few bytes as possible
+      void saveVarint( std::uint64_t value )
+      {
+        std::uint8_t buffer[compact_binary_detail::max_varint_size];
+        saveBinary( buffer, compact_binary_detail::encode_varint( value, buffer ) );
+      }
+
+      //! Writes size bytes of data as little endian elements of DataSize bytes each
+      template <std::size_t DataSize> inline
+      void saveLittleEndian( const void * data, std::streamsize size )
+      {
+        if( portable_binary_detail::is_little_endian() )
+          return saveBinary( data, size );
+
+        std::uint8_t element[DataSize];
+        auto const bytes = reinterpret_cast<const std::uint8_t*>( data );
+        for( std::streamsize i = 0; i < size; i += DataSize )
+        {
+          std::memcpy( element, bytes + i, DataSize );
+          portable_binary_detail::swap_bytes<DataSize>( element );
+          saveBinary( element, DataSize );
+        }
+      }
+
+    private:
+      std::ostream & itsStream;
+  };
+
+  // ######################################################################
+  //! An input archive designed to load data saved using CompactBinaryOutputArchive
+  /*! \sa CompactBinaryOutputArchive
+      \ingroup Archives */
+  class CompactBinaryInputArchive : public InputArchive<CompactBinaryInputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! Construct, loading from the provided stream
+      /*! @param stream The stream to read from. Should be opened with std::ios::binary flag. */
+      CompactBinaryInputArchive(std::istream & stream) :
+        InputArchive<CompactBinaryInputArchive, AllowEmptyClassElision>(this),
+        itsStream(stream)
+      { }
+
+      ~CompactBinaryInputArchive() CEREAL_NOEXCEPT = default;
+
+      //! Reads size bytes of data from the input stream
+      void loadBinary( void * const data, std::streamsize size )
+      {
+        CEREAL_PROFILE_BYTES( size );
+        auto const readSize = itsStream.rdbuf()->sgetn( reinterpret_cast<char*>( data ), size );
+
+        if(readSize != size)
+          throw Exception("Failed to read " + std::to_string(size) + " bytes from input stream! Read " + std::to_string(readSize));
+      }
+
+      //! Reads an unsigned integer written by CompactBinaryOutputArchive::saveVarint
+      std::uint64_t loadVarint()
+      {
+        auto const buffer = itsStream.rdbuf();
+        std::uint64_t value = 0;
+
+        for( unsigned shift = 0; shift < 64; shift += 7 )
+        {
+          auto const byte = buffer->sbumpc();
+          if( byte == std::char_traits<char>::eof() )
+            throw Exception("Failed to read variable length integer from input stream!");
+
+          CEREAL_PROFILE_BYTES( 1 );
+          value |= static_cast<std::uint64_t>( byte & 0x7F ) << shift;
+          if( ( byte & 0x80 ) == 0 )
+            return value;
+        }
+
+        throw Exception("Variable length integer in input stream is longer than " + std::to_string(compact_binary_detail::max_varint_size) + " bytes!");
+      }
+
+      //! Reads size bytes of little endian elements of DataSize bytes each
+      template <std::size_t DataSize> inline
+      void loadLittleEndian( void * const data, std::streamsize size )
+      {
+        loadBinary( data, size );
+
+        if( !portable_binary_detail::is_little_endian() )
+        {
+          auto const bytes = reinterpret_cast<std::uint8_t*>( data );
+          for( std::streamsize i = 0; i < size; i += DataSize )
+            portable_binary_detail::swap_bytes<DataSize>( bytes + i );
+        }
+      }
+
+    private:
+      std::istream & itsStream;
+  };
+
+  namespace compact_binary_detail
+  {
+    //! Saves a block of single byte or non arithmetic data as is
+    /*! @ingroup Internal */
+    template <class T> inline
+    typename std::enable_if<(!std::is_arithmetic<T>::value && !std::is_class<T>::value) || sizeof(T) == 1, void>::type
+    save_block( CompactBinaryOutputArchive & ar, const void * data, std::size_t size )
+    {
+      ar.saveBinary( data, static_cast<std::streamsize>( size ) );
+    }
+
+    //! Saves a block of floating point data as little endian
+    /*! @ingroup Internal */
+    template <class T> inline
+    typename std::enable_if<std::is_floating_point<T>::value && sizeof(T) != 1, void>::type
+    save_block( CompactBinaryOutputArchive & ar, const void * data, std::size_t size )
+    {
+      ar.template saveLittleEndian<sizeof(T)>( data, static_cast<std::streamsize>( size ) );
+    }
+
+    //! Saves a block of integers as varints
+    /*! The varints are gathered in a small local buffer so that the stream
+        is written to in chunks rather than once per element.
+        @ingroup Internal */
+    template <class T> inline
+    typename std::enable_if<std::is_integral<T>::value && sizeof(T) != 1, void>::type
+    save_block( CompactBinaryOutputArchive & ar, const void * data, std::size_t size )
+    {
+      std::uint8_t buffer[64 * max_varint_size];
+      std::streamsize used = 0;
+
+      T value;
+      auto const bytes = reinterpret_cast<const char*>( data );
+      for( std::size_t i = 0; i < size; i += sizeof(T) )
+      {
+        if( used > static_cast<std::streamsize>( sizeof(buffer) - max_varint_size ) )
+        {
+          ar.saveBinary( buffer, used );
+          used = 0;
+        }
+
+        std::memcpy( &value, bytes + i, sizeof(T) );
+        used += encode_varint( to_varint( value ), buffer + used );
+      }
+
+      ar.saveBinary( buffer, used );
+    }
+
+    //! Saves a block of memcpy serializable user types one element at a time, so that their members are compacted
+    /*! @ingroup Internal */
+    template <class T> inline
+    typename std::enable_if<std::is_class<T>::value && sizeof(T) != 1, void>::type
+    save_block( CompactBinaryOutputArchive & ar, const void * data, std::size_t size )
+    {
+      auto const elements = static_cast<T const *>( data );
+      for( std::size_t i = 0; i < size / sizeof(T); ++i )
+        ar( elements[i] );
+    }
+
+    //! Loads a block of single byte or non arithmetic data as is
+    /*! @ingroup Internal */
+    template <class T> inline
+    typename std::enable_if<(!std::is_arithmetic<T>::value && !std::is_class<T>::value) || sizeof(T) == 1, void>::type
+    load_block( CompactBinaryInputArchive & ar, void * data, std::size_t size )
+    {
+      ar.loadBinary( data, static_cast<std::streamsize>( size ) );
+    }
+
+    //! Loads a block of little endian floating point data
+    /*! @ingroup Internal */
+    template <class T> inline
+    typename std::enable_if<std::is_floating_point<T>::value && sizeof(T) != 1, void>::type
+    load_block( CompactBinaryInputArchive & ar, void * data, std::size_t size )
+    {
+      ar.template loadLittleEndian<sizeof(T)>( data, static_cast<std::streamsize>( size ) );
+    }
+
+    //! Loads a block of integers one varint at a time
+    /*! @ingroup Internal */
+    template <class T> inline
+    typename std::enable_if<std::is_integral<T>::value && sizeof(T) != 1, void>::type
+    load_block( CompactBinaryInputArchive & ar, void * data, std::size_t size )
+    {
+      auto const bytes = reinterpret_cast<char*>( data );
+      for( std::size_t i = 0; i < size; i += sizeof(T) )
+      {
+        auto const value = from_varint<T>( ar.loadVarint() );
+        std::memcpy( bytes + i, &value, sizeof(T) );
+      }
+    }
+
+    //! Loads a block of memcpy serializable user types one element at a time
+    /*! @ingroup Internal */
+    template <class T> inline
+    typename std::enable_if<std::is_class<T>::value && sizeof(T) != 1, void>::type
+    load_block( CompactBinaryInputArchive & ar, void * data, std::size_t size )
+    {
+      auto const elements = static_cast<T *>( data );
+      for( std::size_t i = 0; i < size / sizeof(T); ++i )
+        ar( elements[i] );
+    }
+  } // end namespace compact_binary_detail
+
+  // ######################################################################
+  // Common CompactBinaryArchive serialization functions
+
+  //! Saving for single byte arithmetic types (bool, char, (u)int8_t) to compact binary
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value && sizeof(T) == 1, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(CompactBinaryOutputArchive & ar, T const & t)
+  {
+    ar.saveBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Loading for single byte arithmetic types (bool, char, (u)int8_t) from compact binary
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value && sizeof(T) == 1, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(CompactBinaryInputArchive & ar, T & t)
+  {
+    ar.loadBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Saving for integers wider than one byte to compact binary
+  template<class T> inline
+  typename std::enable_if<std::is_integral<T>::value && sizeof(T) != 1, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(CompactBinaryOutputArchive & ar, T const & t)
+  {
+    ar.saveVarint( compact_binary_detail::to_varint( t ) );
+  }
+
+  //! Loading for integers wider than one byte from compact binary
+  template<class T> inline
+  typename std::enable_if<std::is_integral<T>::value && sizeof(T) != 1, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(CompactBinaryInputArchive & ar, T & t)
+  {
+    t = compact_binary_detail::from_varint<T>( ar.loadVarint() );
+  }
+
+  //! Saving for floating point types to compact binary
+  template<class T> inline
+  typename std::enable_if<std::is_floating_point<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(CompactBinaryOutputArchive & ar, T const & t)
+  {
+    static_assert( std::numeric_limits<T>::is_iec559, "Compact binary only supports IEEE 754 standardized floating point" );
+    ar.template saveLittleEndian<sizeof(T)>(std::addressof(t), sizeof(t));
+  }
+
+  //! Loading for floating point types from compact binary
+  template<class T> inline
+  typename std::enable_if<std::is_floating_point<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(CompactBinaryInputArchive & ar, T & t)
+  {
+    static_assert( std::numeric_limits<T>::is_iec559, "Compact binary only supports IEEE 754 standardized floating point" );
+    ar.template loadLittleEndian<sizeof(T)>(std::addressof(t), sizeof(t));
+  }
+
+  //! Serializing NVP types to compact binary
+  template <class Archive, class T> inline
+  CEREAL_ARCHIVE_RESTRICT(CompactBinaryInputArchive, CompactBinaryOutputArchive)
+  CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar, NameValuePair<T> & t )
+  {
+    ar( t.value );
+  }
+
+  //! Saving SizeTags to compact binary
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( CompactBinaryOutputArchive & ar, SizeTag<T> const & t )
+  {
+    ar.saveVarint( static_cast<std::uint64_t>( t.size ) );
+  }
+
+  //! Loading SizeTags from compact binary
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( CompactBinaryInputArchive & ar, SizeTag<T> & t )
+  {
+    t.size = compact_binary_detail::from_varint<size_type>( ar.loadVarint() );
+  }
+
+  //! Saving binary data to compact binary
+  /*! Integers are written one varint at a time, all other data in one block */
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME(CompactBinaryOutputArchive & ar, BinaryData<T> const & bd)
+  {
+    using TT = detail::binary_data_element<T>;
+    static_assert( !std::is_floating_point<TT>::value || std::numeric_limits<TT>::is_iec559,
+                   "Compact binary only supports IEEE 754 standardized floating point" );
+
+    compact_binary_detail::save_block<TT>( ar, bd.data, static_cast<std::size_t>( bd.size ) );
+  }
+
+  //! Loading binary data from compact binary
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME(CompactBinaryInputArchive & ar, BinaryData<T> & bd)
+  {
+    using TT = detail::binary_data_element<T>;
+    static_assert( !std::is_floating_point<TT>::value || std::numeric_limits<TT>::is_iec559,
+                   "Compact binary only supports IEEE 754 standardized floating point" );
+
+    compact_binary_detail::load_block<TT>( ar, bd.data, static_cast<std::size_t>( bd.size ) );
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::CompactBinaryOutputArchive)
+CEREAL_REGISTER_ARCHIVE(cereal::CompactBinaryInputArchive)
+
+// tie input and output archives together
+CEREAL_SETUP_ARCHIVE_TRAITS(cereal::CompactBinaryInputArchive, cereal::CompactBinaryOutputArchive)
+
+#endif // CEREAL_ARCHIVES_COMPACT_BINARY_HPP_
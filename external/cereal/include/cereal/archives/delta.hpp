@@ -0,0 +1,762 @@
+/*! \file delta.hpp
+    \brief An output archive saving only what changed since a previous snapshot */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_DELTA_HPP_
+#define CEREAL_ARCHIVES_DELTA_HPP_
+
+#include "cereal/cereal.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <utility>
+#include <vector>
+
+namespace cereal
+{
+  namespace memory_detail
+  {
+    template <class T> struct PtrWrapper;
+  }
+
+  namespace delta_detail
+  {
+    //! Identifies a delta, followed by its format version
+    static const char header[5] = { 'C', 'R', 'L', 'D', 1 };
+
+    //! The most bytes of a literal read at a time, so that a corrupt size cannot allocate more
+    //! than the delta actually holds
+    static const std::size_t literalChunkSize = 64 * 1024;
+
+    //! The operations a delta is made of
+    enum Op : std::uint8_t
+    {
+      End = 0,     //!< The new snapshot is complete
+      Copy = 1,    //!< Followed by an offset and a size, copies bytes of the previous snapshot
+      Literal = 2  //!< Followed by a size and as many bytes, appends those bytes
+    };
+
+    //! The number of exceptions thrown and not yet caught, see std::uncaught_exceptions
+    inline int uncaughtExceptions()
+    {
+      #ifdef CEREAL_HAS_CPP17
+      return std::uncaught_exceptions();
+      #else
+      return std::uncaught_exception() ? 1 : 0;
+      #endif
+    }
+
+    //! Mixes the bits of a 64 bit value
+    inline std::uint64_t mix( std::uint64_t x )
+    {
+      x ^= x >> 33;
+      x *= 0xff51afd7ed558ccdULL;
+      x ^= x >> 33;
+      x *= 0xc4ceb9fe1a85ec53ULL;
+      x ^= x >> 33;
+      return x;
+    }
+
+    //! Hashes size bytes at data, eight at a time
+    inline std::uint64_t hash( const char * data, std::size_t size, std::uint64_t seed = 0 )
+    {
+      std::uint64_t h = mix( seed ^ ( size * 0x9e3779b97f4a7c15ULL ) );
+
+      std::size_t i = 0;
+      for( ; i + 8 <= size; i += 8 )
+      {
+        std::uint64_t word;
+        std::memcpy( &word, data + i, 8 );
+        h = mix( h ^ word );
+      }
+
+      if( i < size )
+      {
+        std::uint64_t word = 0;
+        std::memcpy( &word, data + i, size - i );
+        h = mix( h ^ word );
+      }
+
+      return h;
+    }
+
+    //! The key of a value that is the index-th class type saved in its parent
+    inline std::uint64_t positionKey( std::uint64_t index )
+    { return mix( index * 4 + 1 ); }
+
+    //! The key of a value saved with a name value pair
+    inline std::uint64_t nameKey( const char * name )
+    { return hash( name, std::strlen( name ), 2 ); }
+
+    //! The key of a value identified by some of its own bytes, e.g. the key of a map entry
+    inline std::uint64_t contentKey( const char * data, std::size_t size )
+    { return hash( data, size, 3 ); }
+
+    //! A value saved to a delta archive, as a range of the snapshot
+    /*! Nodes are stored in pre-order, so the children of a node follow it and end
+        where the next sibling, at index next, starts. */
+    struct Node
+    {
+      std::size_t begin;
+      std::size_t end;
+      std::uint64_t key;
+      std::size_t next;
+    };
+
+    //! Identifies the values of T by the bytes of their member named name, rather than by position
+    /*! Map entries are identified by their key and shared pointers by their id, so that entries
+        inserted into or erased from the middle of a map still leave the others matching. */
+    template <class T> struct content_key
+    {
+      static const char * name() { return nullptr; }
+      static const bool keep = false;  //!< Whether values are tracked even when small
+    };
+
+    template <class K, class V> struct content_key<MapItem<K, V>>
+    {
+      static const char * name() { return "key"; }
+      static const bool keep = true;
+    };
+
+    template <class T> struct content_key<memory_detail::PtrWrapper<T>>
+    {
+      static const char * name() { return "id"; }
+      static const bool keep = false;
+    };
+
+    inline void writeVarint( std::streambuf & buffer, std::uint64_t value )
+    {
+      char bytes[10];
+      std::size_t size = 0;
+      for( ; value >= 0x80; value >>= 7 )
+        bytes[size++] = static_cast<char>( ( value & 0x7F ) | 0x80 );
+      bytes[size++] = static_cast<char>( value );
+
+      if( buffer.sputn( bytes, static_cast<std::streamsize>( size ) ) != static_cast<std::streamsize>( size ) )
+        throw Exception("Failed to write delta to output stream!");
+    }
+
+    inline std::uint64_t readVarint( std::streambuf & buffer )
+    {
+      std::uint64_t value = 0;
+      for( unsigned shift = 0; shift < 64; shift += 7 )
+      {
+        auto const byte = buffer.sbumpc();
+        if( byte == std::char_traits<char>::eof() )
+          throw Exception("Delta is truncated");
+
+        value |= static_cast<std::uint64_t>( byte & 0x7F ) << shift;
+        if( ( byte & 0x80 ) == 0 )
+          return value;
+      }
+      throw Exception("Delta is corrupt");
+    }
+
+    inline void write64( std::streambuf & buffer, std::uint64_t value )
+    {
+      char bytes[8];
+      for( int i = 0; i < 8; ++i )
+        bytes[i] = static_cast<char>( value >> ( 8 * i ) );
+      if( buffer.sputn( bytes, 8 ) != 8 )
+        throw Exception("Failed to write delta to output stream!");
+    }
+
+    inline std::uint64_t read64( std::streambuf & buffer )
+    {
+      char bytes[8];
+      if( buffer.sgetn( bytes, 8 ) != 8 )
+        throw Exception("Delta is truncated");
+
+      std::uint64_t value = 0;
+      for( int i = 0; i < 8; ++i )
+        value |= static_cast<std::uint64_t>( static_cast<std::uint8_t>( bytes[i] ) ) << ( 8 * i );
+      return value;
+    }
+
+    //! Writes the operations of a delta, merging adjacent copies and literals
+    class Writer
+    {
+      public:
+        Writer( std::streambuf & buffer, const char * data ) :
+          itsBuffer( buffer ), itsData( data ),
+          itsLiteralBegin( 0 ), itsLiteralEnd( 0 ), itsCopyBegin( 0 ), itsCopySize( 0 )
+        { }
+
+        //! Copies size bytes at begin in the previous snapshot
+        void copy( std::size_t begin, std::size_t size )
+        {
+          if( size == 0 )
+            return;
+
+          flushLiteral();
+          if( itsCopySize != 0 && itsCopyBegin + itsCopySize == begin )
+            itsCopySize += size;
+          else
+          {
+            flushCopy();
+            itsCopyBegin = begin;
+            itsCopySize = size;
+          }
+        }
+
+        //! Appends the bytes from begin to end of the new snapshot
+        void literal( std::size_t begin, std::size_t end )
+        {
+          if( begin == end )
+            return;
+
+          flushCopy();
+          if( itsLiteralEnd != itsLiteralBegin && itsLiteralEnd == begin )
+            itsLiteralEnd = end;
+          else
+          {
+            flushLiteral();
+            itsLiteralBegin = begin;
+            itsLiteralEnd = end;
+          }
+        }
+
+        void finish()
+        {
+          flushCopy();
+          flushLiteral();
+          if( itsBuffer.sputc( static_cast<char>( End ) ) == std::char_traits<char>::eof() )
+            throw Exception("Failed to write delta to output stream!");
+        }
+
+      private:
+        void flushCopy()
+        {
+          if( itsCopySize == 0 )
+            return;
+
+          writeVarint( itsBuffer, Copy );
+          writeVarint( itsBuffer, itsCopyBegin );
+          writeVarint( itsBuffer, itsCopySize );
+          itsCopySize = 0;
+        }
+
+        void flushLiteral()
+        {
+          if( itsLiteralEnd == itsLiteralBegin )
+            return;
+
+          auto const size = static_cast<std::streamsize>( itsLiteralEnd - itsLiteralBegin );
+          writeVarint( itsBuffer, Literal );
+          writeVarint( itsBuffer, static_cast<std::uint64_t>( size ) );
+          if( itsBuffer.sputn( itsData + itsLiteralBegin, size ) != size )
+            throw Exception("Failed to write delta to output stream!");
+          itsLiteralBegin = itsLiteralEnd = 0;
+        }
+
+        std::streambuf & itsBuffer;
+        const char * itsData;
+        std::size_t itsLiteralBegin;
+        std::size_t itsLiteralEnd;
+        std::size_t itsCopyBegin;
+        std::size_t itsCopySize;
+    };
+  } // namespace delta_detail
+
+  // ######################################################################
+  //! The state a DeltaOutputArchive saves the changes to, and a chain of deltas is applied to
+  /*! A snapshot holds everything saved, in the format of the BinaryOutputArchive, so that it can
+      be loaded with a BinaryBufferInputArchive (or BinaryInputArchive):
+
+      @code{.cpp}
+      // saving: each delta holds what changed since the one before
+      cereal::DeltaSnapshot saved;
+      for( auto & checkpoint : checkpoints )
+      {
+        cereal::DeltaOutputArchive ar( checkpoint.stream, saved );
+        ar( state );
+      }
+
+      // loading: the first delta holds everything, the others are applied to it in order
+      cereal::DeltaSnapshot loaded;
+      for( auto & checkpoint : checkpoints )
+        loaded.apply( checkpoint.stream );
+
+      cereal::BinaryBufferInputArchive ar( loaded.data() );
+      ar( state );
+      @endcode
+
+      A snapshot made by saving also knows where each value was saved, which lets the next delta
+      match values by name and position.  A snapshot made by applying deltas only knows its bytes,
+      and deltas saved against it compare them in chunks.
+
+      \ingroup Archives */
+  class DeltaSnapshot
+  {
+    public:
+      //! An empty snapshot, so that the first delta holds everything
+      DeltaSnapshot() :
+        itsNodes( 1, delta_detail::Node{ 0, 0, 0, 1 } ),
+        itsHash( delta_detail::hash( nullptr, 0 ) )
+      { }
+
+      //! The data saved, as a BinaryOutputArchive would have saved it
+      std::vector<char> const & data() const
+      { return itsData; }
+
+      //! Applies a delta read from stream
+      /*! @throw Exception if the delta was saved against another snapshot, or is corrupt */
+      void apply( std::istream & stream )
+      {
+        auto & buffer = *stream.rdbuf();
+
+        char header[sizeof( delta_detail::header )];
+        if( buffer.sgetn( header, sizeof( header ) ) != static_cast<std::streamsize>( sizeof( header ) ) ||
+            std::memcmp( header, delta_detail::header, sizeof( header ) ) != 0 )
+          throw Exception("Input is not a delta, or was saved by an unsupported version");
+
+        auto const baseSize = delta_detail::readVarint( buffer );
+        auto const baseHash = delta_detail::read64( buffer );
+        if( baseSize != itsData.size() || baseHash != itsHash )
+          throw Exception("Delta was not saved against this snapshot");
+
+        auto const size = delta_detail::readVarint( buffer );
+        auto const hash = delta_detail::read64( buffer );
+
+        // size is not trusted until the operations add up to it, so reserve no more than the base
+        // and the bytes the stream already holds
+        std::vector<char> data;
+        data.reserve( static_cast<std::size_t>( std::min<std::uint64_t>( size, itsData.size() +
+          static_cast<std::uint64_t>( std::max<std::streamsize>( buffer.in_avail(), 0 ) ) ) ) );
+        for( auto op = delta_detail::readVarint( buffer ); op != delta_detail::End; op = delta_detail::readVarint( buffer ) )
+        {
+          if( op == delta_detail::Copy )
+          {
+            auto const begin = delta_detail::readVarint( buffer );
+            auto const count = delta_detail::readVarint( buffer );
+            if( begin > itsData.size() || count > itsData.size() - begin || count > size - data.size() )
+              throw Exception("Delta is corrupt");
+
+            data.insert( data.end(), itsData.begin() + static_cast<std::ptrdiff_t>( begin ),
+                         itsData.begin() + static_cast<std::ptrdiff_t>( begin + count ) );
+          }
+          else if( op == delta_detail::Literal )
+          {
+            auto const count = delta_detail::readVarint( buffer );
+            if( count > size - data.size() )
+              throw Exception("Delta is corrupt");
+
+            for( auto remaining = count; remaining != 0; )
+            {
+              auto const chunk = static_cast<std::size_t>( std::min<std::uint64_t>( remaining, delta_detail::literalChunkSize ) );
+              auto const offset = data.size();
+              data.resize( offset + chunk );
+              if( buffer.sgetn( data.data() + offset, static_cast<std::streamsize>( chunk ) ) != static_cast<std::streamsize>( chunk ) )
+                throw Exception("Delta is truncated");
+              remaining -= chunk;
+            }
+          }
+          else
+            throw Exception("Delta is corrupt");
+        }
+
+        if( data.size() != size || delta_detail::hash( data.data(), data.size() ) != hash )
+          throw Exception("Delta is corrupt");
+
+        itsData.swap( data );
+        itsNodes.assign( 1, delta_detail::Node{ 0, itsData.size(), 0, 1 } );
+        itsHash = hash;
+      }
+
+    private:
+      friend class DeltaOutputArchive;
+
+      std::vector<char> itsData;
+      std::vector<delta_detail::Node> itsNodes;
+      std::uint64_t itsHash;
+  };
+
+  // ######################################################################
+  //! An output archive saving only what changed since a previous snapshot
+  /*! Everything is serialized as a BinaryOutputArchive would serialize it, into memory.  When
+      the archive is finished, the result is compared with the previous snapshot and only the
+      ranges that changed are written to the stream, together with references to the ranges of
+      the previous snapshot that did not.  The snapshot is then replaced with the new data, ready
+      for the next delta.  See DeltaSnapshot for how deltas are loaded.
+
+      Values are matched to those in the previous snapshot by the name value pair they were
+      saved with, or else by their position among the values saved by their parent: the index
+      of an element in a container, or of a member saved without a name.  Map entries are
+      matched by their key and shared pointers by their id.  Values smaller than
+      Options::minNodeSize are not tracked, and values that changed are compared in chunks of
+      Options::chunkSize bytes, so that a change to one element of a large vector of numbers
+      writes one chunk.
+
+      Each delta depends on all the deltas before it, starting with the first, which holds
+      everything.  A delta records the size and hash of the snapshot it was saved against, and
+      applying it to any other snapshot throws.
+
+      \ingroup Archives */
+  class DeltaOutputArchive : public OutputArchive<DeltaOutputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! A class containing various advanced options for the delta archive
+      class Options
+      {
+        public:
+          //! Default options
+          static Options Default(){ return Options(); }
+
+          //! Specify specific options for the DeltaOutputArchive
+          /*! @param minNodeSize Values saved in fewer bytes are compared as part of their parent
+              @param chunkSize The granularity, in bytes, at which changed values are compared */
+          explicit Options( std::size_t minNodeSize = 64, std::size_t chunkSize = 64 ) :
+            itsMinNodeSize( minNodeSize ), itsChunkSize( chunkSize == 0 ? 1 : chunkSize ) { }
+
+        private:
+          friend class DeltaOutputArchive;
+          std::size_t itsMinNodeSize;
+          std::size_t itsChunkSize;
+      };
+
+      //! Construct, saving the changes since snapshot to stream
+      /*! @param stream The stream to output the delta to.  Should be opened with std::ios::binary flag.
+          @param snapshot The previous snapshot, replaced with the data saved when the archive is finished
+          @param options The options for matching values to the previous snapshot */
+      DeltaOutputArchive( std::ostream & stream, DeltaSnapshot & snapshot, Options const & options = Options::Default() ) :
+        OutputArchive<DeltaOutputArchive, AllowEmptyClassElision>( this ),
+        itsStream( stream ),
+        itsSnapshot( snapshot ),
+        itsOptions( options ),
+        itsNodes( 1, delta_detail::Node{ 0, 0, 0, 0 } ),
+        itsOpen( 1, Open{ 0, 0, nullptr } ),
+        itsNextName( nullptr ),
+        itsFinished( false ),
+        itsUncaughtExceptions( delta_detail::uncaughtExceptions() )
+      { }
+
+      //! Finishes the archive, setting badbit on the stream if the delta could not be written
+      /*! When the archive is destroyed by an exception thrown while saving, nothing is written and
+          the snapshot is left as it was. */
+      ~DeltaOutputArchive() CEREAL_NOEXCEPT
+      {
+        if( delta_detail::uncaughtExceptions() > itsUncaughtExceptions )
+          return;
+
+        try
+        {
+          finish();
+        }
+        catch( ... )
+        {
+          itsStream.setstate( std::ios::badbit );
+        }
+      }
+
+      //! Writes the delta and replaces the snapshot, if this has not been done yet
+      /*! Nothing can be saved to the archive afterwards.
+          @throw Exception if the delta cannot be written, or a value is still being saved, e.g.
+                 because saving it threw */
+      void finish()
+      {
+        if( itsFinished )
+          return;
+        itsFinished = true;
+
+        if( itsOpen.size() != 1 || !itsNames.empty() )
+          throw Exception("Cannot finish a delta while a value is still being saved");
+
+        itsNodes[0].end = itsData.size();
+        itsNodes[0].next = itsNodes.size();
+        auto const hash = delta_detail::hash( itsData.data(), itsData.size() );
+
+        auto & buffer = *itsStream.rdbuf();
+        if( buffer.sputn( delta_detail::header, sizeof( delta_detail::header ) ) != static_cast<std::streamsize>( sizeof( delta_detail::header ) ) )
+          throw Exception("Failed to write delta to output stream!");
+        delta_detail::writeVarint( buffer, itsSnapshot.itsData.size() );
+        delta_detail::write64( buffer, itsSnapshot.itsHash );
+        delta_detail::writeVarint( buffer, itsData.size() );
+        delta_detail::write64( buffer, hash );
+
+        delta_detail::Writer writer( buffer, itsData.data() );
+        diffNode( writer, 0, 0 );
+        writer.finish();
+
+        itsSnapshot.itsData.swap( itsData );
+        itsSnapshot.itsNodes.swap( itsNodes );
+        itsSnapshot.itsHash = hash;
+      }
+
+      //! Appends size bytes of data to the snapshot
+      void saveBinary( const void * data, std::size_t size )
+      {
+        CEREAL_PROFILE_BYTES( size );
+        auto const bytes = reinterpret_cast<const char*>( data );
+        itsData.insert( itsData.end(), bytes, bytes + size );
+      }
+
+      /*! @name Internal Functionality
+          Functionality designed for use by the prologue and epilogue functions of this archive */
+      //! @{
+
+      //! Starts tracking a value of class type
+      /*! @param keyName The name of the member identifying the value, see delta_detail::content_key */
+      void startNode( const char * keyName )
+      {
+        auto & parent = itsOpen.back();
+        auto const key = itsNextName ? delta_detail::nameKey( itsNextName ) : delta_detail::positionKey( parent.children );
+        ++parent.children;
+        itsNextName = nullptr;
+
+        itsNodes.push_back( delta_detail::Node{ itsData.size(), 0, key, 0 } );
+        itsOpen.push_back( Open{ itsNodes.size() - 1, 0, keyName } );
+      }
+
+      //! Finishes the value started last, forgetting it if it is small unless keep is set
+      void finishNode( bool keep )
+      {
+        auto const index = itsOpen.back().node;
+        itsOpen.pop_back();
+
+        auto & node = itsNodes[index];
+        node.end = itsData.size();
+        if( !keep && node.end - node.begin < itsOptions.itsMinNodeSize )
+          itsNodes.resize( index );
+        else
+          node.next = itsNodes.size();
+      }
+
+      //! Names the next value saved
+      void startName( const char * name )
+      {
+        itsNextName = name;
+        itsNames.push_back( Name{ itsData.size(), name } );
+      }
+
+      //! Finishes the value named last, which identifies its parent if the parent is keyed by it
+      void finishName()
+      {
+        itsNextName = nullptr;
+        auto const name = itsNames.back();
+        itsNames.pop_back();
+
+        auto const & parent = itsOpen.back();
+        if( parent.keyName && std::strcmp( parent.keyName, name.name ) == 0 )
+          itsNodes[parent.node].key = delta_detail::contentKey( itsData.data() + name.begin, itsData.size() - name.begin );
+      }
+
+      //! @}
+
+    private:
+      //! A value that is being saved
+      struct Open
+      {
+        std::size_t node;
+        std::uint64_t children;  //!< The number of class types saved in it so far
+        const char * keyName;
+      };
+
+      //! A name value pair that is being saved
+      struct Name
+      {
+        std::size_t begin;
+        const char * name;
+      };
+
+      //! Writes the new node at index n, matched to the old node at index o if o is not npos
+      void diffNode( delta_detail::Writer & writer, std::size_t n, std::size_t o )
+      {
+        static const std::size_t npos = static_cast<std::size_t>( -1 );
+        auto const & oldNodes = itsSnapshot.itsNodes;
+        auto const & oldData = itsSnapshot.itsData;
+        auto const node = itsNodes[n];
+
+        if( o == npos )
+          return writer.literal( node.begin, node.end );
+
+        auto const old = oldNodes[o];
+        auto const size = node.end - node.begin;
+        if( size == old.end - old.begin && ( size == 0 || std::memcmp( itsData.data() + node.begin, oldData.data() + old.begin, size ) == 0 ) )
+          return writer.copy( old.begin, size );
+
+        // without children on either side, there is nothing to match, so compare the bytes in place
+        if( node.next == n + 1 || old.next == o + 1 )
+          return diffRange( writer, node.begin, node.end, old.begin, old.end );
+
+        std::vector<std::size_t> oldChildren;
+        for( auto c = o + 1; c < old.next; c = oldNodes[c].next )
+          oldChildren.push_back( c );
+
+        // the keys of the old children, sorted, with the index of the child, and which were matched
+        std::vector<std::pair<std::uint64_t, std::size_t>> byKey;
+        byKey.reserve( oldChildren.size() );
+        for( std::size_t i = 0; i < oldChildren.size(); ++i )
+          byKey.emplace_back( oldNodes[oldChildren[i]].key, i );
+        std::sort( byKey.begin(), byKey.end() );
+        std::vector<bool> matched( oldChildren.size() );
+
+        // the bytes between children are paired with those between the old children at the same
+        // place, and the bytes after the last child with those after the last old child
+        auto const oldGap = [&]( std::size_t i, std::size_t & begin, std::size_t & end )
+        {
+          begin = i == 0 ? old.begin : oldNodes[oldChildren[i - 1]].end;
+          end = i < oldChildren.size() ? oldNodes[oldChildren[i]].begin : old.end;
+        };
+
+        auto position = node.begin;
+        std::size_t i = 0;
+        for( auto c = n + 1; c < node.next; c = itsNodes[c].next, ++i )
+        {
+          std::size_t gapBegin = 0, gapEnd = 0;
+          if( i < oldChildren.size() )
+            oldGap( i, gapBegin, gapEnd );
+          diffRange( writer, position, itsNodes[c].begin, gapBegin, gapEnd );
+
+          // the first old child with the same key that is not matched yet
+          auto match = npos;
+          auto const key = itsNodes[c].key;
+          for( auto k = std::lower_bound( byKey.begin(), byKey.end(), std::make_pair( key, std::size_t( 0 ) ) );
+               k != byKey.end() && k->first == key; ++k )
+            if( !matched[k->second] )
+            {
+              matched[k->second] = true;
+              match = oldChildren[k->second];
+              break;
+            }
+
+          diffNode( writer, c, match );
+          position = itsNodes[c].end;
+        }
+
+        auto const lastEnd = oldChildren.empty() ? old.begin : oldNodes[oldChildren.back()].end;
+        diffRange( writer, position, node.end, lastEnd, old.end );
+      }
+
+      //! Writes the new bytes from begin to end, copying the chunks that equal those from oldBegin to oldEnd
+      void diffRange( delta_detail::Writer & writer, std::size_t begin, std::size_t end, std::size_t oldBegin, std::size_t oldEnd )
+      {
+        auto const & oldData = itsSnapshot.itsData;
+        auto const chunk = itsOptions.itsChunkSize;
+
+        for( auto offset = begin; offset < end; offset += chunk )
+        {
+          auto const size = std::min( chunk, end - offset );
+          auto const oldOffset = oldBegin + ( offset - begin );
+          if( oldOffset + size <= oldEnd && std::memcmp( itsData.data() + offset, oldData.data() + oldOffset, size ) == 0 )
+            writer.copy( oldOffset, size );
+          else
+            writer.literal( offset, offset + size );
+        }
+      }
+
+      std::ostream & itsStream;
+      DeltaSnapshot & itsSnapshot;
+      Options itsOptions;
+      std::vector<char> itsData;
+      std::vector<delta_detail::Node> itsNodes;
+      std::vector<Open> itsOpen;
+      std::vector<Name> itsNames;
+      const char * itsNextName;
+      bool itsFinished;
+      int itsUncaughtExceptions;  //!< When the archive was constructed
+  };
+
+  // ######################################################################
+  // DeltaOutputArchive prologue and epilogue functions
+
+  //! Names the value inside a name value pair
+  template <class T> inline
+  void prologue( DeltaOutputArchive & ar, NameValuePair<T> const & t )
+  {
+    ar.startName( t.name );
+  }
+
+  template <class T> inline
+  void epilogue( DeltaOutputArchive & ar, NameValuePair<T> const & )
+  {
+    ar.finishName();
+  }
+
+  //! Sizes are saved as part of their container
+  template <class T> inline
+  void prologue( DeltaOutputArchive &, SizeTag<T> const & )
+  { }
+
+  template <class T> inline
+  void epilogue( DeltaOutputArchive &, SizeTag<T> const & )
+  { }
+
+  //! Starts tracking a value of class type
+  /*! Arithmetic values are only compared as part of their parent */
+  template <class T, traits::EnableIf<std::is_class<T>::value> = traits::sfinae> inline
+  void prologue( DeltaOutputArchive & ar, T const & )
+  {
+    ar.startNode( delta_detail::content_key<T>::name() );
+  }
+
+  template <class T, traits::EnableIf<std::is_class<T>::value> = traits::sfinae> inline
+  void epilogue( DeltaOutputArchive & ar, T const & )
+  {
+    ar.finishNode( delta_detail::content_key<T>::keep );
+  }
+
+  // ######################################################################
+  // Common DeltaOutputArchive serialization functions
+
+  //! Saving for POD types to a delta archive
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(DeltaOutputArchive & ar, T const & t)
+  {
+    ar.saveBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Saving NVP types to a delta archive
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( DeltaOutputArchive & ar, NameValuePair<T> const & t )
+  {
+    ar( t.value );
+  }
+
+  //! Saving SizeTags to a delta archive
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( DeltaOutputArchive & ar, SizeTag<T> const & t )
+  {
+    ar( t.size );
+  }
+
+  //! Saving binary data to a delta archive
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME(DeltaOutputArchive & ar, BinaryData<T> const & bd)
+  {
+    ar.saveBinary( bd.data, static_cast<std::size_t>( bd.size ) );
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::DeltaOutputArchive)
+
+#endif // CEREAL_ARCHIVES_DELTA_HPP_
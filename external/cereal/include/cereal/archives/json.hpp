@@ -67,6 +67,7 @@ namespace cereal
 #include "cereal/external/rapidjson/document.h"
 #include "cereal/external/base64.hpp"
 
+#include <algorithm>
 #include <limits>
 #include <sstream>
 #include <stack>
@@ -256,6 +257,9 @@ namespace cereal
       void saveValue(double d)              { itsWriter.Double(d);                                                       }
       //! Saves a string to the current node
       void saveValue(std::string const & s) { itsWriter.String(s.c_str(), static_cast<CEREAL_RAPIDJSON_NAMESPACE::SizeType>( s.size() )); }
+      //! Saves a string with another allocator, such as a std::pmr::string, to the current node
+      template <class Alloc>
+      void saveValue(std::basic_string<char, std::char_traits<char>, Alloc> const & s) { itsWriter.String(s.c_str(), static_cast<CEREAL_RAPIDJSON_NAMESPACE::SizeType>( s.size() )); }
       //! Saves a const char * to the current node
       void saveValue(char const * s)        { itsWriter.String(s);                                                       }
       //! Saves a nullptr to the current node
@@ -434,14 +438,28 @@ namespace cereal
       /*! @param stream The stream to read from */
       JSONInputArchive(std::istream & stream) :
         InputArchive<JSONInputArchive>(this),
-        itsNextName( nullptr ),
-        itsReadStream(stream)
+        itsNextName( nullptr )
       {
-        itsDocument.ParseStream<>(itsReadStream);
-        if (itsDocument.IsArray())
-          itsIteratorStack.emplace_back(itsDocument.Begin(), itsDocument.End());
-        else
-          itsIteratorStack.emplace_back(itsDocument.MemberBegin(), itsDocument.MemberEnd());
+        // rapidjson reads 4 characters at a time from the stream unless given a larger buffer
+        std::vector<char> buffer( 64 * 1024 );
+        ReadStream readStream( stream, buffer.data(), buffer.size() );
+
+        itsDocument.ParseStream<>(readStream);
+        initIteratorStack();
+      }
+
+      //! Construct, parsing in place from the provided buffer
+      /*! The document is parsed without copying strings out of the buffer: the buffer
+          is modified by the parser and the archive refers to it until it is destroyed.
+
+          @param buffer A null terminated JSON document owned by the caller, which must
+                        outlive the archive */
+      explicit JSONInputArchive(char * buffer) :
+        InputArchive<JSONInputArchive>(this),
+        itsNextName( nullptr )
+      {
+        itsDocument.ParseInsitu(buffer);
+        initIteratorStack();
       }
 
       ~JSONInputArchive() CEREAL_NOEXCEPT = default;
@@ -480,6 +498,9 @@ namespace cereal
       class Iterator
       {
         public:
+          //! Objects with fewer members than this are searched linearly instead of through an index
+          static const size_t IndexThreshold = 16;
+
           Iterator() : itsIndex( 0 ), itsType(Null_) {}
 
           Iterator(MemberIterator begin, MemberIterator end) :
@@ -527,19 +548,38 @@ namespace cereal
           }
 
           //! Adjust our position such that we are at the node with the given name
-          /*! @throws Exception if no such named node exists */
+          /*! Small objects are scanned linearly.  Larger objects build a sorted index of
+              their member names the first time they are searched, so that loading them
+              out of order stays O(log n) per member.
+
+              @throws Exception if no such named node exists */
           inline void search( const char * searchName )
           {
-            const auto len = std::strlen( searchName );
-            size_t index = 0;
-            for( auto it = itsMemberItBegin; it != itsMemberItEnd; ++it, ++index )
+            if( itsType == Member )
             {
-              const auto currentName = it->name.GetString();
-              if( ( std::strncmp( searchName, currentName, len ) == 0 ) &&
-                  ( std::strlen( currentName ) == len ) )
+              if( itsSize < IndexThreshold )
               {
-                itsIndex = index;
-                return;
+                for( size_t index = 0; index < itsSize; ++index )
+                  if( std::strcmp( searchName, itsMemberItBegin[index].name.GetString() ) == 0 )
+                  {
+                    itsIndex = index;
+                    return;
+                  }
+              }
+              else
+              {
+                if( itsSortedMembers.empty() )
+                  buildIndex();
+
+                auto const it = std::lower_bound( itsSortedMembers.begin(), itsSortedMembers.end(), searchName,
+                    [this]( size_t index, const char * name )
+                    { return std::strcmp( itsMemberItBegin[index].name.GetString(), name ) < 0; } );
+
+                if( it != itsSortedMembers.end() && std::strcmp( itsMemberItBegin[*it].name.GetString(), searchName ) == 0 )
+                {
+                  itsIndex = *it;
+                  return;
+                }
               }
             }
 
@@ -547,10 +587,23 @@ namespace cereal
           }
 
         private:
+          //! Sorts the indices of all members by name, keeping duplicate names in document order
+          void buildIndex()
+          {
+            itsSortedMembers.resize( itsSize );
+            for( size_t index = 0; index < itsSize; ++index )
+              itsSortedMembers[index] = index;
+
+            std::stable_sort( itsSortedMembers.begin(), itsSortedMembers.end(),
+                [this]( size_t lhs, size_t rhs )
+                { return std::strcmp( itsMemberItBegin[lhs].name.GetString(), itsMemberItBegin[rhs].name.GetString() ) < 0; } );
+          }
+
           MemberIterator itsMemberItBegin, itsMemberItEnd; //!< The member iterator (object)
           ValueIterator itsValueItBegin;                   //!< The value iterator (array)
           size_t itsIndex, itsSize;                        //!< The current index of this iterator
           enum Type {Value, Member, Null_} itsType;        //!< Whether this holds values (array) or members (objects) or nothing
+          std::vector<size_t> itsSortedMembers;            //!< Member indices sorted by name, built on first search of a large object
       };
 
       //! Searches for the expectedName node if it doesn't match the actualName
@@ -656,6 +709,9 @@ namespace cereal
       void loadValue(double & val)      { search(); val = itsIteratorStack.back().value().GetDouble(); ++itsIteratorStack.back(); }
       //! Loads a value from the current node - string overload
       void loadValue(std::string & val) { search(); val = itsIteratorStack.back().value().GetString(); ++itsIteratorStack.back(); }
+      //! Loads a value from the current node - string with another allocator overload, such as a std::pmr::string
+      template <class Alloc>
+      void loadValue(std::basic_string<char, std::char_traits<char>, Alloc> & val) { search(); val = itsIteratorStack.back().value().GetString(); ++itsIteratorStack.back(); }
       //! Loads a nullptr from the current node
       void loadValue(std::nullptr_t&)   { search(); CEREAL_RAPIDJSON_ASSERT(itsIteratorStack.back().value().IsNull()); ++itsIteratorStack.back(); }
 
@@ -734,8 +790,16 @@ namespace cereal
       //! @}
 
     private:
+      //! Places an iterator for the root of the parsed document on the stack
+      void initIteratorStack()
+      {
+        if (itsDocument.IsArray())
+          itsIteratorStack.emplace_back(itsDocument.Begin(), itsDocument.End());
+        else
+          itsIteratorStack.emplace_back(itsDocument.MemberBegin(), itsDocument.MemberEnd());
+      }
+
       const char * itsNextName;               //!< Next name set by NVP
-      ReadStream itsReadStream;               //!< Rapidjson write stream
       std::vector<Iterator> itsIteratorStack; //!< 'Stack' of rapidJSON iterators
       CEREAL_RAPIDJSON_NAMESPACE::Document itsDocument; //!< Rapidjson document
   };
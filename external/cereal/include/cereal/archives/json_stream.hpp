@@ -0,0 +1,945 @@
+/*! \file json_stream.hpp
+    \brief Streaming JSON input archive */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_JSON_STREAM_HPP_
+#define CEREAL_ARCHIVES_JSON_STREAM_HPP_
+
+#include "cereal/archives/json.hpp"
+#include "cereal/external/rapidjson/reader.h"
+#include "cereal/external/rapidjson/error/en.h"
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace cereal
+{
+  // ######################################################################
+  //! An input archive designed to load data saved by a JSONOutputArchive without building a document
+  /*! The JSONInputArchive parses its entire input into a rapidjson document before loading
+      anything, so it needs several times the size of the input in memory.  This archive instead
+      pulls one token at a time from rapidjson's Reader as data is loaded and only holds the path
+      from the root to the current node in memory.
+
+      Loading in the order data was saved, with or without NVPs, needs no additional memory.  When
+      an NVP does not match the next node, the remaining members of the current object are buffered
+      and the node is looked up among them.  As with the JSONInputArchive, loading then proceeds
+      sequentially from the node that was found.  Unlike the JSONInputArchive, nodes that have
+      already been loaded cannot be searched for again.
+
+      JSON does not store the size of arrays.  When a size is loaded, the remainder of the array
+      is scanned ahead in the underlying stream, which is then repositioned to continue loading.
+      Nested arrays are thus scanned once for each array that contains them.  If the stream cannot
+      be repositioned (e.g. a pipe), the rest of the array is buffered instead.
+
+      \ingroup Archives */
+  class JSONStreamInputArchive : public InputArchive<JSONStreamInputArchive>, public traits::TextArchive
+  {
+    public:
+      /*! @name Common Functionality
+          Common use cases for directly interacting with an JSONStreamInputArchive */
+      //! @{
+
+      //! Construct, reading from the provided stream
+      /*! Reads the start of the root node from the stream
+
+          @param stream The stream to read from */
+      JSONStreamInputArchive(std::istream & stream) :
+        InputArchive<JSONStreamInputArchive>(this),
+        itsNextName( nullptr ),
+        itsStream( stream ),
+        itsHasToken( false )
+      {
+        itsReader.IterativeParseInit();
+
+        auto const & root = peek();
+        if( root.type != Token::StartObject && root.type != Token::StartArray )
+          throw Exception("JSONStreamInputArchive - input does not start with an object or array");
+
+        itsFrames.emplace_back( root.type == Token::StartArray );
+        consume();
+      }
+
+      ~JSONStreamInputArchive() CEREAL_NOEXCEPT = default;
+
+      //! Loads some binary data, encoded as a base64 string
+      /*! This will automatically start and finish a node to load the data, and can be called directly by
+          users.
+
+          Note that this follows the same ordering rules specified in the class description in regards
+          to loading in/out of order */
+      void loadBinaryValue( void * data, size_t size, const char * name = nullptr )
+      {
+        itsNextName = name;
+
+        std::string encoded;
+        loadValue( encoded );
+        auto decoded = base64::decode( encoded );
+
+        if( size != decoded.size() )
+          throw Exception("Decoded binary data size does not match specified size");
+
+        std::memcpy( data, decoded.data(), decoded.size() );
+        itsNextName = nullptr;
+      };
+
+    private:
+      //! @}
+      /*! @name Internal Functionality
+          Functionality designed for use by those requiring control over the inner mechanisms of
+          the JSONStreamInputArchive */
+      //! @{
+
+      //! A single event reported by the rapidjson Reader
+      struct Token
+      {
+        enum Type { Null, Bool, Int, Uint, Double, String, Key, StartObject, EndObject, StartArray, EndArray };
+
+        Token() : type( Null ), u( 0 ) {}
+
+        bool isStart() const { return type == StartObject || type == StartArray; }
+        bool isEnd() const { return type == EndObject || type == EndArray; }
+
+        Type type;
+        union
+        {
+          bool b;          //!< Bool
+          std::int64_t i;  //!< Int, for negative integers
+          std::uint64_t u; //!< Uint, for non negative integers
+          double d;        //!< Double
+        };
+        std::string string; //!< String or Key
+      };
+
+      //! A rapidjson handler that stores the event it receives in a Token
+      struct TokenHandler
+      {
+        typedef char Ch;
+        typedef CEREAL_RAPIDJSON_NAMESPACE::SizeType SizeType;
+
+        bool Null()                   { token.type = Token::Null; return true; }
+        bool Bool( bool b )           { token.type = Token::Bool; token.b = b; return true; }
+        bool Int( int i )             { return Int64( i ); }
+        bool Uint( unsigned u )       { return Uint64( u ); }
+        bool Int64( std::int64_t i )  { token.type = Token::Int; token.i = i; return true; }
+        bool Uint64( std::uint64_t u ){ token.type = Token::Uint; token.u = u; return true; }
+        bool Double( double d )       { token.type = Token::Double; token.d = d; return true; }
+        bool RawNumber( const Ch *, SizeType, bool ) { return false; }
+        bool String( const Ch * str, SizeType length, bool ) { token.type = Token::String; token.string.assign( str, length ); return true; }
+        bool Key( const Ch * str, SizeType length, bool )    { token.type = Token::Key; token.string.assign( str, length ); return true; }
+        bool StartObject()            { token.type = Token::StartObject; return true; }
+        bool EndObject( SizeType )    { token.type = Token::EndObject; return true; }
+        bool StartArray()             { token.type = Token::StartArray; return true; }
+        bool EndArray( SizeType )     { token.type = Token::EndArray; return true; }
+
+        Token & token;
+      };
+
+      //! A rapidjson input stream over a std::istream that can count the elements of an array ahead of the parser
+      class ReadStream
+      {
+        public:
+          typedef char Ch;
+
+          ReadStream( std::istream & stream ) :
+            itsStream( stream ), itsBuffer( 64 * 1024 ), itsLast( nullptr ), itsCurrent( itsBuffer.data() ),
+            itsReadCount( 0 ), itsCount( 0 ), itsEof( false )
+          {
+            read();
+          }
+
+          Ch Peek() const { return *itsCurrent; }
+          Ch Take() { Ch c = *itsCurrent; read(); return c; }
+          size_t Tell() const { return itsCount + static_cast<size_t>( itsCurrent - itsBuffer.data() ); }
+
+          // Not used for reading, but required by the rapidjson stream concept
+          Ch * PutBegin() { CEREAL_RAPIDJSON_ASSERT(false); return nullptr; }
+          void Put( Ch ) { CEREAL_RAPIDJSON_ASSERT(false); }
+          void Flush() { CEREAL_RAPIDJSON_ASSERT(false); }
+          size_t PutEnd( Ch * ) { CEREAL_RAPIDJSON_ASSERT(false); return 0; }
+
+          //! Counts the elements left in the array being read, up to its closing bracket
+          /*! The characters after the current position are scanned, reading ahead from the
+              underlying stream if needed, which is then repositioned.
+
+              @param count Set to the number of elements that have not been read yet
+              @return false if the underlying stream could not be repositioned */
+          bool countElements( size_t & count )
+          {
+            ElementCounter counter;
+
+            // characters already in the buffer; at the end of the input, itsLast is the terminating null
+            counter.scan( itsCurrent, itsLast + ( itsEof ? 0 : 1 ) );
+
+            if( !counter.done && !itsEof )
+            {
+              auto const resume = itsStream.tellg();
+              if( resume == std::istream::pos_type( -1 ) )
+                return false;
+
+              itsScanBuffer.resize( itsBuffer.size() );
+              while( !counter.done )
+              {
+                itsStream.read( itsScanBuffer.data(), static_cast<std::streamsize>( itsScanBuffer.size() ) );
+                auto const read = static_cast<size_t>( itsStream.gcount() );
+                if( read == 0 )
+                  break;
+
+                counter.scan( itsScanBuffer.data(), itsScanBuffer.data() + read );
+              }
+
+              itsStream.clear();
+              if( !itsStream.seekg( resume ) )
+                throw Exception("JSONStreamInputArchive - failed to reposition the input stream");
+            }
+
+            count = counter.count();
+            return true;
+          }
+
+        private:
+          //! Counts the values of an array from its contents, skipping over nested nodes and strings
+          struct ElementCounter
+          {
+            ElementCounter() : depth( 0 ), commas( 0 ), started( false ), nonEmpty( false ), inString( false ), escaped( false ), done( false ) {}
+
+            //! Scans a range of characters, stopping at the end of the array
+            void scan( const Ch * c, const Ch * const end )
+            {
+              auto const & table = characterTable();
+
+              while( c != end && !done )
+              {
+                if( !started )
+                {
+                  // the first character after the opening bracket tells whether the array is empty
+                  if( table[static_cast<unsigned char>( *c )] & Space )
+                  {
+                    ++c;
+                    continue;
+                  }
+
+                  started = true;
+                  nonEmpty = *c != ']';
+                }
+
+                if( escaped )
+                {
+                  escaped = false;
+                  ++c;
+                }
+                else if( inString )
+                {
+                  while( c != end && !( table[static_cast<unsigned char>( *c )] & StringControl ) )
+                    ++c;
+
+                  if( c != end )
+                  {
+                    escaped = *c == '\\';
+                    inString = escaped;
+                    ++c;
+                  }
+                }
+                else
+                {
+                  while( c != end && !( table[static_cast<unsigned char>( *c )] & Structure ) )
+                    ++c;
+
+                  if( c != end )
+                    structure( *c++ );
+                }
+              }
+            }
+
+            //! Handles a character that can change the structure outside of strings
+            void structure( Ch c )
+            {
+              switch( c )
+              {
+                case '"':
+                  inString = true;
+                  break;
+                case '[': case '{':
+                  ++depth;
+                  break;
+                case ']': case '}':
+                  if( depth == 0 )
+                    done = true;
+                  else
+                    --depth;
+                  break;
+                default: // ','
+                  if( depth == 0 )
+                    ++commas;
+                  break;
+              }
+            }
+
+            size_t count() const { return nonEmpty ? commas + 1 : 0; }
+
+            enum { Space = 1, Structure = 2, StringControl = 4 };
+
+            //! Classifies the characters the scan stops at
+            static std::array<unsigned char, 256> const & characterTable()
+            {
+              static const std::array<unsigned char, 256> table = []()
+              {
+                std::array<unsigned char, 256> t{};
+                for( unsigned char c : { ' ', '\t', '\n', '\r' } )
+                  t[c] = Space;
+                for( unsigned char c : { '"', '[', ']', '{', '}', ',' } )
+                  t[c] = Structure;
+                t['"'] |= StringControl;
+                t['\\'] = StringControl;
+                return t;
+              }();
+
+              return table;
+            }
+
+            size_t depth, commas;
+            bool started, nonEmpty, inString, escaped, done;
+          };
+
+          //! Advances to the next character, refilling the buffer when needed
+          void read()
+          {
+            if( itsCurrent < itsLast )
+              ++itsCurrent;
+            else if( !itsEof )
+            {
+              itsCount += itsReadCount;
+              itsReadCount = itsBuffer.size();
+              itsLast = itsBuffer.data() + itsReadCount - 1;
+              itsCurrent = itsBuffer.data();
+
+              if( !itsStream.read( itsBuffer.data(), static_cast<std::streamsize>( itsBuffer.size() ) ) )
+              {
+                itsReadCount = static_cast<size_t>( itsStream.gcount() );
+                itsLast = itsBuffer.data() + itsReadCount;
+                *itsLast = '\0';
+                itsEof = true;
+              }
+            }
+          }
+
+          std::istream & itsStream;
+          std::vector<Ch> itsBuffer;     //!< Characters read from the stream
+          std::vector<Ch> itsScanBuffer; //!< Characters read ahead while counting elements
+          Ch * itsLast;                  //!< The last character in the buffer, or the terminating null at the end of the input
+          Ch * itsCurrent;               //!< The current character
+          size_t itsReadCount;           //!< Number of characters in the buffer
+          size_t itsCount;               //!< Number of characters read before the buffer
+          bool itsEof;                   //!< Whether the end of the stream has been reached
+      };
+
+      //! The value of a member or element that was buffered for loading out of order
+      struct Member
+      {
+        std::string name;          //!< The name of the member, empty for array elements
+        std::vector<Token> tokens; //!< The tokens of the value
+      };
+
+      //! An object or array that has been started but not finished
+      struct Frame
+      {
+        Frame( bool array ) : isArray( array ), buffered( false ), index( 0 ), next( 0 ) {}
+
+        bool isArray;                //!< Whether this is an array, as opposed to an object
+        bool buffered;               //!< Whether the rest of the node, up to its end, has been read into members
+        size_t index;                //!< Number of children loaded
+        size_t next;                 //!< Position in members of the next child to load sequentially
+        std::vector<Member> members; //!< The buffered children
+      };
+
+      //! Buffered tokens that are read before any others
+      struct Replay
+      {
+        std::vector<Token> const * tokens;
+        size_t position;
+      };
+
+      //! Returns the next token without consuming it
+      Token const & peek()
+      {
+        if( !itsReplays.empty() )
+          return (*itsReplays.back().tokens)[itsReplays.back().position];
+
+        if( !itsHasToken )
+        {
+          if( itsReader.IterativeParseComplete() )
+            throw Exception("No more objects in input");
+
+          TokenHandler handler{ itsToken };
+          if( !itsReader.IterativeParseNext<CEREAL_RAPIDJSON_NAMESPACE::kParseDefaultFlags>( itsStream, handler ) )
+            throw Exception( std::string("JSONStreamInputArchive - parse error at offset ") + std::to_string( itsReader.GetErrorOffset() ) +
+                             ": " + CEREAL_RAPIDJSON_NAMESPACE::GetParseError_En( itsReader.GetParseErrorCode() ) );
+          itsHasToken = true;
+        }
+
+        return itsToken;
+      }
+
+      //! Consumes the token returned by peek
+      void consume()
+      {
+        if( !itsReplays.empty() )
+        {
+          if( ++itsReplays.back().position == itsReplays.back().tokens->size() )
+            itsReplays.pop_back();
+        }
+        else
+          itsHasToken = false;
+      }
+
+      //! Reads the remaining children of the current node, up to and including its end, into its members
+      void bufferMembers()
+      {
+        auto & frame = itsFrames.back();
+        frame.buffered = true;
+        frame.next = 0;
+
+        while( !peek().isEnd() )
+        {
+          frame.members.emplace_back();
+          auto & member = frame.members.back();
+
+          if( !frame.isArray )
+          {
+            member.name = peek().string;
+            consume();
+          }
+
+          size_t depth = 0;
+          do
+          {
+            member.tokens.push_back( peek() );
+            consume();
+
+            if( member.tokens.back().isStart() )
+              ++depth;
+            else if( member.tokens.back().isEnd() )
+              --depth;
+          } while( depth > 0 );
+        }
+
+        consume();
+      }
+
+      //! Positions the input at the value of the next child to load
+      /*! This needs to be called before every load or node start occurs.  If an NVP has been provided
+          (with setNextName) and does not match the name of the next member of the current object, the rest
+          of the object is buffered and the name is searched for among its members.
+
+          Resets the NVP name after called.
+
+          @throws Exception if an expectedName is given and not found, or the node has no more children */
+      void search()
+      {
+        // store pointer to itsNextName locally and reset to nullptr in case search() throws
+        auto localNextName = itsNextName;
+        itsNextName = nullptr;
+
+        auto & frame = itsFrames.back();
+
+        // array elements have no names to search for
+        if( localNextName && frame.isArray )
+          throw Exception("JSON Parsing failed - provided NVP (" + std::string(localNextName) + ") not found");
+
+        if( !frame.buffered )
+        {
+          auto const & token = peek();
+          if( token.isEnd() && !localNextName )
+            throw Exception("No more objects in input");
+
+          if( frame.isArray )
+          {
+            ++frame.index;
+            return;
+          }
+
+          if( token.type == Token::Key && ( !localNextName || token.string == localNextName ) )
+          {
+            consume();
+            ++frame.index;
+            return;
+          }
+
+          bufferMembers();
+        }
+
+        auto index = frame.next;
+        if( localNextName )
+        {
+          index = 0;
+          while( index < frame.members.size() && frame.members[index].name != localNextName )
+            ++index;
+
+          if( index == frame.members.size() )
+            throw Exception("JSON Parsing failed - provided NVP (" + std::string(localNextName) + ") not found");
+        }
+        else if( index == frame.members.size() )
+          throw Exception("No more objects in input");
+
+        frame.next = index + 1;
+        ++frame.index;
+        itsReplays.push_back( { &frame.members[index].tokens, 0 } );
+      }
+
+    public:
+      //! Starts a new node, going into its first child
+      /*! The node is loaded in the order it appears in the input.  If we were given an NVP, we will search
+          for it if it does not match the name of the next node.  This functionality is provided by search(). */
+      void startNode()
+      {
+        search();
+
+        auto const & token = peek();
+        if( !token.isStart() )
+          throw Exception("JSONStreamInputArchive - expected an object or array");
+
+        itsFrames.emplace_back( token.type == Token::StartArray );
+        consume();
+      }
+
+      //! Finishes the most recently started node, skipping any children that were not loaded
+      void finishNode()
+      {
+        if( !itsFrames.back().buffered )
+        {
+          size_t depth = 0;
+          while( true )
+          {
+            auto const & token = peek();
+            if( token.isEnd() && depth-- == 0 )
+              break;
+            if( token.isStart() )
+              ++depth;
+            consume();
+          }
+          consume();
+        }
+
+        itsFrames.pop_back();
+      }
+
+      //! Retrieves the current node name
+      /*! @return nullptr if no name exists */
+      const char * getNodeName()
+      {
+        auto const & frame = itsFrames.back();
+        if( frame.isArray )
+          return nullptr;
+
+        if( frame.buffered )
+          return frame.next < frame.members.size() ? frame.members[frame.next].name.c_str() : nullptr;
+
+        auto const & token = peek();
+        return token.type == Token::Key ? token.string.c_str() : nullptr;
+      }
+
+      //! Sets the name for the next node created with startNode
+      void setNextName( const char * name )
+      {
+        itsNextName = name;
+      }
+
+    private:
+      //! Returns the value of the next token as a signed integer and consumes it
+      std::int64_t loadInt64()
+      {
+        search();
+
+        auto const & token = peek();
+        std::int64_t value;
+        if( token.type == Token::Int )
+          value = token.i;
+        else if( token.type == Token::Uint && token.u <= static_cast<std::uint64_t>( std::numeric_limits<std::int64_t>::max() ) )
+          value = static_cast<std::int64_t>( token.u );
+        else
+          throw Exception("JSONStreamInputArchive - expected a signed integer");
+
+        consume();
+        return value;
+      }
+
+      //! Returns the value of the next token as an unsigned integer and consumes it
+      std::uint64_t loadUint64()
+      {
+        search();
+
+        auto const & token = peek();
+        if( token.type != Token::Uint )
+          throw Exception("JSONStreamInputArchive - expected an unsigned integer");
+
+        auto const value = token.u;
+        consume();
+        return value;
+      }
+
+      //! Checks that a signed integer fits in an int
+      static int narrow( std::int64_t value )
+      {
+        if( value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max() )
+          throw Exception("JSONStreamInputArchive - integer out of range");
+        return static_cast<int>( value );
+      }
+
+      //! Checks that an unsigned integer fits in an unsigned
+      static unsigned narrow( std::uint64_t value )
+      {
+        if( value > std::numeric_limits<unsigned>::max() )
+          throw Exception("JSONStreamInputArchive - integer out of range");
+        return static_cast<unsigned>( value );
+      }
+
+    public:
+      //! Loads a value from the current node - small signed overload
+      template <class T, traits::EnableIf<std::is_signed<T>::value,
+                                          sizeof(T) < sizeof(int64_t)> = traits::sfinae> inline
+      void loadValue(T & val)
+      {
+        val = static_cast<T>( narrow( loadInt64() ) );
+      }
+
+      //! Loads a value from the current node - small unsigned overload
+      template <class T, traits::EnableIf<std::is_unsigned<T>::value,
+                                          sizeof(T) < sizeof(uint64_t),
+                                          !std::is_same<bool, T>::value> = traits::sfinae> inline
+      void loadValue(T & val)
+      {
+        val = static_cast<T>( narrow( loadUint64() ) );
+      }
+
+      //! Loads a value from the current node - bool overload
+      void loadValue(bool & val)
+      {
+        search();
+        if( peek().type != Token::Bool )
+          throw Exception("JSONStreamInputArchive - expected a bool");
+        val = peek().b;
+        consume();
+      }
+
+      //! Loads a value from the current node - int64 overload
+      void loadValue(int64_t & val)     { val = loadInt64(); }
+      //! Loads a value from the current node - uint64 overload
+      void loadValue(uint64_t & val)    { val = loadUint64(); }
+      //! Loads a value from the current node - float overload
+      void loadValue(float & val)       { double d; loadValue( d ); val = static_cast<float>( d ); }
+
+      //! Loads a value from the current node - double overload
+      void loadValue(double & val)
+      {
+        search();
+        auto const & token = peek();
+        switch( token.type )
+        {
+          case Token::Int: val = static_cast<double>( token.i ); break;
+          case Token::Uint: val = static_cast<double>( token.u ); break;
+          case Token::Double: val = token.d; break;
+          default: throw Exception("JSONStreamInputArchive - expected a number");
+        }
+        consume();
+      }
+
+      //! Loads a value from the current node - string overload
+      void loadValue(std::string & val)
+      {
+        search();
+        if( peek().type != Token::String )
+          throw Exception("JSONStreamInputArchive - expected a string");
+        val = peek().string;
+        consume();
+      }
+
+      //! Loads a nullptr from the current node
+      void loadValue(std::nullptr_t&)
+      {
+        search();
+        if( peek().type != Token::Null )
+          throw Exception("JSONStreamInputArchive - expected null");
+        consume();
+      }
+
+      // Special cases to handle various flavors of long, which tend to conflict with
+      // the int32_t or int64_t on various compiler/OS combinations.  MSVC doesn't need any of this.
+      #ifndef _MSC_VER
+    private:
+      //! 32 bit signed long loading from current node
+      template <class T> inline
+      typename std::enable_if<sizeof(T) == sizeof(std::int32_t) && std::is_signed<T>::value, void>::type
+      loadLong(T & l){ loadValue( reinterpret_cast<std::int32_t&>( l ) ); }
+
+      //! non 32 bit signed long loading from current node
+      template <class T> inline
+      typename std::enable_if<sizeof(T) == sizeof(std::int64_t) && std::is_signed<T>::value, void>::type
+      loadLong(T & l){ loadValue( reinterpret_cast<std::int64_t&>( l ) ); }
+
+      //! 32 bit unsigned long loading from current node
+      template <class T> inline
+      typename std::enable_if<sizeof(T) == sizeof(std::uint32_t) && !std::is_signed<T>::value, void>::type
+      loadLong(T & lu){ loadValue( reinterpret_cast<std::uint32_t&>( lu ) ); }
+
+      //! non 32 bit unsigned long loading from current node
+      template <class T> inline
+      typename std::enable_if<sizeof(T) == sizeof(std::uint64_t) && !std::is_signed<T>::value, void>::type
+      loadLong(T & lu){ loadValue( reinterpret_cast<std::uint64_t&>( lu ) ); }
+
+    public:
+      //! Serialize a long if it would not be caught otherwise
+      template <class T> inline
+      typename std::enable_if<std::is_same<T, long>::value &&
+                              sizeof(T) >= sizeof(std::int64_t) &&
+                              !std::is_same<T, std::int64_t>::value, void>::type
+      loadValue( T & t ){ loadLong(t); }
+
+      //! Serialize an unsigned long if it would not be caught otherwise
+      template <class T> inline
+      typename std::enable_if<std::is_same<T, unsigned long>::value &&
+                              sizeof(T) >= sizeof(std::uint64_t) &&
+                              !std::is_same<T, std::uint64_t>::value, void>::type
+      loadValue( T & t ){ loadLong(t); }
+      #endif // _MSC_VER
+
+    private:
+      //! Convert a string to a long long
+      void stringToNumber( std::string const & str, long long & val ) { val = std::stoll( str ); }
+      //! Convert a string to an unsigned long long
+      void stringToNumber( std::string const & str, unsigned long long & val ) { val = std::stoull( str ); }
+      //! Convert a string to a long double
+      void stringToNumber( std::string const & str, long double & val ) { val = std::stold( str ); }
+
+    public:
+      //! Loads a value from the current node - long double and long long overloads
+      template <class T, traits::EnableIf<std::is_arithmetic<T>::value,
+                                          !std::is_same<T, long>::value,
+                                          !std::is_same<T, unsigned long>::value,
+                                          !std::is_same<T, std::int64_t>::value,
+                                          !std::is_same<T, std::uint64_t>::value,
+                                          (sizeof(T) >= sizeof(long double) || sizeof(T) >= sizeof(long long))> = traits::sfinae>
+      inline void loadValue(T & val)
+      {
+        std::string encoded;
+        loadValue( encoded );
+        stringToNumber( encoded, val );
+      }
+
+      //! Loads the size for a SizeTag
+      /*! Counts the elements of the current array without loading them, see the class description */
+      void loadSize(size_type & size)
+      {
+        auto & frame = itsFrames.back();
+        if( !frame.isArray )
+          throw Exception("JSONStreamInputArchive - size requested for an object");
+
+        if( frame.buffered )
+        {
+          size = frame.index - frame.next + frame.members.size();
+          return;
+        }
+
+        size_t remaining = 0;
+        if( !itsReplays.empty() )
+        {
+          // the array is being replayed from a buffered member
+          auto const & replay = itsReplays.back();
+          size_t depth = 0;
+          for( auto token = replay.tokens->begin() + static_cast<std::ptrdiff_t>( replay.position ); depth > 0 || token->type != Token::EndArray; ++token )
+          {
+            if( depth == 0 )
+              ++remaining;
+            if( token->isStart() )
+              ++depth;
+            else if( token->isEnd() )
+              --depth;
+          }
+        }
+        else if( !itsHasToken && !itsStream.countElements( remaining ) )
+        {
+          bufferMembers();
+          remaining = frame.members.size();
+        }
+
+        size = frame.index + remaining;
+      }
+
+      //! @}
+
+    private:
+      const char * itsNextName;        //!< Next name set by NVP
+      ReadStream itsStream;            //!< The stream tokens are parsed from
+      CEREAL_RAPIDJSON_NAMESPACE::Reader itsReader; //!< Rapidjson reader, parsing one token at a time
+      Token itsToken;                  //!< The next token read from the stream
+      bool itsHasToken;                //!< Whether itsToken has been read but not consumed
+      std::vector<Frame> itsFrames;    //!< The nodes that have been started but not finished
+      std::vector<Replay> itsReplays;  //!< Buffered tokens to read before the stream
+  };
+
+  // ######################################################################
+  // JSONStreamInputArchive prologue and epilogue functions
+  // ######################################################################
+
+  // ######################################################################
+  //! Prologue for NVPs for streaming JSON archives
+  /*! NVPs do not start or finish nodes - they just set up the names */
+  template <class T> inline
+  void prologue( JSONStreamInputArchive &, NameValuePair<T> const & )
+  { }
+
+  //! Epilogue for NVPs for streaming JSON archives
+  template <class T> inline
+  void epilogue( JSONStreamInputArchive &, NameValuePair<T> const & )
+  { }
+
+  //! Prologue for deferred data for streaming JSON archives
+  template <class T> inline
+  void prologue( JSONStreamInputArchive &, DeferredData<T> const & )
+  { }
+
+  //! Epilogue for deferred data for streaming JSON archives
+  template <class T> inline
+  void epilogue( JSONStreamInputArchive &, DeferredData<T> const & )
+  { }
+
+  //! Prologue for SizeTags for streaming JSON archives
+  template <class T> inline
+  void prologue( JSONStreamInputArchive &, SizeTag<T> const & )
+  { }
+
+  //! Epilogue for SizeTags for streaming JSON archives
+  template <class T> inline
+  void epilogue( JSONStreamInputArchive &, SizeTag<T> const & )
+  { }
+
+  // ######################################################################
+  //! Prologue for all other types for streaming JSON archives (except minimal types)
+  /*! Starts a new node, named either automatically or by some NVP
+
+      Minimal types do not start or finish nodes */
+  template <class T, traits::EnableIf<!std::is_arithmetic<T>::value,
+                                      !traits::has_minimal_base_class_serialization<T, traits::has_minimal_input_serialization, JSONStreamInputArchive>::value,
+                                      !traits::has_minimal_input_serialization<T, JSONStreamInputArchive>::value> = traits::sfinae>
+  inline void prologue( JSONStreamInputArchive & ar, T const & )
+  {
+    ar.startNode();
+  }
+
+  //! Epilogue for all other types for streaming JSON archives (except minimal types)
+  /*! Finishes the node created in the prologue */
+  template <class T, traits::EnableIf<!std::is_arithmetic<T>::value,
+                                      !traits::has_minimal_base_class_serialization<T, traits::has_minimal_input_serialization, JSONStreamInputArchive>::value,
+                                      !traits::has_minimal_input_serialization<T, JSONStreamInputArchive>::value> = traits::sfinae>
+  inline void epilogue( JSONStreamInputArchive & ar, T const & )
+  {
+    ar.finishNode();
+  }
+
+  //! Prologue for nullptr for streaming JSON archives
+  inline
+  void prologue( JSONStreamInputArchive &, std::nullptr_t const & )
+  { }
+
+  //! Epilogue for nullptr for streaming JSON archives
+  inline
+  void epilogue( JSONStreamInputArchive &, std::nullptr_t const & )
+  { }
+
+  //! Prologue for arithmetic types for streaming JSON archives
+  template <class T, traits::EnableIf<std::is_arithmetic<T>::value> = traits::sfinae> inline
+  void prologue( JSONStreamInputArchive &, T const & )
+  { }
+
+  //! Epilogue for arithmetic types for streaming JSON archives
+  template <class T, traits::EnableIf<std::is_arithmetic<T>::value> = traits::sfinae> inline
+  void epilogue( JSONStreamInputArchive &, T const & )
+  { }
+
+  //! Prologue for strings for streaming JSON archives
+  template<class CharT, class Traits, class Alloc> inline
+  void prologue(JSONStreamInputArchive &, std::basic_string<CharT, Traits, Alloc> const &)
+  { }
+
+  //! Epilogue for strings for streaming JSON archives
+  template<class CharT, class Traits, class Alloc> inline
+  void epilogue(JSONStreamInputArchive &, std::basic_string<CharT, Traits, Alloc> const &)
+  { }
+
+  // ######################################################################
+  // Common JSONStreamInputArchive serialization functions
+  // ######################################################################
+  //! Loading NVP types from streaming JSON
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( JSONStreamInputArchive & ar, NameValuePair<T> & t )
+  {
+    ar.setNextName( t.name );
+    ar( t.value );
+  }
+
+  //! Loading nullptr from streaming JSON
+  inline
+  void CEREAL_LOAD_FUNCTION_NAME(JSONStreamInputArchive & ar, std::nullptr_t & t)
+  {
+    ar.loadValue( t );
+  }
+
+  //! Loading arithmetic from streaming JSON
+  template <class T, traits::EnableIf<std::is_arithmetic<T>::value> = traits::sfinae> inline
+  void CEREAL_LOAD_FUNCTION_NAME(JSONStreamInputArchive & ar, T & t)
+  {
+    ar.loadValue( t );
+  }
+
+  //! Loading string from streaming JSON
+  template<class CharT, class Traits, class Alloc> inline
+  void CEREAL_LOAD_FUNCTION_NAME(JSONStreamInputArchive & ar, std::basic_string<CharT, Traits, Alloc> & str)
+  {
+    ar.loadValue( str );
+  }
+
+  //! Loading SizeTags from streaming JSON
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( JSONStreamInputArchive & ar, SizeTag<T> & st )
+  {
+    ar.loadSize( st.size );
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::JSONStreamInputArchive)
+
+// tie the archive to the JSONOutputArchive, which is already tied to the JSONInputArchive
+namespace cereal { namespace traits { namespace detail {
+  template <> struct get_output_from_input<cereal::JSONStreamInputArchive>
+  { using type = cereal::JSONOutputArchive; };
+} } } // end namespaces
+
+#endif // CEREAL_ARCHIVES_JSON_STREAM_HPP_
@@ -30,8 +30,22 @@
 #define CEREAL_ARCHIVES_PORTABLE_BINARY_HPP_
 
 #include "cereal/cereal.hpp"
+#include "cereal/details/compression.hpp"
 #include <sstream>
 #include <limits>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+//! Enables runtime selected SSSE3/AVX2 byte swapping kernels on x86 with GCC or clang
+/*! Define CEREAL_PORTABLE_BINARY_NO_SIMD before including this file to always use the scalar kernels */
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(CEREAL_PORTABLE_BINARY_NO_SIMD)
+#define CEREAL_PORTABLE_BINARY_X86_SIMD
+#include <immintrin.h>
+#elif defined(_MSC_VER)
+#include <stdlib.h>
+#endif
 
 namespace cereal
 {
@@ -55,6 +69,232 @@ namespace cereal
       for( std::size_t i = 0, end = DataSize / 2; i < end; ++i )
         std::swap( data[i], data[DataSize - i - 1] );
     }
+
+    //! Reverses the bytes of an unsigned integer
+    /*! @ingroup Internal */
+    inline std::uint16_t byte_swap( std::uint16_t value )
+    {
+      #if defined(__GNUC__) || defined(__clang__)
+      return __builtin_bswap16( value );
+      #elif defined(_MSC_VER)
+      return _byteswap_ushort( value );
+      #else
+      return static_cast<std::uint16_t>( ( value << 8 ) | ( value >> 8 ) );
+      #endif
+    }
+
+    //! Reverses the bytes of an unsigned integer
+    /*! @ingroup Internal */
+    inline std::uint32_t byte_swap( std::uint32_t value )
+    {
+      #if defined(__GNUC__) || defined(__clang__)
+      return __builtin_bswap32( value );
+      #elif defined(_MSC_VER)
+      return _byteswap_ulong( value );
+      #else
+      return ( static_cast<std::uint32_t>( byte_swap( static_cast<std::uint16_t>( value ) ) ) << 16 ) |
+             byte_swap( static_cast<std::uint16_t>( value >> 16 ) );
+      #endif
+    }
+
+    //! Reverses the bytes of an unsigned integer
+    /*! @ingroup Internal */
+    inline std::uint64_t byte_swap( std::uint64_t value )
+    {
+      #if defined(__GNUC__) || defined(__clang__)
+      return __builtin_bswap64( value );
+      #elif defined(_MSC_VER)
+      return _byteswap_uint64( value );
+      #else
+      return ( static_cast<std::uint64_t>( byte_swap( static_cast<std::uint32_t>( value ) ) ) << 32 ) |
+             byte_swap( static_cast<std::uint32_t>( value >> 32 ) );
+      #endif
+    }
+
+    //! Unsigned integer type with a size of DataSize bytes, if there is one
+    /*! @ingroup Internal */
+    template <std::size_t DataSize> struct swap_type { };
+    template <> struct swap_type<2> { using type = std::uint16_t; };
+    template <> struct swap_type<4> { using type = std::uint32_t; };
+    template <> struct swap_type<8> { using type = std::uint64_t; };
+
+    //! Swaps the order of bytes for every element of a block of memory, one element at a time
+    /*! @param data The block of memory
+        @param size The size of the block in bytes, a multiple of DataSize
+        @tparam DataSize The size of one element, which has no matching integer type
+        @ingroup Internal */
+    template <std::size_t DataSize> inline
+    typename std::enable_if<DataSize != 2 && DataSize != 4 && DataSize != 8, void>::type
+    swap_bytes_block_scalar( std::uint8_t * data, std::size_t size )
+    {
+      for( std::size_t i = 0; i < size; i += DataSize )
+        swap_bytes<DataSize>( data + i );
+    }
+
+    //! Swaps the order of bytes for every element of a block of memory, one element at a time
+    /*! Overload for element sizes matching an integer type, which is swapped with a single instruction
+        @ingroup Internal */
+    template <std::size_t DataSize> inline
+    typename std::enable_if<DataSize == 2 || DataSize == 4 || DataSize == 8, void>::type
+    swap_bytes_block_scalar( std::uint8_t * data, std::size_t size )
+    {
+      typename swap_type<DataSize>::type value;
+      for( std::size_t i = 0; i < size; i += DataSize )
+      {
+        std::memcpy( &value, data + i, DataSize );
+        value = byte_swap( value );
+        std::memcpy( data + i, &value, DataSize );
+      }
+    }
+
+    //! Signature shared by all block byte swapping kernels
+    /*! @ingroup Internal */
+    using swap_bytes_block_function = void (*)( std::uint8_t *, std::size_t );
+
+    #ifdef CEREAL_PORTABLE_BINARY_X86_SIMD
+    //! Whether a SIMD kernel exists for elements of DataSize bytes
+    /*! A byte shuffle reverses elements in place as long as they evenly divide a 16 byte lane
+        @ingroup Internal */
+    template <std::size_t DataSize>
+    struct has_simd_swap : std::integral_constant<bool, DataSize == 2 || DataSize == 4 || DataSize == 8 || DataSize == 16> { };
+
+    //! Fills mask with the byte shuffle control that reverses every DataSize bytes
+    /*! @ingroup Internal */
+    template <std::size_t DataSize>
+    inline void swap_shuffle_mask( std::uint8_t (&mask)[32] )
+    {
+      for( std::size_t i = 0; i < 32; ++i )
+        mask[i] = static_cast<std::uint8_t>( ( i % 16 ) / DataSize * DataSize + DataSize - 1 - i % DataSize );
+    }
+
+    //! Swaps the order of bytes for every element of a block of memory, 16 bytes at a time
+    /*! Requires SSSE3
+        @ingroup Internal */
+    template <std::size_t DataSize>
+    __attribute__((target("ssse3")))
+    inline void swap_bytes_block_ssse3( std::uint8_t * data, std::size_t size )
+    {
+      std::uint8_t maskBytes[32];
+      swap_shuffle_mask<DataSize>( maskBytes );
+      __m128i const mask = _mm_loadu_si128( reinterpret_cast<__m128i const *>( maskBytes ) );
+
+      std::size_t i = 0;
+      for( ; i + 16 <= size; i += 16 )
+      {
+        __m128i * const block = reinterpret_cast<__m128i *>( data + i );
+        _mm_storeu_si128( block, _mm_shuffle_epi8( _mm_loadu_si128( block ), mask ) );
+      }
+
+      swap_bytes_block_scalar<DataSize>( data + i, size - i );
+    }
+
+    //! Swaps the order of bytes for every element of a block of memory, 32 bytes at a time
+    /*! Requires AVX2
+        @ingroup Internal */
+    template <std::size_t DataSize>
+    __attribute__((target("avx2")))
+    inline void swap_bytes_block_avx2( std::uint8_t * data, std::size_t size )
+    {
+      std::uint8_t maskBytes[32];
+      swap_shuffle_mask<DataSize>( maskBytes );
+      __m256i const mask = _mm256_loadu_si256( reinterpret_cast<__m256i const *>( maskBytes ) );
+
+      std::size_t i = 0;
+      for( ; i + 64 <= size; i += 64 )
+      {
+        __m256i * const block = reinterpret_cast<__m256i *>( data + i );
+        __m256i const first  = _mm256_loadu_si256( block );
+        __m256i const second = _mm256_loadu_si256( block + 1 );
+        _mm256_storeu_si256( block,     _mm256_shuffle_epi8( first, mask ) );
+        _mm256_storeu_si256( block + 1, _mm256_shuffle_epi8( second, mask ) );
+      }
+      for( ; i + 32 <= size; i += 32 )
+      {
+        __m256i * const block = reinterpret_cast<__m256i *>( data + i );
+        _mm256_storeu_si256( block, _mm256_shuffle_epi8( _mm256_loadu_si256( block ), mask ) );
+      }
+
+      swap_bytes_block_scalar<DataSize>( data + i, size - i );
+    }
+
+    //! Picks the fastest kernel supported by the running processor
+    /*! @ingroup Internal */
+    template <std::size_t DataSize> inline
+    typename std::enable_if<has_simd_swap<DataSize>::value, swap_bytes_block_function>::type
+    select_swap_bytes_block()
+    {
+      __builtin_cpu_init();
+      if( __builtin_cpu_supports( "avx2" ) )
+        return &swap_bytes_block_avx2<DataSize>;
+      if( __builtin_cpu_supports( "ssse3" ) )
+        return &swap_bytes_block_ssse3<DataSize>;
+      return &swap_bytes_block_scalar<DataSize>;
+    }
+
+    //! Picks the scalar kernel for element sizes without a SIMD kernel
+    /*! @ingroup Internal */
+    template <std::size_t DataSize> inline
+    typename std::enable_if<!has_simd_swap<DataSize>::value, swap_bytes_block_function>::type
+    select_swap_bytes_block()
+    {
+      return &swap_bytes_block_scalar<DataSize>;
+    }
+    #else // no SIMD support
+    //! Picks the scalar kernel, SIMD kernels are not available for this platform
+    /*! @ingroup Internal */
+    template <std::size_t DataSize>
+    inline swap_bytes_block_function select_swap_bytes_block()
+    {
+      return &swap_bytes_block_scalar<DataSize>;
+    }
+    #endif // CEREAL_PORTABLE_BINARY_X86_SIMD
+
+    //! Swaps the order of bytes for every element of a block of memory
+    /*! The kernel is chosen once per element size, based on the capabilities of
+        the running processor.
+
+        @param data The block of memory
+        @param size The size of the block in bytes, a multiple of DataSize
+        @tparam DataSize The size of one element
+        @ingroup Internal */
+    template <std::size_t DataSize>
+    inline void swap_bytes_block( std::uint8_t * data, std::size_t size )
+    {
+      if( size == DataSize )
+        return swap_bytes<DataSize>( data );
+
+      static const swap_bytes_block_function kernel = select_swap_bytes_block<DataSize>();
+      kernel( data, size );
+    }
+
+    //! Number of bytes swapped on the stack at a time when saving with conversion
+    /*! A multiple of DataSize
+        @ingroup Internal */
+    template <std::size_t DataSize>
+    struct swap_chunk_size : std::integral_constant<std::size_t, DataSize < 4096 ? 4096 / DataSize * DataSize : DataSize> { };
+
+    //! Swaps the bytes of each field of a block of elements
+    /*! @param data The block of memory
+        @param size The size of the block in bytes, a multiple of the size of one element
+        @param fields The size of each field of one element, in order
+        @ingroup Internal */
+    inline void swap_fields( std::uint8_t * data, std::size_t size, std::vector<std::size_t> const & fields )
+    {
+      for( auto const end = data + size; data != end; )
+        for( auto const field : fields )
+        {
+          switch( field )
+          {
+            case 1: break;
+            case 2: swap_bytes<2>( data ); break;
+            case 4: swap_bytes<4>( data ); break;
+            case 8: swap_bytes<8>( data ); break;
+            default: std::reverse( data, data + field ); break;
+          }
+
+          data += field;
+        }
+    }
   } // end namespace portable_binary_detail
 
   // ######################################################################
@@ -120,34 +360,89 @@ namespace cereal
       PortableBinaryOutputArchive(std::ostream & stream, Options const & options = Options::Default()) :
         OutputArchive<PortableBinaryOutputArchive, AllowEmptyClassElision>(this),
         itsStream(stream),
+        itsBuffer(stream.rdbuf()),
+        itsConvertEndianness( portable_binary_detail::is_little_endian() ^ options.is_little_endian() )
+      {
+        this->operator()( options.is_little_endian() );
+      }
+
+      //! Construct, compressing the output to the provided stream
+      /*! @param stream The stream to output to. Should be opened with std::ios::binary flag.
+          @param options The PortableBinary specific options to use
+          @param compression How to compress the output.  Load it with a PortableBinaryInputArchive
+                             given the same codec.  See Compression for details. */
+      PortableBinaryOutputArchive(std::ostream & stream, Options const & options, Compression const & compression) :
+        OutputArchive<PortableBinaryOutputArchive, AllowEmptyClassElision>(this),
+        itsStream(stream),
+        itsCompressor(compression_detail::makeOutputBuffer(stream, compression)),
+        itsBuffer(itsCompressor ? itsCompressor.get() : stream.rdbuf()),
         itsConvertEndianness( portable_binary_detail::is_little_endian() ^ options.is_little_endian() )
       {
         this->operator()( options.is_little_endian() );
       }
 
-      ~PortableBinaryOutputArchive() CEREAL_NOEXCEPT = default;
+      ~PortableBinaryOutputArchive() CEREAL_NOEXCEPT
+      {
+        compression_detail::finish( itsCompressor.get(), itsStream );
+      }
 
       //! Writes size bytes of data to the output stream
       template <std::streamsize DataSize> inline
       void saveBinary( const void * data, std::streamsize size )
       {
+        CEREAL_PROFILE_BYTES( size );
         std::streamsize writtenSize = 0;
 
         if( itsConvertEndianness )
         {
-          for( std::streamsize i = 0; i < size; i += DataSize )
-            for( std::streamsize j = 0; j < DataSize; ++j )
-              writtenSize += itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ) + DataSize - j - 1 + i, 1 );
+          // the data is const, so swap one chunk at a time in a local copy
+          static const std::streamsize chunkSize = portable_binary_detail::swap_chunk_size<DataSize>::value;
+          std::uint8_t chunk[chunkSize];
+
+          for( std::streamsize i = 0; i < size; i += chunkSize )
+          {
+            auto const currentSize = size - i < chunkSize ? size - i : chunkSize;
+            std::memcpy( chunk, reinterpret_cast<const std::uint8_t*>( data ) + i, static_cast<std::size_t>( currentSize ) );
+            portable_binary_detail::swap_bytes_block<DataSize>( chunk, static_cast<std::size_t>( currentSize ) );
+            writtenSize += itsBuffer->sputn( reinterpret_cast<const char*>( chunk ), currentSize );
+          }
         }
         else
-          writtenSize = itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ), size );
+          writtenSize = itsBuffer->sputn( reinterpret_cast<const char*>( data ), size );
 
         if(writtenSize != size)
           throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
       }
 
+      //! Writes size bytes of elements made up of fields of varying size to the output stream
+      /*! @param fields The size of each field of one element, in order
+          @tparam ElementSize The size of one element */
+      template <std::size_t ElementSize> inline
+      void saveFields( const void * data, std::streamsize size, std::vector<std::size_t> const & fields )
+      {
+        if( !itsConvertEndianness )
+          return saveBinary<1>( data, size );
+
+        // the data is const, so swap whole elements one chunk at a time in a local copy
+        static const std::streamsize chunkSize = portable_binary_detail::swap_chunk_size<ElementSize>::value;
+        std::uint8_t chunk[chunkSize];
+
+        for( std::streamsize i = 0; i < size; i += chunkSize )
+        {
+          auto const currentSize = size - i < chunkSize ? size - i : chunkSize;
+          std::memcpy( chunk, reinterpret_cast<const std::uint8_t*>( data ) + i, static_cast<std::size_t>( currentSize ) );
+          portable_binary_detail::swap_fields( chunk, static_cast<std::size_t>( currentSize ), fields );
+
+          auto const writtenSize = itsBuffer->sputn( reinterpret_cast<const char*>( chunk ), currentSize );
+          if(writtenSize != currentSize)
+            throw Exception("Failed to write " + std::to_string(currentSize) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+        }
+      }
+
     private:
       std::ostream & itsStream;
+      std::unique_ptr<compression_detail::OutputBuffer> itsCompressor; //!< Compresses the output, if compressing
+      std::streambuf * itsBuffer; //!< Where the output is written: the stream's buffer, or itsCompressor
       const uint8_t itsConvertEndianness; //!< If set to true, we will need to swap bytes upon saving
   };
 
@@ -221,7 +516,23 @@ namespace cereal
                          for the values of default parameters */
       PortableBinaryInputArchive(std::istream & stream, Options const & options = Options::Default()) :
         InputArchive<PortableBinaryInputArchive, AllowEmptyClassElision>(this),
-        itsStream(stream),
+        itsBuffer(stream.rdbuf()),
+        itsConvertEndianness( false )
+      {
+        uint8_t streamLittleEndian;
+        this->operator()( streamLittleEndian );
+        itsConvertEndianness = options.is_little_endian() ^ streamLittleEndian;
+      }
+
+      //! Construct, loading compressed data from the provided stream
+      /*! @param stream The stream to read from. Should be opened with std::ios::binary flag.
+          @param options The PortableBinary specific options to use
+          @param compression How the data was compressed.  Its codec must be the one the data
+                             was saved with; the block size and threads need not match. */
+      PortableBinaryInputArchive(std::istream & stream, Options const & options, Compression const & compression) :
+        InputArchive<PortableBinaryInputArchive, AllowEmptyClassElision>(this),
+        itsDecompressor(compression_detail::makeInputBuffer(stream, compression)),
+        itsBuffer(itsDecompressor ? itsDecompressor.get() : stream.rdbuf()),
         itsConvertEndianness( false )
       {
         uint8_t streamLittleEndian;
@@ -238,23 +549,33 @@ namespace cereal
       template <std::streamsize DataSize> inline
       void loadBinary( void * const data, std::streamsize size )
       {
+        CEREAL_PROFILE_BYTES( size );
         // load data
-        auto const readSize = itsStream.rdbuf()->sgetn( reinterpret_cast<char*>( data ), size );
+        auto const readSize = itsBuffer->sgetn( reinterpret_cast<char*>( data ), size );
 
         if(readSize != size)
           throw Exception("Failed to read " + std::to_string(size) + " bytes from input stream! Read " + std::to_string(readSize));
 
         // flip bits if needed
         if( itsConvertEndianness )
-        {
-          std::uint8_t * ptr = reinterpret_cast<std::uint8_t*>( data );
-          for( std::streamsize i = 0; i < size; i += DataSize )
-            portable_binary_detail::swap_bytes<DataSize>( ptr + i );
-        }
+          portable_binary_detail::swap_bytes_block<DataSize>( reinterpret_cast<std::uint8_t*>( data ), static_cast<std::size_t>( size ) );
+      }
+
+      //! Reads size bytes of elements made up of fields of varying size from the input stream
+      /*! @param data The data to load into
+          @param size The number of bytes in the data
+          @param fields The size of each field of one element, in order */
+      void loadFields( void * const data, std::streamsize size, std::vector<std::size_t> const & fields )
+      {
+        loadBinary<1>( data, size );
+
+        if( itsConvertEndianness )
+          portable_binary_detail::swap_fields( reinterpret_cast<std::uint8_t*>( data ), static_cast<std::size_t>( size ), fields );
       }
 
     private:
-      std::istream & itsStream;
+      std::unique_ptr<compression_detail::InputBuffer> itsDecompressor; //!< Decompresses the input, if compressed
+      std::streambuf * itsBuffer; //!< Where the input is read from: the stream's buffer, or itsDecompressor
       uint8_t itsConvertEndianness; //!< If set to true, we will need to swap bytes upon loading
   };
 
@@ -301,9 +622,10 @@ namespace cereal
 
   //! Saving binary data to portable binary
   template <class T> inline
-  void CEREAL_SAVE_FUNCTION_NAME(PortableBinaryOutputArchive & ar, BinaryData<T> const & bd)
+  typename std::enable_if<!std::is_class<detail::binary_data_element<T>>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(PortableBinaryOutputArchive & ar, BinaryData<T> const & bd)
   {
-    typedef typename std::remove_pointer<T>::type TT;
+    typedef detail::binary_data_element<T> TT;
     static_assert( !std::is_floating_point<TT>::value ||
                    (std::is_floating_point<TT>::value && std::numeric_limits<TT>::is_iec559),
                    "Portable binary only supports IEEE 754 standardized floating point" );
@@ -313,15 +635,38 @@ namespace cereal
 
   //! Loading binary data from portable binary
   template <class T> inline
-  void CEREAL_LOAD_FUNCTION_NAME(PortableBinaryInputArchive & ar, BinaryData<T> & bd)
+  typename std::enable_if<!std::is_class<detail::binary_data_element<T>>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(PortableBinaryInputArchive & ar, BinaryData<T> & bd)
   {
-    typedef typename std::remove_pointer<T>::type TT;
+    typedef detail::binary_data_element<T> TT;
     static_assert( !std::is_floating_point<TT>::value ||
                    (std::is_floating_point<TT>::value && std::numeric_limits<TT>::is_iec559),
                    "Portable binary only supports IEEE 754 standardized floating point" );
 
     ar.template loadBinary<sizeof(TT)>( bd.data, static_cast<std::streamsize>( bd.size ) );
   }
+
+  //! Saving binary data of memcpy serializable types to portable binary
+  /*! The bytes of each arithmetic member of the elements are swapped individually */
+  template <class T> inline
+  typename std::enable_if<std::is_class<detail::binary_data_element<T>>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(PortableBinaryOutputArchive & ar, BinaryData<T> const & bd)
+  {
+    typedef detail::binary_data_element<T> TT;
+
+    ar.template saveFields<sizeof(TT)>( bd.data, static_cast<std::streamsize>( bd.size ),
+                                        common_detail::memcpyLayout<TT>().fields );
+  }
+
+  //! Loading binary data of memcpy serializable types from portable binary
+  template <class T> inline
+  typename std::enable_if<std::is_class<detail::binary_data_element<T>>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(PortableBinaryInputArchive & ar, BinaryData<T> & bd)
+  {
+    typedef detail::binary_data_element<T> TT;
+
+    ar.loadFields( bd.data, static_cast<std::streamsize>( bd.size ), common_detail::memcpyLayout<TT>().fields );
+  }
 } // namespace cereal
 
 // register archives for polymorphic support
@@ -0,0 +1,833 @@
+/*! \file random_access.hpp
+    \brief Binary archives with an index for loading parts of their data on demand */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_RANDOM_ACCESS_HPP_
+#define CEREAL_ARCHIVES_RANDOM_ACCESS_HPP_
+
+#include "cereal/cereal.hpp"
+#include <cstring>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cereal
+{
+  namespace random_access_detail
+  {
+    //! Identifies the index at the end of a random access archive
+    static const char Magic[8] = { 'c', 'e', 'r', 'e', 'a', 'l', 'R', 'A' };
+
+    //! Flags stored for each field in the index
+    static const std::uint64_t IsContainer = 1; //!< The field holds a container whose elements are indexed
+    static const std::uint64_t IsSorted = 2;    //!< The elements are saved in key order, as by std::map
+
+    template <class> struct Void { typedef void type; };
+
+    //! Whether a type keeps its elements in key order
+    template <class T, class = void>
+    struct is_sorted_container : std::false_type {};
+
+    template <class T>
+    struct is_sorted_container<T, typename Void<typename T::key_compare>::type> : std::true_type {};
+  } // namespace random_access_detail
+
+  // ######################################################################
+  //! An output archive that saves data in a binary representation along with an index for random access
+  /*! This archive saves data as the BinaryOutputArchive does, then, when it is destroyed, appends an
+      index of the top level fields and of the elements of the containers they hold.  A
+      RandomAccessInputArchive can then load any field, any element of such a container, a range of
+      elements or the value for a key in a map, without loading anything before it.
+
+      Every value saved directly to the archive is a field.  Fields are named by NVPs, or otherwise
+      named "value0", "value1", and so on.  When a field is a container (or anything else that saves
+      a size tag before its elements) the position of each element is indexed.  Contiguous arithmetic
+      elements, such as those of a std::vector<int> or a std::string, are located from the position
+      of the first one and need no index.
+
+      @code{.cpp}
+      {
+        std::ofstream os( "snapshot.bin", std::ios::binary );
+        cereal::RandomAccessOutputArchive ar( os );
+        ar( cereal::make_nvp( "records", records ), cereal::make_nvp( "users", usersById ) );
+      }
+
+      std::ifstream is( "snapshot.bin", std::ios::binary );
+      cereal::RandomAccessInputArchive ar( is );
+      Record record;
+      ar.loadElement( "records", 5000000, record );
+      @endcode
+
+      So that each field and element can be loaded on its own, the archive forgets the class versions,
+      shared pointers and polymorphic types it has saved at the start of each of them.  An object
+      shared by several fields or elements is saved once for each of them and loaded as separate
+      objects.
+
+      This archive does nothing to ensure that the endianness of the saved and loaded data is the
+      same.  When using a file stream, you must use the std::ios::binary format flag.
+
+      \ingroup Archives */
+  class RandomAccessOutputArchive : public OutputArchive<RandomAccessOutputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! Construct, outputting to the provided stream
+      /*! @param stream The stream to output to.  It does not need to be seekable. */
+      RandomAccessOutputArchive(std::ostream & stream) :
+        OutputArchive<RandomAccessOutputArchive, AllowEmptyClassElision>(this),
+        itsStream(stream),
+        itsPosition(0),
+        itsDepth(0),
+        itsContainer(false),
+        itsBlock(false),
+        itsNextName(nullptr),
+        itsUnnamed(0)
+      { }
+
+      //! Destructor, writes the index, setting badbit on the stream if it could not be written
+      ~RandomAccessOutputArchive() CEREAL_NOEXCEPT
+      {
+        try
+        {
+          writeIndex();
+        }
+        catch( ... )
+        {
+          itsStream.setstate( std::ios::badbit );
+        }
+      }
+
+      //! Writes size bytes of data to the output stream
+      void saveBinary( const void * data, std::streamsize size )
+      {
+        CEREAL_PROFILE_BYTES( size );
+        auto const writtenSize = itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ), size );
+
+        if(writtenSize != size)
+          throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+
+        itsPosition += static_cast<std::uint64_t>( size );
+      }
+
+      /*! @name Internal Functionality
+          Functionality designed for use by those requiring control over the inner mechanisms of
+          the RandomAccessOutputArchive */
+      //! @{
+
+      //! Sets the name of the next field
+      void setNextName( const char * name )
+      {
+        if( itsDepth == 0 )
+          itsNextName = name;
+      }
+
+      //! Starts saving a value of type T, which may be a field or an element of one
+      template <class T> inline
+      void startItem()
+      {
+        if( itsDepth == 0 )
+        {
+          resetTracking();
+
+          itsFields.emplace_back();
+          auto & field = itsFields.back();
+          field.name = itsNextName ? std::string( itsNextName ) : "value" + std::to_string( itsUnnamed++ );
+          field.offset = itsPosition;
+          field.flags = random_access_detail::is_sorted_container<T>::value ? random_access_detail::IsSorted : 0;
+          itsNextName = nullptr;
+        }
+        else if( itsDepth == 1 && itsContainer && itsFields.back().stride == 0 )
+        {
+          resetTracking();
+          itsFields.back().offsets.push_back( itsPosition );
+        }
+
+        ++itsDepth;
+      }
+
+      //! Finishes saving the value started with startItem
+      void finishItem()
+      {
+        if( --itsDepth == 0 )
+          itsContainer = itsBlock = false;
+      }
+
+      //! Called after saving a size tag, which starts a container if it belongs to a field
+      void startContainer( std::uint64_t size )
+      {
+        if( itsDepth != 1 || itsContainer )
+          return;
+
+        itsContainer = true;
+        auto & field = itsFields.back();
+        field.flags |= random_access_detail::IsContainer;
+        field.count = size;
+        field.base = itsPosition;
+      }
+
+      //! Starts saving a block of binary data, which holds all elements of a container if it follows its size tag
+      void startBlock( std::size_t elementSize )
+      {
+        if( itsDepth == 1 && itsContainer && itsFields.back().offsets.empty() )
+        {
+          itsFields.back().stride = elementSize;
+          itsBlock = true;
+        }
+        else
+          startItem<void>();
+
+        ++itsDepth;
+      }
+
+      //! Finishes saving the block started with startBlock
+      void finishBlock()
+      {
+        if( --itsDepth != 1 || !itsBlock )
+          finishItem();
+      }
+
+      //! @}
+
+    private:
+      //! A top level value and the positions of its elements
+      struct Field
+      {
+        Field() : offset( 0 ), flags( 0 ), count( 0 ), stride( 0 ), base( 0 ) {}
+
+        std::string name;
+        std::uint64_t offset;                //!< The position of the field
+        std::uint64_t flags;                 //!< random_access_detail::IsContainer and IsSorted
+        std::uint64_t count;                 //!< The number of elements, if it is a container
+        std::uint64_t stride;                //!< The size of each element, if they are contiguous arithmetic values
+        std::uint64_t base;                  //!< The position of the first element, then of the element positions
+        std::vector<std::uint64_t> offsets;  //!< The position of each element, if they are not contiguous arithmetic values
+      };
+
+      void write( const void * data, std::size_t size )
+      {
+        auto const writtenSize = itsStream.rdbuf()->sputn( reinterpret_cast<const char *>( data ), static_cast<std::streamsize>( size ) );
+
+        if( writtenSize != static_cast<std::streamsize>( size ) )
+          throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+
+        itsPosition += size;
+      }
+
+      void write( std::uint64_t value )
+      {
+        write( &value, sizeof(value) );
+      }
+
+      //! Writes the element positions, the field directory and the footer locating them
+      void writeIndex()
+      {
+        for( auto & field : itsFields )
+          if( field.stride == 0 && ( field.flags & random_access_detail::IsContainer ) )
+          {
+            field.count = field.offsets.size();
+            field.base = itsPosition;
+            write( field.offsets.data(), field.offsets.size() * sizeof(std::uint64_t) );
+          }
+
+        auto const directory = itsPosition;
+        for( auto const & field : itsFields )
+        {
+          write( field.name.size() );
+          write( field.name.data(), field.name.size() );
+          write( field.offset );
+          write( field.flags );
+          write( field.count );
+          write( field.stride );
+          write( field.base );
+        }
+
+        write( directory );
+        write( itsFields.size() );
+        write( random_access_detail::Magic, sizeof(random_access_detail::Magic) );
+      }
+
+      std::ostream & itsStream;
+      std::uint64_t itsPosition;    //!< The number of bytes written
+      std::size_t itsDepth;         //!< The nesting depth of the value being saved
+      bool itsContainer;            //!< Whether the current field has started a container
+      bool itsBlock;                //!< Whether the elements of the current container are a block of binary data
+      const char * itsNextName;     //!< The name of the next field
+      std::size_t itsUnnamed;       //!< The number of fields without an NVP
+      std::vector<Field> itsFields;
+  };
+
+  // ######################################################################
+  //! An input archive designed to load data saved using RandomAccessOutputArchive
+  /*! Data can be loaded sequentially, as with any other archive, and parts of it can be loaded on
+      demand by name with loadField, loadElement, loadElements and loadMapValue.  Only the directory
+      of fields is read when the archive is constructed; the position of an element is read when it
+      is needed.  Loading on demand does not change the position of sequential loading.
+
+      The archive can read from a seekable stream, such as a std::ifstream, or from memory, such as
+      a memory mapped file, which must stay valid for the lifetime of the archive.
+
+      This archive does nothing to ensure that the endianness of the saved and loaded data is the
+      same.  When using a file stream, you must use the std::ios::binary format flag.
+
+      \ingroup Archives */
+  class RandomAccessInputArchive : public InputArchive<RandomAccessInputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! Construct, loading from the provided stream
+      /*! @param stream The stream to load from, positioned at the start of the archive.  It must be
+                        seekable and the archive must extend to its end. */
+      RandomAccessInputArchive(std::istream & stream) :
+        InputArchive<RandomAccessInputArchive, AllowEmptyClassElision>(this),
+        itsStream(&stream),
+        itsData(nullptr),
+        itsSize(0),
+        itsStreamPosition(0),
+        itsPosition(0),
+        itsDepth(0),
+        itsContainer(false),
+        itsBlock(false)
+      {
+        itsStart = stream.tellg();
+        if( itsStart == std::istream::pos_type( -1 ) || !stream.seekg( 0, std::ios::end ) )
+          throw Exception("RandomAccessInputArchive requires a seekable stream");
+        itsSize = static_cast<std::uint64_t>( stream.tellg() - itsStart );
+        itsStreamPosition = itsSize;
+
+        readIndex();
+      }
+
+      //! Construct, loading from memory
+      /*! @param data Pointer to the first byte of the archive
+          @param size The size of the archive in bytes */
+      RandomAccessInputArchive(const void * data, std::size_t size) :
+        InputArchive<RandomAccessInputArchive, AllowEmptyClassElision>(this),
+        itsStream(nullptr),
+        itsData(reinterpret_cast<const char *>(data)),
+        itsSize(size),
+        itsStreamPosition(0),
+        itsPosition(0),
+        itsDepth(0),
+        itsContainer(false),
+        itsBlock(false)
+      {
+        readIndex();
+      }
+
+      ~RandomAccessInputArchive() CEREAL_NOEXCEPT = default;
+
+      //! Reads size bytes of data from the current position
+      void loadBinary( void * const data, std::streamsize size )
+      {
+        CEREAL_PROFILE_BYTES( size );
+        auto const bytes = static_cast<std::uint64_t>( size );
+        if( itsPosition > itsSize || bytes > itsSize - itsPosition )
+          throw Exception("Failed to read " + std::to_string(size) + " bytes from random access archive at position " + std::to_string(itsPosition) + " of " + std::to_string(itsSize));
+
+        if( itsStream )
+        {
+          // seeking discards the stream's buffer, so only do it when the position has moved
+          if( itsPosition != itsStreamPosition && !itsStream->seekg( itsStart + static_cast<std::streamoff>( itsPosition ) ) )
+            throw Exception("Failed to seek in input stream!");
+
+          itsStreamPosition = itsSize;
+          if( itsStream->rdbuf()->sgetn( reinterpret_cast<char*>( data ), size ) != size )
+            throw Exception("Failed to read " + std::to_string(size) + " bytes from input stream!");
+          itsStreamPosition = itsPosition + bytes;
+        }
+        else if( size != 0 )
+          std::memcpy( data, itsData + itsPosition, static_cast<std::size_t>( size ) );
+
+        itsPosition += bytes;
+      }
+
+      /*! @name Random Access
+          Loading parts of the data on demand */
+      //! @{
+
+      //! Whether there is a field with the given name
+      bool hasField( const char * name ) const
+      {
+        return itsFields.find( name ) != itsFields.end();
+      }
+
+      //! Returns the number of elements in a field holding a container
+      /*! @throws Exception if there is no such field or it does not hold a container */
+      std::size_t fieldSize( const char * name ) const
+      {
+        return static_cast<std::size_t>( container( name ).count );
+      }
+
+      //! Loads a field
+      /*! @throws Exception if there is no such field */
+      template <class T> inline
+      void loadField( const char * name, T & value )
+      {
+        Detour detour( *this, field( name ).offset, 0 );
+        (*this)( value );
+      }
+
+      //! Loads an element of a field holding a container
+      /*! @throws Exception if there is no such field, or it does not hold a container with the element */
+      template <class T> inline
+      void loadElement( const char * name, std::size_t index, T & element )
+      {
+        auto const & f = container( name );
+        if( index >= f.count )
+          throw Exception("Element " + std::to_string( index ) + " of " + std::string( name ) + " is out of range");
+        if( f.stride != 0 && f.stride != sizeof(T) )
+          throw Exception("The elements of " + std::string( name ) + " do not have the requested type");
+
+        Detour detour( *this, elementOffset( f, index ), 1 );
+        (*this)( element );
+      }
+
+      //! Loads count elements of a field holding a container, starting with the element at first
+      /*! @throws Exception if there is no such field, or it does not hold a container with the elements */
+      template <class T, class A> inline
+      void loadElements( const char * name, std::size_t first, std::size_t count, std::vector<T, A> & elements )
+      {
+        auto const & f = container( name );
+        if( first > f.count || count > f.count - first )
+          throw Exception("Elements " + std::to_string( first ) + " to " + std::to_string( first + count ) + " of " + std::string( name ) + " are out of range");
+        if( f.stride != 0 && f.stride != sizeof(T) )
+          throw Exception("The elements of " + std::string( name ) + " do not have the requested type");
+
+        elements.resize( count );
+        if( count == 0 )
+          return;
+
+        // elements are saved one after the other
+        Detour detour( *this, elementOffset( f, first ), 1 );
+        if( f.stride != 0 )
+          loadBinary( elements.data(), static_cast<std::streamsize>( count * sizeof(T) ) );
+        else
+          for( auto & element : elements )
+            (*this)( element );
+      }
+
+      //! Loads the value for a key from a field holding a map
+      /*! When the map was saved in key order, as std::map is, the key is found with a binary search
+          using compare, which must order keys as the map did.  Otherwise the keys are compared one
+          by one.  Only the keys compared and the value found are loaded.
+
+          @return Whether the key was found
+          @throws Exception if there is no such field or it does not hold a container */
+      template <class K, class V, class Compare = std::less<K>> inline
+      bool loadMapValue( const char * name, K const & key, V & value, Compare const & compare = Compare() )
+      {
+        auto const & f = container( name );
+        K candidate;
+
+        std::size_t index = 0;
+        if( f.flags & random_access_detail::IsSorted )
+        {
+          auto last = static_cast<std::size_t>( f.count );
+          while( index < last )
+          {
+            auto const middle = index + ( last - index ) / 2;
+            loadKey( f, middle, candidate );
+            if( compare( candidate, key ) )
+              index = middle + 1;
+            else
+              last = middle;
+          }
+
+          if( index == f.count || ( loadKey( f, index, candidate ), compare( key, candidate ) ) )
+            return false;
+        }
+        else
+        {
+          for( ; index < f.count; ++index )
+          {
+            loadKey( f, index, candidate );
+            if( !compare( candidate, key ) && !compare( key, candidate ) )
+              break;
+          }
+
+          if( index == f.count )
+            return false;
+        }
+
+        Detour detour( *this, elementOffset( f, index ), 2 );
+        resetTracking();
+        (*this)( candidate, value );
+        return true;
+      }
+
+      //! @}
+      /*! @name Internal Functionality
+          Functionality designed for use by those requiring control over the inner mechanisms of
+          the RandomAccessInputArchive */
+      //! @{
+
+      //! Starts loading a value, resetting at the points the RandomAccessOutputArchive did
+      void startItem()
+      {
+        if( itsDepth == 0 || ( itsDepth == 1 && itsContainer && !itsBlock ) )
+          resetTracking();
+
+        ++itsDepth;
+      }
+
+      //! Finishes loading the value started with startItem
+      void finishItem()
+      {
+        if( --itsDepth == 0 )
+          itsContainer = itsBlock = false;
+      }
+
+      //! Called after loading a size tag, which starts a container if it belongs to a field
+      void startContainer()
+      {
+        if( itsDepth == 1 )
+          itsContainer = true;
+      }
+
+      //! Starts loading a block of binary data, which holds all elements of a container if it follows its size tag
+      void startBlock()
+      {
+        if( itsDepth == 1 && itsContainer )
+          itsBlock = true;
+        else
+          startItem();
+
+        ++itsDepth;
+      }
+
+      //! Finishes loading the block started with startBlock
+      void finishBlock()
+      {
+        if( --itsDepth != 1 || !itsBlock )
+          finishItem();
+      }
+
+      //! @}
+
+    private:
+      //! A top level value and where to find its elements
+      struct Field
+      {
+        std::uint64_t offset;
+        std::uint64_t flags;
+        std::uint64_t count;
+        std::uint64_t stride;
+        std::uint64_t base;
+      };
+
+      //! Moves to a position for loading on demand, restoring the position of sequential loading when destroyed
+      class Detour
+      {
+        public:
+          Detour( RandomAccessInputArchive & ar, std::uint64_t position, std::size_t depth ) :
+            itsArchive( ar ), itsPosition( ar.itsPosition ), itsDepth( ar.itsDepth ), itsContainer( ar.itsContainer ), itsBlock( ar.itsBlock )
+          {
+            ar.itsPosition = position;
+            ar.itsDepth = depth;
+            ar.itsContainer = depth > 0;
+            ar.itsBlock = false;
+          }
+
+          ~Detour()
+          {
+            itsArchive.itsPosition = itsPosition;
+            itsArchive.itsDepth = itsDepth;
+            itsArchive.itsContainer = itsContainer;
+            itsArchive.itsBlock = itsBlock;
+          }
+
+        private:
+          RandomAccessInputArchive & itsArchive;
+          std::uint64_t itsPosition;
+          std::size_t itsDepth;
+          bool itsContainer, itsBlock;
+      };
+
+      std::uint64_t readUint64( std::uint64_t position )
+      {
+        std::uint64_t value;
+        auto const previous = itsPosition;
+        itsPosition = position;
+        loadBinary( &value, sizeof(value) );
+        itsPosition = previous;
+        return value;
+      }
+
+      //! Reads the footer and the field directory
+      void readIndex()
+      {
+        std::uint64_t const footerSize = 2 * sizeof(std::uint64_t) + sizeof(random_access_detail::Magic);
+        if( itsSize < footerSize )
+          throw Exception("Input is too small to be a random access archive");
+
+        char magic[sizeof(random_access_detail::Magic)];
+        auto const footer = itsSize - footerSize;
+        itsPosition = footer + 2 * sizeof(std::uint64_t);
+        loadBinary( magic, sizeof(magic) );
+        if( std::memcmp( magic, random_access_detail::Magic, sizeof(magic) ) != 0 )
+          throw Exception("Input is not a random access archive");
+
+        // each field takes at least its name size and five more values
+        itsPosition = readUint64( footer );
+        auto const fields = readUint64( footer + sizeof(std::uint64_t) );
+        if( itsPosition > footer || fields > ( footer - itsPosition ) / ( 6 * sizeof(std::uint64_t) ) )
+          throw Exception("Invalid random access archive index");
+
+        for( std::uint64_t i = 0; i < fields; ++i )
+        {
+          std::uint64_t nameSize;
+          loadBinary( &nameSize, sizeof(nameSize) );
+          if( nameSize > footer - itsPosition )
+            throw Exception("Invalid random access archive index");
+
+          std::string name( static_cast<std::size_t>( nameSize ), '\0' );
+          loadBinary( &name[0], static_cast<std::streamsize>( nameSize ) );
+
+          Field field;
+          loadBinary( &field.offset, sizeof(field.offset) );
+          loadBinary( &field.flags, sizeof(field.flags) );
+          loadBinary( &field.count, sizeof(field.count) );
+          loadBinary( &field.stride, sizeof(field.stride) );
+          loadBinary( &field.base, sizeof(field.base) );
+          itsFields.emplace( std::move( name ), field );
+        }
+
+        itsPosition = 0;
+      }
+
+      Field const & field( const char * name ) const
+      {
+        auto const f = itsFields.find( name );
+        if( f == itsFields.end() )
+          throw Exception("Random access archive has no field named " + std::string( name ));
+        return f->second;
+      }
+
+      Field const & container( const char * name ) const
+      {
+        auto const & f = field( name );
+        if( !( f.flags & random_access_detail::IsContainer ) )
+          throw Exception("Random access archive field " + std::string( name ) + " does not hold a container");
+        return f;
+      }
+
+      std::uint64_t elementOffset( Field const & f, std::size_t index )
+      {
+        if( f.stride != 0 )
+          return f.base + index * f.stride;
+        return readUint64( f.base + index * sizeof(std::uint64_t) );
+      }
+
+      //! Loads the key of an element of a map, which is saved before its value
+      template <class K> inline
+      void loadKey( Field const & f, std::size_t index, K & key )
+      {
+        Detour detour( *this, elementOffset( f, index ), 2 );
+        resetTracking();
+        (*this)( key );
+      }
+
+      std::istream * itsStream;        //!< The stream being read, if not reading from memory
+      std::istream::pos_type itsStart; //!< The position of the archive in itsStream
+      const char * itsData;            //!< The memory being read, if not reading from a stream
+      std::uint64_t itsSize;           //!< The size of the archive in bytes
+      std::uint64_t itsStreamPosition; //!< The position of itsStream within the archive
+      std::uint64_t itsPosition;       //!< The position of the next byte to read
+      std::size_t itsDepth;            //!< The nesting depth of the value being loaded
+      bool itsContainer;               //!< Whether the current field has started a container
+      bool itsBlock;                   //!< Whether the elements of the current container are a block of binary data
+      std::unordered_map<std::string, Field> itsFields;
+  };
+
+  // ######################################################################
+  // RandomAccessArchive prologue and epilogue functions
+  // ######################################################################
+
+  //! Prologue for NVPs for random access archives
+  /*! NVPs name the fields they hold */
+  template <class T> inline
+  void prologue( RandomAccessOutputArchive & ar, NameValuePair<T> const & t )
+  {
+    ar.setNextName( t.name );
+  }
+
+  //! Prologue for NVPs for random access archives
+  template <class T> inline
+  void prologue( RandomAccessInputArchive &, NameValuePair<T> const & )
+  { }
+
+  //! Epilogue for NVPs for random access archives
+  template <class T> inline
+  void epilogue( RandomAccessOutputArchive &, NameValuePair<T> const & )
+  { }
+
+  //! Epilogue for NVPs for random access archives
+  template <class T> inline
+  void epilogue( RandomAccessInputArchive &, NameValuePair<T> const & )
+  { }
+
+  //! Prologue for SizeTags for random access archives
+  template <class T> inline
+  void prologue( RandomAccessOutputArchive &, SizeTag<T> const & )
+  { }
+
+  //! Prologue for SizeTags for random access archives
+  template <class T> inline
+  void prologue( RandomAccessInputArchive &, SizeTag<T> const & )
+  { }
+
+  //! Epilogue for SizeTags for random access archives
+  /*! A size tag saved directly in a field starts a container whose elements are indexed */
+  template <class T> inline
+  void epilogue( RandomAccessOutputArchive & ar, SizeTag<T> const & t )
+  {
+    ar.startContainer( static_cast<std::uint64_t>( t.size ) );
+  }
+
+  //! Epilogue for SizeTags for random access archives
+  template <class T> inline
+  void epilogue( RandomAccessInputArchive & ar, SizeTag<T> const & )
+  {
+    ar.startContainer();
+  }
+
+  //! Prologue for binary data for random access archives
+  template <class T> inline
+  void prologue( RandomAccessOutputArchive & ar, BinaryData<T> const & )
+  {
+    ar.startBlock( sizeof( typename std::remove_pointer<typename std::remove_reference<T>::type>::type ) );
+  }
+
+  //! Prologue for binary data for random access archives
+  template <class T> inline
+  void prologue( RandomAccessInputArchive & ar, BinaryData<T> const & )
+  {
+    ar.startBlock();
+  }
+
+  //! Epilogue for binary data for random access archives
+  template <class T> inline
+  void epilogue( RandomAccessOutputArchive & ar, BinaryData<T> const & )
+  {
+    ar.finishBlock();
+  }
+
+  //! Epilogue for binary data for random access archives
+  template <class T> inline
+  void epilogue( RandomAccessInputArchive & ar, BinaryData<T> const & )
+  {
+    ar.finishBlock();
+  }
+
+  //! Prologue for all other types for random access archives
+  /*! Tracks the fields and the elements of the containers they hold */
+  template <class T> inline
+  void prologue( RandomAccessOutputArchive & ar, T const & )
+  {
+    ar.startItem<T>();
+  }
+
+  //! Prologue for all other types for random access archives
+  template <class T> inline
+  void prologue( RandomAccessInputArchive & ar, T const & )
+  {
+    ar.startItem();
+  }
+
+  //! Epilogue for all other types for random access archives
+  template <class T> inline
+  void epilogue( RandomAccessOutputArchive & ar, T const & )
+  {
+    ar.finishItem();
+  }
+
+  //! Epilogue for all other types for random access archives
+  template <class T> inline
+  void epilogue( RandomAccessInputArchive & ar, T const & )
+  {
+    ar.finishItem();
+  }
+
+  // ######################################################################
+  // Common RandomAccessArchive serialization functions
+
+  //! Saving for POD types to a random access archive
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(RandomAccessOutputArchive & ar, T const & t)
+  {
+    ar.saveBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Loading for POD types from a random access archive
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(RandomAccessInputArchive & ar, T & t)
+  {
+    ar.loadBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Serializing NVP types to a random access archive
+  template <class Archive, class T> inline
+  CEREAL_ARCHIVE_RESTRICT(RandomAccessInputArchive, RandomAccessOutputArchive)
+  CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar, NameValuePair<T> & t )
+  {
+    ar( t.value );
+  }
+
+  //! Serializing SizeTags to a random access archive
+  template <class Archive, class T> inline
+  CEREAL_ARCHIVE_RESTRICT(RandomAccessInputArchive, RandomAccessOutputArchive)
+  CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar, SizeTag<T> & t )
+  {
+    ar( t.size );
+  }
+
+  //! Saving binary data to a random access archive
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME(RandomAccessOutputArchive & ar, BinaryData<T> const & bd)
+  {
+    ar.saveBinary( bd.data, static_cast<std::streamsize>( bd.size ) );
+  }
+
+  //! Loading binary data from a random access archive
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME(RandomAccessInputArchive & ar, BinaryData<T> & bd)
+  {
+    ar.loadBinary( bd.data, static_cast<std::streamsize>( bd.size ) );
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::RandomAccessOutputArchive)
+CEREAL_REGISTER_ARCHIVE(cereal::RandomAccessInputArchive)
+
+// tie input and output archives together
+CEREAL_SETUP_ARCHIVE_TRAITS(cereal::RandomAccessInputArchive, cereal::RandomAccessOutputArchive)
+
+#endif // CEREAL_ARCHIVES_RANDOM_ACCESS_HPP_
@@ -149,6 +149,7 @@ namespace cereal
 
         private:
           friend class XMLOutputArchive;
+          friend class XMLStreamOutputArchive;
           int itsPrecision;
           bool itsIndent;
           bool itsOutputType;
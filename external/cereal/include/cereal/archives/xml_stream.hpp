@@ -0,0 +1,1557 @@
+/*! \file xml_stream.hpp
+    \brief Streaming XML input and output archives */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_XML_STREAM_HPP_
+#define CEREAL_ARCHIVES_XML_STREAM_HPP_
+#include "cereal/archives/xml.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace cereal
+{
+  namespace xml_stream_detail
+  {
+    //! A stream buffer that appends to a string, so that values can be formatted without allocating
+    class StringBuffer : public std::streambuf
+    {
+      public:
+        std::string & str() { return itsString; }
+
+      protected:
+        int_type overflow( int_type c ) override
+        {
+          if( !traits_type::eq_int_type( c, traits_type::eof() ) )
+            itsString.push_back( traits_type::to_char_type( c ) );
+          return traits_type::not_eof( c );
+        }
+
+        std::streamsize xsputn( const char * s, std::streamsize n ) override
+        {
+          itsString.append( s, static_cast<size_t>( n ) );
+          return n;
+        }
+
+      private:
+        std::string itsString;
+    };
+
+    //! Appends characters, replacing those that are special in XML with references as rapidxml prints them
+    /*! @param noexpand A character that is copied as is, or 0 to replace all of them */
+    inline void appendEscaped( std::string & out, const char * begin, const char * end, char noexpand )
+    {
+      for( ; begin != end; ++begin )
+      {
+        if( *begin == noexpand )
+        {
+          out += *begin;
+          continue;
+        }
+
+        switch( *begin )
+        {
+          case '<': out += "&lt;"; break;
+          case '>': out += "&gt;"; break;
+          case '\'': out += "&apos;"; break;
+          case '"': out += "&quot;"; break;
+          case '&': out += "&amp;"; break;
+          default: out += *begin; break;
+        }
+      }
+    }
+
+    //! Appends a unicode code point as UTF-8
+    inline void appendUtf8( std::string & out, unsigned long code )
+    {
+      if( code < 0x80 )
+        out += static_cast<char>( code );
+      else if( code < 0x800 )
+      {
+        out += static_cast<char>( 0xC0 | ( code >> 6 ) );
+        out += static_cast<char>( 0x80 | ( code & 0x3F ) );
+      }
+      else if( code < 0x10000 )
+      {
+        out += static_cast<char>( 0xE0 | ( code >> 12 ) );
+        out += static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+        out += static_cast<char>( 0x80 | ( code & 0x3F ) );
+      }
+      else if( code < 0x110000 )
+      {
+        out += static_cast<char>( 0xF0 | ( code >> 18 ) );
+        out += static_cast<char>( 0x80 | ( ( code >> 12 ) & 0x3F ) );
+        out += static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+        out += static_cast<char>( 0x80 | ( code & 0x3F ) );
+      }
+      else
+        throw Exception("XML Parsing failed - invalid numeric character entity");
+    }
+  } // namespace xml_stream_detail
+
+  // ######################################################################
+  //! An output archive that writes XML to its stream as data is saved
+  /*! The XMLOutputArchive builds the whole document in memory and prints it when it is
+      destroyed.  This archive writes each node as soon as it can tell how rapidxml would
+      print it, holding back at most the start tag and one value of the current node.
+      Its output is identical to that of an XMLOutputArchive given the same options, and
+      can be read by either XML input archive.
+
+      Output is buffered and written to the stream in blocks, and is only guaranteed to
+      be complete once the archive is destroyed.
+
+      Attributes, such as the one added by a SizeTag, must be added to a node before its
+      children or a second value.
+
+      \ingroup Archives */
+  class XMLStreamOutputArchive : public OutputArchive<XMLStreamOutputArchive>, public traits::TextArchive
+  {
+    public:
+      /*! @name Common Functionality
+          Common use cases for directly interacting with an XMLStreamOutputArchive */
+      //! @{
+
+      //! The options are the same as those of the XMLOutputArchive
+      using Options = XMLOutputArchive::Options;
+
+      //! Construct, writing the XML declaration and the start of the root node
+      /*! @param stream  The stream to output to
+          @param options The XML specific options to use.  See the XMLOutputArchive::Options
+                         struct for the values of default parameters */
+      XMLStreamOutputArchive( std::ostream & stream, Options const & options = Options::Default() ) :
+        OutputArchive<XMLStreamOutputArchive>(this),
+        itsStream(stream),
+        itsFormatStream(&itsFormatBuffer),
+        itsOutputType( options.itsOutputType ),
+        itsIndent( options.itsIndent ),
+        itsSizeAttributes(options.itsSizeAttributes)
+      {
+        itsFormatStream << std::boolalpha;
+        itsFormatStream.precision( options.itsPrecision );
+
+        itsBuffer += "<?xml version=\"1.0\" encoding=\"utf-8\"?>";
+        newline();
+
+        itsNodes.emplace_back( xml_detail::CEREAL_XML_STRING );
+        itsBuffer += '<';
+        itsBuffer += xml_detail::CEREAL_XML_STRING;
+      }
+
+      //! Destructor, finishes any open nodes and flushes the XML
+      ~XMLStreamOutputArchive() CEREAL_NOEXCEPT
+      {
+        while( !itsNodes.empty() )
+          finishNode();
+        newline();
+        flush();
+      }
+
+      //! Saves some binary data, encoded as a base64 string, with an optional name
+      /*! This can be called directly by users and it will automatically create a child node for
+          the current XML node, populate it with a base64 encoded string, and optionally name
+          it.  The node will be finished after it has been populated.  */
+      void saveBinaryValue( const void * data, size_t size, const char * name = nullptr )
+      {
+        itsNodes.back().name = name;
+
+        startNode();
+
+        auto base64string = base64::encode( reinterpret_cast<const unsigned char *>( data ), size );
+        saveValue( base64string );
+
+        if( itsOutputType )
+          appendAttribute( "type", "cereal binary data" );
+
+        finishNode();
+      }
+
+      //! @}
+      /*! @name Internal Functionality
+          Functionality designed for use by those requiring control over the inner mechanisms of
+          the XMLStreamOutputArchive */
+      //! @{
+
+      //! Creates a new node that is a child of the current node
+      /*! Nodes will be given a name that has either been pre-set by a name value pair,
+          or generated based upon a counter unique to the parent node.
+
+          The start tag is written, but not terminated until the contents of the node are known. */
+      void startNode()
+      {
+        auto name = itsNodes.back().getValueName();
+        startChildren();
+
+        indent( itsNodes.size() );
+        itsBuffer += '<';
+        itsBuffer += name;
+        itsNodes.emplace_back( std::move( name ) );
+      }
+
+      //! Finishes the current node, writing whatever it holds back
+      void finishNode()
+      {
+        auto const & node = itsNodes.back();
+        switch( node.state )
+        {
+          case NodeInfo::Open:
+            itsBuffer += "/>";
+            break;
+          case NodeInfo::Value:
+            itsBuffer += '>';
+            xml_stream_detail::appendEscaped( itsBuffer, itsValue.data(), itsValue.data() + itsValue.size(), 0 );
+            itsBuffer += "</";
+            itsBuffer += node.nodeName;
+            itsBuffer += '>';
+            break;
+          case NodeInfo::Children:
+            indent( itsNodes.size() - 1 );
+            itsBuffer += "</";
+            itsBuffer += node.nodeName;
+            itsBuffer += '>';
+            break;
+        }
+        newline();
+        itsNodes.pop_back();
+
+        if( itsBuffer.size() >= FlushSize )
+          flush();
+      }
+
+      //! Sets the name for the next node created with startNode
+      void setNextName( const char * name )
+      {
+        itsNodes.back().name = name;
+      }
+
+      //! Saves some data, encoded as a string, into the current node
+      template <class T> inline
+      void saveValue( T const & value )
+      {
+        auto & str = itsFormatBuffer.str();
+        str.clear();
+        itsFormatStream << value;
+
+        // as with the XMLOutputArchive, values end at the first null character
+        str.resize( std::strlen( str.c_str() ) );
+
+        // If the first or last character is a whitespace, add xml:space attribute
+        const auto len = str.length();
+        if ( len > 0 && ( xml_detail::isWhitespace( str[0] ) || xml_detail::isWhitespace( str[len - 1] ) ) )
+          appendAttribute( "xml:space", "preserve" );
+
+        auto & node = itsNodes.back();
+        if( node.state == NodeInfo::Open )
+        {
+          // a single value is printed on the same line as its node, once we know no more follow
+          itsValue.swap( str );
+          node.state = NodeInfo::Value;
+        }
+        else
+        {
+          startChildren();
+          writeData( str );
+        }
+      }
+
+      //! Overload for uint8_t prevents them from being serialized as characters
+      void saveValue( uint8_t const & value )
+      {
+        saveValue( static_cast<uint32_t>( value ) );
+      }
+
+      //! Overload for int8_t prevents them from being serialized as characters
+      void saveValue( int8_t const & value )
+      {
+        saveValue( static_cast<int32_t>( value ) );
+      }
+
+      //! Causes the type to be appended as an attribute to the most recently made node if output type is set to true
+      template <class T> inline
+      void insertType()
+      {
+        if( !itsOutputType )
+          return;
+
+        appendAttribute( "type", util::demangledName<T>().c_str() );
+      }
+
+      //! Appends an attribute to the current node
+      /*! @throws Exception if the node already has children */
+      void appendAttribute( const char * name, const char * value )
+      {
+        if( itsNodes.back().state == NodeInfo::Children )
+          throw Exception("XMLStreamOutputArchive - attributes must be added to a node before its children");
+
+        itsBuffer += ' ';
+        itsBuffer += name;
+        itsBuffer += '=';
+
+        // quote as rapidxml does, with single quotes if the value contains a double quote
+        auto const end = value + std::strlen( value );
+        auto const quote = std::find( value, end, '"' ) != end ? '\'' : '"';
+        itsBuffer += quote;
+        xml_stream_detail::appendEscaped( itsBuffer, value, end, quote == '"' ? '\'' : '"' );
+        itsBuffer += quote;
+      }
+
+      bool hasSizeAttributes() const { return itsSizeAttributes; }
+
+    private:
+      //! A node that has been started but not finished
+      struct NodeInfo
+      {
+        //! What has been written for the node so far
+        enum State
+        {
+          Open,    //!< The unterminated start tag
+          Value,   //!< The unterminated start tag, with a single value held back in itsValue
+          Children //!< The start tag and at least one child
+        };
+
+        NodeInfo( std::string n ) :
+          nodeName( std::move( n ) ),
+          counter( 0 ),
+          name( nullptr ),
+          state( Open )
+        { }
+
+        std::string nodeName; //!< The name of this node
+        size_t counter;       //!< The counter for naming child nodes
+        const char * name;    //!< The name for the next child node
+        State state;
+
+        //! Gets the name for the next child node created from this node
+        std::string getValueName()
+        {
+          if( name )
+          {
+            auto n = name;
+            name = nullptr;
+            return {n};
+          }
+          else
+            return "value" + std::to_string( counter++ );
+        }
+      };
+
+      //! Terminates the start tag of the current node, if needed, so that children can be written
+      void startChildren()
+      {
+        auto & node = itsNodes.back();
+        if( node.state == NodeInfo::Children )
+          return;
+
+        itsBuffer += '>';
+        newline();
+
+        if( node.state == NodeInfo::Value )
+        {
+          node.state = NodeInfo::Children;
+          writeData( itsValue );
+        }
+
+        node.state = NodeInfo::Children;
+      }
+
+      //! Writes a value as a child of the current node
+      void writeData( std::string const & value )
+      {
+        indent( itsNodes.size() );
+        xml_stream_detail::appendEscaped( itsBuffer, value.data(), value.data() + value.size(), 0 );
+        newline();
+      }
+
+      void indent( size_t depth )
+      {
+        if( itsIndent )
+          itsBuffer.append( depth, '\t' );
+      }
+
+      void newline()
+      {
+        if( itsIndent )
+          itsBuffer += '\n';
+      }
+
+      void flush()
+      {
+        itsStream.write( itsBuffer.data(), static_cast<std::streamsize>( itsBuffer.size() ) );
+        itsBuffer.clear();
+      }
+
+      //! @}
+
+      static const size_t FlushSize = 64 * 1024; //!< Output is written to the stream in blocks of about this size
+
+      std::ostream & itsStream;                          //!< The output stream
+      std::string itsBuffer;                             //!< Output not yet written to the stream
+      std::string itsValue;                              //!< The value held back for the current node
+      std::vector<NodeInfo> itsNodes;                    //!< The nodes that have been started but not finished
+      xml_stream_detail::StringBuffer itsFormatBuffer;   //!< Holds formatted values
+      std::ostream itsFormatStream;                      //!< Used to format values into itsFormatBuffer
+      bool itsOutputType;                                //!< Controls whether type information is printed
+      bool itsIndent;                                    //!< Controls whether indenting is used
+      bool itsSizeAttributes;                            //!< Controls whether lists have a size attribute
+  }; // XMLStreamOutputArchive
+
+  // ######################################################################
+  //! An input archive that reads XML from its stream as data is loaded
+  /*! The XMLInputArchive reads its entire input and parses it into a document before loading
+      anything.  This archive instead reads one element, value or end tag at a time as data is
+      loaded and only holds the path from the root to the current node in memory.  It loads
+      the output of either XML output archive.
+
+      Loading in the order data was saved, with or without NVPs, needs no additional memory.  When
+      an NVP does not match the next node, the remaining children of the current node are buffered
+      and the node is looked up among them.  As with the XMLInputArchive, loading then proceeds
+      sequentially from the node that was found.  Unlike the XMLInputArchive, nodes that have
+      already been loaded cannot be searched for again.
+
+      When a size is loaded, the remaining children of the node are counted ahead in the underlying
+      stream, which is then repositioned to continue loading.  If the stream cannot be repositioned
+      (e.g. a pipe), the remaining children are buffered instead.
+
+      \ingroup Archives */
+  class XMLStreamInputArchive : public InputArchive<XMLStreamInputArchive>, public traits::TextArchive
+  {
+    public:
+      /*! @name Common Functionality
+          Common use cases for directly interacting with an XMLStreamInputArchive */
+      //! @{
+
+      //! Construct, reading from the provided stream
+      /*! Reads up to the start of the root node
+
+          @param stream The stream to read from.  Can be a stringstream or a file. */
+      XMLStreamInputArchive( std::istream & stream ) :
+        InputArchive<XMLStreamInputArchive>( this ),
+        itsTokenizer( stream ),
+        itsHasToken( false )
+      {
+        try
+        {
+          while( peek().type == Token::Text )
+            consume();
+        }
+        catch( Exception const & )
+        {
+          throw Exception("Could not detect cereal root node - likely due to empty or invalid input");
+        }
+
+        if( peek().type != Token::Start || peek().string != xml_detail::CEREAL_XML_STRING )
+          throw Exception("Could not detect cereal root node - likely due to empty or invalid input");
+
+        consume();
+        itsFrames.emplace_back();
+      }
+
+      ~XMLStreamInputArchive() CEREAL_NOEXCEPT = default;
+
+      //! Loads some binary data, encoded as a base64 string, optionally specified by some name
+      /*! This will automatically start and finish a node to load the data, and can be called directly by
+          users.
+
+          Note that this follows the same ordering rules specified in the class description in regards
+          to loading in/out of order */
+      void loadBinaryValue( void * data, size_t size, const char * name = nullptr )
+      {
+        setNextName( name );
+        startNode();
+
+        std::string encoded;
+        loadValue( encoded );
+
+        auto decoded = base64::decode( encoded );
+
+        if( size != decoded.size() )
+          throw Exception("Decoded binary data size does not match specified size");
+
+        std::memcpy( data, decoded.data(), decoded.size() );
+
+        finishNode();
+      }
+
+    private:
+      //! @}
+      /*! @name Internal Functionality
+          Functionality designed for use by those requiring control over the inner mechanisms of
+          the XMLStreamInputArchive */
+      //! @{
+
+      //! A start tag, value or end tag
+      struct Token
+      {
+        enum Type { Start, Text, End };
+
+        Type type;
+        std::string string; //!< The name of a start tag or the value of text
+      };
+
+      //! Splits XML read from a std::istream into tokens, following the rules rapidxml parses cereal's XML with
+      /*! Values are trimmed unless their node has the xml:space="preserve" attribute.  Comments, processing
+          instructions, CDATA sections and the doctype are skipped. */
+      class Tokenizer
+      {
+        public:
+          Tokenizer( std::istream & stream ) :
+            itsStream( stream ), itsBuffer( 64 * 1024 ), itsPosition( 0 ), itsEnd( 0 ), itsSelfClosed( false )
+          { }
+
+          //! Reads the next token
+          void next( Token & token )
+          {
+            if( itsSelfClosed )
+            {
+              itsSelfClosed = false;
+              endElement( token );
+              return;
+            }
+
+            while( true )
+            {
+              char c = peekChar();
+              if( c == '\0' )
+                throw Exception("XML Parsing failed - unexpected end of input");
+
+              if( c != '<' )
+              {
+                if( readText( token.string ) )
+                {
+                  token.type = Token::Text;
+                  return;
+                }
+                continue;
+              }
+
+              takeChar();
+              c = peekChar();
+              if( c == '/' )
+              {
+                skipPast( ">" );
+                endElement( token );
+                return;
+              }
+              else if( c == '?' )
+                skipPast( "?>" );
+              else if( c == '!' )
+              {
+                takeChar();
+                if( peekChar() == '-' )
+                  skipPast( "-->" );
+                else if( peekChar() == '[' )
+                  skipPast( "]]>" );
+                else
+                  skipDoctype();
+              }
+              else
+              {
+                startElement( token );
+                return;
+              }
+            }
+          }
+
+          //! Whether the last start tag was self closing, in which case its end is the next token
+          bool pendingEnd() const { return itsSelfClosed; }
+
+          //! Counts the child elements left in the element being read, up to its end tag
+          /*! The characters after the current position are scanned, reading ahead from the
+              underlying stream if needed, which is then repositioned.
+
+              @param count Set to the number of child elements that have not been read yet
+              @return false if the underlying stream could not be repositioned */
+          bool countChildren( size_t & count )
+          {
+            ChildCounter counter;
+            counter.scan( itsBuffer.data() + itsPosition, itsBuffer.data() + itsEnd );
+
+            if( !counter.done && itsStream )
+            {
+              auto const resume = itsStream.tellg();
+              if( resume == std::istream::pos_type( -1 ) )
+                return false;
+
+              itsScanBuffer.resize( itsBuffer.size() );
+              while( !counter.done )
+              {
+                itsStream.read( itsScanBuffer.data(), static_cast<std::streamsize>( itsScanBuffer.size() ) );
+                auto const read = static_cast<size_t>( itsStream.gcount() );
+                if( read == 0 )
+                  break;
+
+                counter.scan( itsScanBuffer.data(), itsScanBuffer.data() + read );
+              }
+
+              itsStream.clear();
+              if( !itsStream.seekg( resume ) )
+                throw Exception("XMLStreamInputArchive - failed to reposition the input stream");
+            }
+
+            count = counter.count;
+            return true;
+          }
+
+        private:
+          //! Counts the elements that start before the end tag of their parent
+          struct ChildCounter
+          {
+            enum State { Content, TagOpen, StartTag, Quoted, Slash, EndTag, Bang, Comment, Section, Declaration, Instruction };
+
+            ChildCounter() : state( Content ), depth( 0 ), count( 0 ), run( 0 ), brackets( 0 ), quote( 0 ), done( false ) {}
+
+            //! Scans a range of characters, stopping at the end tag of the parent
+            void scan( const char * c, const char * const end )
+            {
+              for( ; c != end && !done; ++c )
+              {
+                switch( state )
+                {
+                  case Content:
+                    c = std::find( c, end, '<' );
+                    if( c == end )
+                      return;
+                    state = TagOpen;
+                    break;
+                  case TagOpen:
+                    if( *c == '/' )
+                      state = EndTag;
+                    else if( *c == '?' )
+                      state = Instruction, run = 0;
+                    else if( *c == '!' )
+                      state = Bang;
+                    else
+                    {
+                      if( depth == 0 )
+                        ++count;
+                      state = StartTag;
+                    }
+                    break;
+                  case StartTag:
+                    if( *c == '"' || *c == '\'' )
+                      quote = *c, state = Quoted;
+                    else if( *c == '/' )
+                      state = Slash;
+                    else if( *c == '>' )
+                      ++depth, state = Content;
+                    break;
+                  case Quoted:
+                    if( *c == quote )
+                      state = StartTag;
+                    break;
+                  case Slash:
+                    state = *c == '>' ? Content : StartTag;
+                    break;
+                  case EndTag:
+                    if( *c == '>' )
+                    {
+                      if( depth == 0 )
+                        done = true;
+                      else
+                        --depth;
+                      state = Content;
+                    }
+                    break;
+                  case Bang:
+                    run = 0;
+                    brackets = 0;
+                    state = *c == '-' ? Comment : *c == '[' ? Section : Declaration;
+                    break;
+                  case Comment:
+                  case Section:
+                    // ends with --> or ]]>, counting the first - or [ of the opening
+                    if( *c == '>' && run >= 2 )
+                      state = Content;
+                    else
+                      run = *c == ( state == Comment ? '-' : ']' ) ? run + 1 : 0;
+                    break;
+                  case Declaration:
+                    if( *c == '[' )
+                      ++brackets;
+                    else if( *c == ']' )
+                      --brackets;
+                    else if( *c == '>' && brackets == 0 )
+                      state = Content;
+                    break;
+                  case Instruction:
+                    if( *c == '>' && run > 0 )
+                      state = Content;
+                    else
+                      run = *c == '?' ? 1 : 0;
+                    break;
+                }
+              }
+            }
+
+            State state;
+            size_t depth, count, run, brackets;
+            char quote;
+            bool done;
+          };
+
+          //! Refills the buffer, returning false at the end of the input
+          bool refill()
+          {
+            itsPosition = 0;
+            itsEnd = 0;
+            if( itsStream )
+            {
+              itsStream.read( itsBuffer.data(), static_cast<std::streamsize>( itsBuffer.size() ) );
+              itsEnd = static_cast<size_t>( itsStream.gcount() );
+            }
+            return itsEnd > 0;
+          }
+
+          //! Returns the next character, or 0 at the end of the input
+          char peekChar()
+          {
+            if( itsPosition == itsEnd && !refill() )
+              return '\0';
+            return itsBuffer[itsPosition];
+          }
+
+          //! Returns and consumes the next character, or 0 at the end of the input
+          char takeChar()
+          {
+            auto const c = peekChar();
+            if( itsPosition != itsEnd )
+              ++itsPosition;
+            return c;
+          }
+
+          static bool isSpace( char c ) { return xml_detail::isWhitespace( c ); }
+
+          //! Skips characters up to and including terminator
+          void skipPast( const char * terminator )
+          {
+            auto const length = std::strlen( terminator );
+            size_t matched = 0;
+            while( matched < length )
+            {
+              auto const c = takeChar();
+              if( c == '\0' )
+                throw Exception("XML Parsing failed - unexpected end of input");
+              matched = c == terminator[matched] ? matched + 1 : ( c == terminator[0] ? 1 : 0 );
+            }
+          }
+
+          //! Skips a doctype declaration, which may contain bracketed internal declarations
+          void skipDoctype()
+          {
+            int brackets = 0;
+            while( true )
+            {
+              auto const c = takeChar();
+              if( c == '\0' )
+                throw Exception("XML Parsing failed - unexpected end of input");
+              else if( c == '[' )
+                ++brackets;
+              else if( c == ']' )
+                --brackets;
+              else if( c == '>' && brackets == 0 )
+                return;
+            }
+          }
+
+          //! Reads a start tag, after its '<', keeping track of xml:space
+          void startElement( Token & token )
+          {
+            token.type = Token::Start;
+            readName( token.string, '\0' );
+            if( token.string.empty() )
+              throw Exception("XML Parsing failed - likely due to invalid characters or invalid naming");
+
+            bool preserve = false;
+            while( true )
+            {
+              while( isSpace( peekChar() ) )
+                takeChar();
+
+              auto const c = peekChar();
+              if( c == '>' )
+              {
+                takeChar();
+                break;
+              }
+              else if( c == '/' )
+              {
+                takeChar();
+                if( takeChar() != '>' )
+                  throw Exception("XML Parsing failed - likely due to invalid characters or invalid naming");
+                itsSelfClosed = true;
+                break;
+              }
+
+              readName( itsAttributeName, '=' );
+              while( isSpace( peekChar() ) )
+                takeChar();
+              if( itsAttributeName.empty() || takeChar() != '=' )
+                throw Exception("XML Parsing failed - likely due to invalid characters or invalid naming");
+              while( isSpace( peekChar() ) )
+                takeChar();
+
+              auto const quote = takeChar();
+              if( quote != '"' && quote != '\'' )
+                throw Exception("XML Parsing failed - likely due to invalid characters or invalid naming");
+
+              itsAttributeValue.clear();
+              for( char v = takeChar(); v != quote; v = takeChar() )
+              {
+                if( v == '\0' )
+                  throw Exception("XML Parsing failed - unexpected end of input");
+                itsAttributeValue += v;
+              }
+
+              if( itsAttributeName == "xml:space" )
+                preserve = itsAttributeValue == "preserve";
+            }
+
+            itsPreserve.push_back( preserve );
+          }
+
+          void endElement( Token & token )
+          {
+            token.type = Token::End;
+            if( !itsPreserve.empty() )
+              itsPreserve.pop_back();
+          }
+
+          //! Reads a name, ending at whitespace, '/', '>', '?', the end of the input or stop
+          void readName( std::string & name, char stop )
+          {
+            name.clear();
+            for( char c = peekChar(); c != '\0' && c != stop && !isSpace( c ) && c != '/' && c != '>' && c != '?'; c = peekChar() )
+            {
+              name += c;
+              takeChar();
+            }
+          }
+
+          //! Reads text up to the next '<', replacing references
+          /*! @return false if the text is only whitespace that is not preserved */
+          bool readText( std::string & text )
+          {
+            text.clear();
+            while( true )
+            {
+              if( itsPosition == itsEnd && !refill() )
+                break;
+
+              auto const begin = itsBuffer.data() + itsPosition;
+              auto const end = itsBuffer.data() + itsEnd;
+              auto stop = begin;
+              while( stop != end && *stop != '<' && *stop != '&' )
+                ++stop;
+
+              text.append( begin, stop );
+              itsPosition += static_cast<size_t>( stop - begin );
+
+              if( stop == end )
+                continue;
+              if( *stop == '<' )
+                break;
+
+              takeChar();
+              readReference( text );
+            }
+
+            if( !itsPreserve.empty() && itsPreserve.back() )
+              return !text.empty();
+
+            auto const first = std::find_if_not( text.begin(), text.end(), isSpace );
+            if( first == text.end() )
+              return false;
+            text.erase( std::find_if_not( text.rbegin(), text.rend(), isSpace ).base(), text.end() );
+            text.erase( text.begin(), first );
+            return true;
+          }
+
+          //! Replaces a reference, after its '&', as rapidxml does
+          void readReference( std::string & text )
+          {
+            if( peekChar() == '#' )
+            {
+              takeChar();
+              unsigned long base = 10;
+              if( peekChar() == 'x' )
+              {
+                takeChar();
+                base = 16;
+              }
+
+              unsigned long code = 0;
+              while( true )
+              {
+                auto const c = peekChar();
+                unsigned long digit;
+                if( c >= '0' && c <= '9' )
+                  digit = static_cast<unsigned long>( c - '0' );
+                else if( base == 16 && c >= 'a' && c <= 'f' )
+                  digit = static_cast<unsigned long>( c - 'a' + 10 );
+                else if( base == 16 && c >= 'A' && c <= 'F' )
+                  digit = static_cast<unsigned long>( c - 'A' + 10 );
+                else
+                  break;
+                code = code * base + digit;
+                takeChar();
+              }
+
+              if( takeChar() != ';' )
+                throw Exception("XML Parsing failed - expected ; after a numeric character entity");
+              xml_stream_detail::appendUtf8( text, code );
+              return;
+            }
+
+            std::array<char, 4> name;
+            size_t length = 0;
+            while( length < name.size() && std::isalpha( static_cast<unsigned char>( peekChar() ) ) )
+              name[length++] = takeChar();
+
+            std::string const entity( name.data(), length );
+            if( peekChar() == ';' )
+            {
+              char replacement = '\0';
+              if( entity == "amp" ) replacement = '&';
+              else if( entity == "apos" ) replacement = '\'';
+              else if( entity == "quot" ) replacement = '"';
+              else if( entity == "gt" ) replacement = '>';
+              else if( entity == "lt" ) replacement = '<';
+
+              if( replacement )
+              {
+                takeChar();
+                text += replacement;
+                return;
+              }
+            }
+
+            // not a reference, the '&' is copied verbatim
+            text += '&';
+            text += entity;
+          }
+
+          std::istream & itsStream;
+          std::vector<char> itsBuffer;     //!< Characters read from the stream
+          std::vector<char> itsScanBuffer; //!< Characters read ahead while counting children
+          size_t itsPosition, itsEnd;      //!< The current position and end of the characters in itsBuffer
+          bool itsSelfClosed;              //!< Whether the end of the last start tag is the next token
+          std::vector<bool> itsPreserve;   //!< Whether each open element preserves whitespace
+          std::string itsAttributeName, itsAttributeValue;
+      };
+
+      //! A child node that was buffered for loading out of order
+      struct Member
+      {
+        std::string name;          //!< The name of the node
+        std::vector<Token> tokens; //!< The tokens of the node, from its start to its end
+      };
+
+      //! A node that has been started but not finished
+      struct Frame
+      {
+        Frame() : name( nullptr ), buffered( false ), hasValue( false ), index( 0 ), bufferedIndex( 0 ), next( 0 ) {}
+
+        const char * name;           //!< The NVP name for next child node
+        bool buffered;               //!< Whether the rest of the node, up to its end, has been read into members
+        bool hasValue;               //!< Whether value holds the value of the node
+        size_t index;                //!< Number of children loaded
+        size_t bufferedIndex;        //!< Number of children loaded before the node was buffered
+        size_t next;                 //!< Position in members of the next child to load sequentially
+        std::string value;           //!< The value of the node
+        std::vector<Member> members; //!< The buffered children
+      };
+
+      //! Buffered tokens that are read before any others
+      struct Replay
+      {
+        std::vector<Token> const * tokens;
+        size_t position;
+      };
+
+      //! Returns the next token without consuming it
+      Token const & peek()
+      {
+        if( !itsReplays.empty() )
+          return (*itsReplays.back().tokens)[itsReplays.back().position];
+
+        if( !itsHasToken )
+        {
+          itsTokenizer.next( itsToken );
+          itsHasToken = true;
+        }
+
+        return itsToken;
+      }
+
+      //! Consumes the token returned by peek
+      void consume()
+      {
+        if( !itsReplays.empty() )
+        {
+          if( ++itsReplays.back().position == itsReplays.back().tokens->size() )
+            itsReplays.pop_back();
+        }
+        else
+          itsHasToken = false;
+      }
+
+      //! Returns the next token that is not a value of the current node, keeping the first value
+      Token const & peekChild()
+      {
+        auto & frame = itsFrames.back();
+        while( peek().type == Token::Text )
+        {
+          if( !frame.hasValue )
+          {
+            frame.value = peek().string;
+            frame.hasValue = true;
+          }
+          consume();
+        }
+
+        return peek();
+      }
+
+      //! Reads the remaining children of the current node, up to and including its end, into its members
+      void bufferMembers()
+      {
+        auto & frame = itsFrames.back();
+        frame.buffered = true;
+        frame.bufferedIndex = frame.index;
+        frame.next = 0;
+
+        while( peekChild().type != Token::End )
+        {
+          frame.members.emplace_back();
+          auto & member = frame.members.back();
+          member.name = peek().string;
+
+          size_t depth = 0;
+          do
+          {
+            member.tokens.push_back( peek() );
+            consume();
+
+            if( member.tokens.back().type == Token::Start )
+              ++depth;
+            else if( member.tokens.back().type == Token::End )
+              --depth;
+          } while( depth > 0 );
+        }
+
+        consume();
+        frame.hasValue = true;
+      }
+
+      //! Returns the value of the current node
+      const char * value()
+      {
+        auto & frame = itsFrames.back();
+        if( !frame.hasValue )
+        {
+          peekChild();
+          frame.hasValue = true;
+        }
+
+        return frame.value.c_str();
+      }
+
+    public:
+      //! Prepares to start reading the next node
+      /*! By default the children of a node are read in the order they show up in the document.
+
+          We check to see if the specified NVP matches what the next node is.  If they match, we just
+          continue as normal, going in order.  If they don't match, the remaining children are buffered
+          and we search for the NVP among them.  If that NVP does not exist, we throw an exception. */
+      void startNode()
+      {
+        auto & frame = itsFrames.back();
+        auto const expectedName = frame.name;
+        frame.name = nullptr;
+
+        if( !frame.buffered )
+        {
+          auto const & token = peekChild();
+          if( token.type == Token::Start && ( !expectedName || token.string == expectedName ) )
+          {
+            consume();
+            ++frame.index;
+            itsFrames.emplace_back();
+            return;
+          }
+
+          if( !expectedName )
+            throw Exception("No more objects in input");
+
+          bufferMembers();
+        }
+
+        auto index = frame.next;
+        if( expectedName )
+        {
+          index = 0;
+          while( index < frame.members.size() && frame.members[index].name != expectedName )
+            ++index;
+
+          if( index == frame.members.size() )
+            throw Exception("XML Parsing failed - provided NVP (" + std::string(expectedName) + ") not found");
+        }
+        else if( index == frame.members.size() )
+          throw Exception("No more objects in input");
+
+        frame.next = index + 1;
+        ++frame.index;
+        itsReplays.push_back( { &frame.members[index].tokens, 0 } );
+
+        consume();
+        itsFrames.emplace_back();
+      }
+
+      //! Finishes reading the current node, skipping any children that were not loaded
+      void finishNode()
+      {
+        if( !itsFrames.back().buffered )
+        {
+          size_t depth = 0;
+          while( true )
+          {
+            auto const type = peek().type;
+            consume();
+
+            if( type == Token::Start )
+              ++depth;
+            else if( type == Token::End && depth-- == 0 )
+              break;
+          }
+        }
+
+        itsFrames.pop_back();
+        itsFrames.back().name = nullptr;
+      }
+
+      //! Retrieves the current node name
+      //! will return @c nullptr if the node does not have a name
+      const char * getNodeName()
+      {
+        auto const & frame = itsFrames.back();
+        if( frame.buffered )
+          return frame.next < frame.members.size() ? frame.members[frame.next].name.c_str() : nullptr;
+
+        auto const & token = peekChild();
+        return token.type == Token::Start ? token.string.c_str() : nullptr;
+      }
+
+      //! Sets the name for the next node created with startNode
+      void setNextName( const char * name )
+      {
+        itsFrames.back().name = name;
+      }
+
+      //! Loads a bool from the current top node
+      template <class T, traits::EnableIf<std::is_unsigned<T>::value,
+                                          std::is_same<T, bool>::value> = traits::sfinae> inline
+      void loadValue( T & value_ )
+      {
+        std::istringstream is( value() );
+        is.setf( std::ios::boolalpha );
+        is >> value_;
+      }
+
+      //! Loads a char (signed or unsigned) from the current top node
+      template <class T, traits::EnableIf<std::is_integral<T>::value,
+                                          !std::is_same<T, bool>::value,
+                                          sizeof(T) == sizeof(char)> = traits::sfinae> inline
+      void loadValue( T & value_ )
+      {
+        value_ = *reinterpret_cast<const T*>( value() );
+      }
+
+      //! Load an int8_t from the current top node (ensures we parse entire number)
+      void loadValue( int8_t & value_ )
+      {
+        int32_t val; loadValue( val ); value_ = static_cast<int8_t>( val );
+      }
+
+      //! Load a uint8_t from the current top node (ensures we parse entire number)
+      void loadValue( uint8_t & value_ )
+      {
+        uint32_t val; loadValue( val ); value_ = static_cast<uint8_t>( val );
+      }
+
+      //! Loads a type best represented as an unsigned long from the current top node
+      template <class T, traits::EnableIf<std::is_unsigned<T>::value,
+                                          !std::is_same<T, bool>::value,
+                                          !std::is_same<T, char>::value,
+                                          !std::is_same<T, unsigned char>::value,
+                                          sizeof(T) < sizeof(long long)> = traits::sfinae> inline
+      void loadValue( T & value_ )
+      {
+        value_ = static_cast<T>( std::stoul( value() ) );
+      }
+
+      //! Loads a type best represented as an unsigned long long from the current top node
+      template <class T, traits::EnableIf<std::is_unsigned<T>::value,
+                                          !std::is_same<T, bool>::value,
+                                          sizeof(T) >= sizeof(long long)> = traits::sfinae> inline
+      void loadValue( T & value_ )
+      {
+        value_ = static_cast<T>( std::stoull( value() ) );
+      }
+
+      //! Loads a type best represented as an int from the current top node
+      template <class T, traits::EnableIf<std::is_signed<T>::value,
+                                          !std::is_same<T, char>::value,
+                                          sizeof(T) <= sizeof(int)> = traits::sfinae> inline
+      void loadValue( T & value_ )
+      {
+        value_ = static_cast<T>( std::stoi( value() ) );
+      }
+
+      //! Loads a type best represented as a long from the current top node
+      template <class T, traits::EnableIf<std::is_signed<T>::value,
+                                          (sizeof(T) > sizeof(int)),
+                                          sizeof(T) <= sizeof(long)> = traits::sfinae> inline
+      void loadValue( T & value_ )
+      {
+        value_ = static_cast<T>( std::stol( value() ) );
+      }
+
+      //! Loads a type best represented as a long long from the current top node
+      template <class T, traits::EnableIf<std::is_signed<T>::value,
+                                          (sizeof(T) > sizeof(long)),
+                                          sizeof(T) <= sizeof(long long)> = traits::sfinae> inline
+      void loadValue( T & value_ )
+      {
+        value_ = static_cast<T>( std::stoll( value() ) );
+      }
+
+      //! Loads a type best represented as a float from the current top node
+      void loadValue( float & value_ )
+      {
+        try
+        {
+          value_ = std::stof( value() );
+        }
+        catch( std::out_of_range const & )
+        {
+          // special case for denormalized values
+          std::istringstream is( value() );
+          is >> value_;
+          if( std::fpclassify( value_ ) != FP_SUBNORMAL )
+            throw;
+        }
+      }
+
+      //! Loads a type best represented as a double from the current top node
+      void loadValue( double & value_ )
+      {
+        try
+        {
+          value_ = std::stod( value() );
+        }
+        catch( std::out_of_range const & )
+        {
+          // special case for denormalized values
+          std::istringstream is( value() );
+          is >> value_;
+          if( std::fpclassify( value_ ) != FP_SUBNORMAL )
+            throw;
+        }
+      }
+
+      //! Loads a type best represented as a long double from the current top node
+      void loadValue( long double & value_ )
+      {
+        try
+        {
+          value_ = std::stold( value() );
+        }
+        catch( std::out_of_range const & )
+        {
+          // special case for denormalized values
+          std::istringstream is( value() );
+          is >> value_;
+          if( std::fpclassify( value_ ) != FP_SUBNORMAL )
+            throw;
+        }
+      }
+
+      //! Loads a string from the current top node
+      template<class CharT, class Traits, class Alloc> inline
+      void loadValue( std::basic_string<CharT, Traits, Alloc> & str )
+      {
+        std::basic_istringstream<CharT, Traits> is( value() );
+
+        str.assign( std::istreambuf_iterator<CharT, Traits>( is ),
+                    std::istreambuf_iterator<CharT, Traits>() );
+      }
+
+      //! Loads a string from the current top node
+      void loadValue( std::string & str )
+      {
+        str = value();
+      }
+
+      //! Loads the number of children of the current top node
+      /*! Counts the children without loading them, see the class description */
+      template <class T> inline
+      void loadSize( T & value_ )
+      {
+        auto & frame = itsFrames.back();
+        if( frame.buffered )
+        {
+          value_ = frame.bufferedIndex + frame.members.size();
+          return;
+        }
+
+        size_t remaining = 0;
+        if( !itsReplays.empty() )
+        {
+          // the node is being replayed from a buffered member
+          auto const & replay = itsReplays.back();
+          size_t depth = 0;
+          for( auto token = replay.tokens->begin() + static_cast<std::ptrdiff_t>( replay.position ); depth > 0 || token->type != Token::End; ++token )
+          {
+            if( token->type == Token::Start && depth++ == 0 )
+              ++remaining;
+            else if( token->type == Token::End )
+              --depth;
+          }
+        }
+        else if( itsHasToken ? itsToken.type != Token::End : !itsTokenizer.pendingEnd() && !itsTokenizer.countChildren( remaining ) )
+        {
+          bufferMembers();
+          remaining = frame.members.size();
+        }
+
+        value_ = static_cast<T>( frame.index + remaining );
+      }
+
+      //! @}
+
+    private:
+      Tokenizer itsTokenizer;          //!< Splits the stream into tokens
+      Token itsToken;                  //!< The next token read from the stream
+      bool itsHasToken;                //!< Whether itsToken has been read but not consumed
+      std::vector<Frame> itsFrames;    //!< The nodes that have been started but not finished
+      std::vector<Replay> itsReplays;  //!< Buffered tokens to read before the stream
+  };
+
+  // ######################################################################
+  // XMLStreamArchive prologue and epilogue functions
+  // ######################################################################
+
+  // ######################################################################
+  //! Prologue for NVPs for streaming XML archives
+  /*! NVPs do not start or finish nodes - they just set up the names */
+  template <class T> inline
+  void prologue( XMLStreamOutputArchive &, NameValuePair<T> const & )
+  { }
+
+  //! Prologue for NVPs for streaming XML archives
+  template <class T> inline
+  void prologue( XMLStreamInputArchive &, NameValuePair<T> const & )
+  { }
+
+  // ######################################################################
+  //! Epilogue for NVPs for streaming XML archives
+  /*! NVPs do not start or finish nodes - they just set up the names */
+  template <class T> inline
+  void epilogue( XMLStreamOutputArchive &, NameValuePair<T> const & )
+  { }
+
+  //! Epilogue for NVPs for streaming XML archives
+  template <class T> inline
+  void epilogue( XMLStreamInputArchive &, NameValuePair<T> const & )
+  { }
+
+  // ######################################################################
+  //! Prologue for deferred data for streaming XML archives
+  template <class T> inline
+  void prologue( XMLStreamOutputArchive &, DeferredData<T> const & )
+  { }
+
+  //! Prologue for deferred data for streaming XML archives
+  template <class T> inline
+  void prologue( XMLStreamInputArchive &, DeferredData<T> const & )
+  { }
+
+  // ######################################################################
+  //! Epilogue for deferred data for streaming XML archives
+  template <class T> inline
+  void epilogue( XMLStreamOutputArchive &, DeferredData<T> const & )
+  { }
+
+  //! Epilogue for deferred data for streaming XML archives
+  template <class T> inline
+  void epilogue( XMLStreamInputArchive &, DeferredData<T> const & )
+  { }
+
+  // ######################################################################
+  //! Prologue for SizeTags for streaming XML output archives
+  /*! SizeTags do not start or finish nodes */
+  template <class T> inline
+  void prologue( XMLStreamOutputArchive & ar, SizeTag<T> const & )
+  {
+    if( ar.hasSizeAttributes() )
+      ar.appendAttribute( "size", "dynamic" );
+  }
+
+  template <class T> inline
+  void prologue( XMLStreamInputArchive &, SizeTag<T> const & )
+  { }
+
+  //! Epilogue for SizeTags for streaming XML output archives
+  /*! SizeTags do not start or finish nodes */
+  template <class T> inline
+  void epilogue( XMLStreamOutputArchive &, SizeTag<T> const & )
+  { }
+
+  template <class T> inline
+  void epilogue( XMLStreamInputArchive &, SizeTag<T> const & )
+  { }
+
+  // ######################################################################
+  //! Prologue for all other types for streaming XML output archives (except minimal types)
+  /*! Starts a new node, named either automatically or by some NVP,
+      that may be given data by the type about to be archived
+
+      Minimal types do not start or end nodes */
+  template <class T, traits::DisableIf<traits::has_minimal_base_class_serialization<T, traits::has_minimal_output_serialization, XMLStreamOutputArchive>::value ||
+                                       traits::has_minimal_output_serialization<T, XMLStreamOutputArchive>::value> = traits::sfinae> inline
+  void prologue( XMLStreamOutputArchive & ar, T const & )
+  {
+    ar.startNode();
+    ar.insertType<T>();
+  }
+
+  //! Prologue for all other types for streaming XML input archives (except minimal types)
+  template <class T, traits::DisableIf<traits::has_minimal_base_class_serialization<T, traits::has_minimal_input_serialization, XMLStreamInputArchive>::value ||
+                                       traits::has_minimal_input_serialization<T, XMLStreamInputArchive>::value> = traits::sfinae> inline
+  void prologue( XMLStreamInputArchive & ar, T const & )
+  {
+    ar.startNode();
+  }
+
+  // ######################################################################
+  //! Epilogue for all other types other for streaming XML output archives (except minimal types)
+  /*! Finishes the node created in the prologue
+
+      Minimal types do not start or end nodes */
+  template <class T, traits::DisableIf<traits::has_minimal_base_class_serialization<T, traits::has_minimal_output_serialization, XMLStreamOutputArchive>::value ||
+                                       traits::has_minimal_output_serialization<T, XMLStreamOutputArchive>::value> = traits::sfinae> inline
+  void epilogue( XMLStreamOutputArchive & ar, T const & )
+  {
+    ar.finishNode();
+  }
+
+  //! Epilogue for all other types other for streaming XML input archives (except minimal types)
+  template <class T, traits::DisableIf<traits::has_minimal_base_class_serialization<T, traits::has_minimal_input_serialization, XMLStreamInputArchive>::value ||
+                                       traits::has_minimal_input_serialization<T, XMLStreamInputArchive>::value> = traits::sfinae> inline
+  void epilogue( XMLStreamInputArchive & ar, T const & )
+  {
+    ar.finishNode();
+  }
+
+  // ######################################################################
+  // Common XMLStreamArchive serialization functions
+  // ######################################################################
+
+  //! Saving NVP types to streaming XML
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( XMLStreamOutputArchive & ar, NameValuePair<T> const & t )
+  {
+    ar.setNextName( t.name );
+    ar( t.value );
+  }
+
+  //! Loading NVP types from streaming XML
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( XMLStreamInputArchive & ar, NameValuePair<T> & t )
+  {
+    ar.setNextName( t.name );
+    ar( t.value );
+  }
+
+  // ######################################################################
+  //! Saving SizeTags to streaming XML
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( XMLStreamOutputArchive &, SizeTag<T> const & )
+  { }
+
+  //! Loading SizeTags from streaming XML
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( XMLStreamInputArchive & ar, SizeTag<T> & st )
+  {
+    ar.loadSize( st.size );
+  }
+
+  // ######################################################################
+  //! Saving for POD types to streaming XML
+  template <class T, traits::EnableIf<std::is_arithmetic<T>::value> = traits::sfinae> inline
+  void CEREAL_SAVE_FUNCTION_NAME(XMLStreamOutputArchive & ar, T const & t)
+  {
+    ar.saveValue( t );
+  }
+
+  //! Loading for POD types from streaming XML
+  template <class T, traits::EnableIf<std::is_arithmetic<T>::value> = traits::sfinae> inline
+  void CEREAL_LOAD_FUNCTION_NAME(XMLStreamInputArchive & ar, T & t)
+  {
+    ar.loadValue( t );
+  }
+
+  // ######################################################################
+  //! saving string to streaming XML
+  template<class CharT, class Traits, class Alloc> inline
+  void CEREAL_SAVE_FUNCTION_NAME(XMLStreamOutputArchive & ar, std::basic_string<CharT, Traits, Alloc> const & str)
+  {
+    ar.saveValue( str );
+  }
+
+  //! loading string from streaming XML
+  template<class CharT, class Traits, class Alloc> inline
+  void CEREAL_LOAD_FUNCTION_NAME(XMLStreamInputArchive & ar, std::basic_string<CharT, Traits, Alloc> & str)
+  {
+    ar.loadValue( str );
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::XMLStreamOutputArchive)
+CEREAL_REGISTER_ARCHIVE(cereal::XMLStreamInputArchive)
+
+// tie input and output archives together
+CEREAL_SETUP_ARCHIVE_TRAITS(cereal::XMLStreamInputArchive, cereal::XMLStreamOutputArchive)
+
+#endif // CEREAL_ARCHIVES_XML_STREAM_HPP_
@@ -41,8 +41,14 @@
 #include <functional>
 
 #include "cereal/macros.hpp"
+
+#ifdef CEREAL_HAS_MEMORY_RESOURCE
+#include <memory_resource>
+#endif
+
 #include "cereal/details/traits.hpp"
 #include "cereal/details/helpers.hpp"
+#include "cereal/details/profiling.hpp"
 #include "cereal/types/base_class.hpp"
 
 namespace cereal
@@ -297,6 +303,46 @@ namespace cereal
 
   #endif
 
+  // ######################################################################
+  //! Marks a trivially copyable type as serializable by copying its bytes
+  /*! Contiguous containers (std::vector, std::array, std::valarray, and C style
+      arrays) of types marked with this macro are serialized as a single block of
+      binary data by archives that support BinaryData, instead of one element at
+      a time.  The type must still provide serialization functions, which are used
+      by all other archives and define which bytes of the type are data.
+
+      The output is identical to serializing each element individually.  This
+      requires the arithmetic members serialized by the type to cover all of its
+      bytes, in the order they are laid out in memory, without padding between
+      them.  This is checked once per type at runtime, and types that do not meet
+      it (including versioned types) silently use per element serialization.
+      Portable binary archives swap the bytes of each of these members when the
+      endianness of the data differs from that of the machine.
+
+      @code{cpp}
+      struct Point
+      {
+        float x, y, z;
+
+        template <class Archive>
+        void serialize( Archive & ar )
+        { ar( x, y, z ); }
+      };
+
+      CEREAL_MEMCPY_SERIALIZABLE( Point )
+      @endcode
+
+      This macro should be placed at global scope.
+      @ingroup Utility */
+  #define CEREAL_MEMCPY_SERIALIZABLE(TYPE)                                          \
+  namespace cereal { namespace traits {                                             \
+    template <> struct is_memcpy_serializable<TYPE> : std::true_type                \
+    {                                                                               \
+      static_assert( std::is_trivially_copyable<TYPE>::value,                       \
+        "CEREAL_MEMCPY_SERIALIZABLE requires a trivially copyable type" );          \
+    };                                                                              \
+  } } // end namespaces
+
   // ######################################################################
   //! The base output archive class
   /*! This is the base output archive for all output archives.  If you create
@@ -401,17 +447,17 @@ namespace cereal
 
         // Handle null pointers by just returning 0
         if(addr == 0) return 0;
-        itsSharedPointerStorage.push_back(sharedPointer);
 
         auto id = itsSharedPointerMap.find( addr );
-        if( id == itsSharedPointerMap.end() )
+        if( id == nullptr )
         {
           auto ptrId = itsCurrentPointerId++;
-          itsSharedPointerMap.insert( {addr, ptrId} );
+          itsSharedPointerMap.insert( addr, ptrId );
+          itsSharedPointerStorage.push_back(sharedPointer);
           return ptrId | detail::msb_32bit; // mask MSB to be 1
         }
         else
-          return id->second;
+          return *id;
       }
 
       //! Registers a polymorphic type name with the archive
@@ -425,14 +471,52 @@ namespace cereal
       inline std::uint32_t registerPolymorphicType( char const * name )
       {
         auto id = itsPolymorphicTypeMap.find( name );
-        if( id == itsPolymorphicTypeMap.end() )
+        if( id == nullptr )
         {
           auto polyId = itsCurrentPolymorphicTypeId++;
-          itsPolymorphicTypeMap.insert( {name, polyId} );
+          itsPolymorphicTypeMap.insert( name, polyId );
           return polyId | detail::msb_32bit; // mask MSB to be 1
         }
         else
-          return id->second;
+          return *id;
+      }
+
+      //! Retrieves the polymorphic binding previously found for a type
+      /*! This lets polymorphic saves skip looking up the binding map for
+          types they have already saved with this archive.
+
+          @internal
+          @param type The dynamic type of the object being saved
+          @return The binding registered with registerPolymorphicBinding, or nullptr */
+      inline void const * getPolymorphicBinding( std::type_info const & type ) const
+      {
+        auto binding = itsPolymorphicBindings.find( &type );
+        return binding ? *binding : nullptr;
+      }
+
+      //! Remembers the polymorphic binding found for a type
+      /*! @internal
+          @param type The dynamic type of the object being saved
+          @param binding The binding map entry for the type */
+      inline void registerPolymorphicBinding( std::type_info const & type, void const * binding )
+      {
+        itsPolymorphicBindings.insert( &type, binding );
+      }
+
+    protected:
+      //! Forgets the shared pointers, polymorphic types and class versions that have been saved
+      /*! Data saved after this call does not refer to anything saved before it, so that it can be
+          loaded on its own by an input archive that calls InputArchive::resetTracking at the same
+          point.  Used by archives that load parts of their data on demand. */
+      void resetTracking()
+      {
+        itsBaseClassSet.clear();
+        itsSharedPointerMap.clear();
+        itsSharedPointerStorage.clear();
+        itsCurrentPointerId = 1;
+        itsPolymorphicTypeMap.clear();
+        itsCurrentPolymorphicTypeId = 1;
+        itsVersionedTypes.clear();
       }
 
     private:
@@ -440,6 +524,7 @@ namespace cereal
       template <class T> inline
       void process( T && head )
       {
+        CEREAL_PROFILE_SCOPE( T );
         prologue( *self, head );
         self->processImpl( head );
         epilogue( *self, head );
@@ -595,16 +680,18 @@ namespace cereal
       template <class T> inline
       std::uint32_t registerClassVersion()
       {
-        static const auto hash = std::type_index(typeid(T)).hash_code();
-        const auto insertResult = itsVersionedTypes.insert( hash );
-        const auto lock = detail::StaticObject<detail::Versions>::lock();
-        const auto version =
-          detail::StaticObject<detail::Versions>::getInstance().find( hash, detail::Version<T>::version );
+        const auto & type = detail::versionedType<T>();
 
-        if( insertResult.second ) // insertion took place, serialize the version number
-          process( make_nvp<ArchiveType>("cereal_class_version", version) );
+        if( type.slot >= itsVersionedTypes.size() )
+          itsVersionedTypes.resize( type.slot + 1, false );
 
-        return version;
+        if( !itsVersionedTypes[type.slot] ) // first time, serialize the version number
+        {
+          itsVersionedTypes[type.slot] = true;
+          process( make_nvp<ArchiveType>("cereal_class_version", type.version) );
+        }
+
+        return type.version;
       }
 
       //! Member serialization
@@ -670,7 +757,7 @@ namespace cereal
       std::unordered_set<traits::detail::base_class_id, traits::detail::base_class_id_hash> itsBaseClassSet;
 
       //! Maps from addresses to pointer ids
-      std::unordered_map<void const *, std::uint32_t> itsSharedPointerMap;
+      detail::PointerMap<std::uint32_t> itsSharedPointerMap;
 
       //! Copy of shared pointers used in #itsSharedPointerMap to make sure they are kept alive
       //  during lifetime of itsSharedPointerMap to prevent CVE-2020-11105.
@@ -680,13 +767,16 @@ namespace cereal
       std::uint32_t itsCurrentPointerId;
 
       //! Maps from polymorphic type name strings to ids
-      std::unordered_map<char const *, std::uint32_t> itsPolymorphicTypeMap;
+      detail::PointerMap<std::uint32_t> itsPolymorphicTypeMap;
 
       //! The id to be given to the next polymorphic type name
       std::uint32_t itsCurrentPolymorphicTypeId;
 
-      //! Keeps track of classes that have versioning information associated with them
-      std::unordered_set<size_type> itsVersionedTypes;
+      //! Maps from the type_info of polymorphic types to their output bindings
+      detail::PointerMap<void const *> itsPolymorphicBindings;
+
+      //! Keeps track of classes that have versioning information associated with them, indexed by detail::VersionedType::slot
+      std::vector<bool> itsVersionedTypes;
   }; // class OutputArchive
 
   // ######################################################################
@@ -782,6 +872,33 @@ namespace cereal
 
       //! @}
 
+      #ifdef CEREAL_HAS_MEMORY_RESOURCE
+      //! Sets the memory resource that pointers loaded by this archive allocate from
+      /*! Objects held by std::shared_ptr, and their control blocks, are allocated from
+          this resource instead of with new.  Allocator aware objects, such as the
+          std::pmr containers, are also constructed with a std::pmr::polymorphic_allocator
+          using it, so that their contents come from the same resource.
+
+          The archive does not own the resource: loaded objects usually outlive the
+          archive, so the resource must outlive them instead.  A nullptr, the default,
+          allocates as usual.
+
+          Containers loaded directly keep the allocator they were constructed with;
+          construct std::pmr containers with the resource to have them use it.
+
+          @param resource The resource to allocate from, or nullptr */
+      void setMemoryResource( std::pmr::memory_resource * resource )
+      {
+        itsMemoryResource = resource;
+      }
+
+      //! Returns the memory resource set with setMemoryResource, or nullptr if there is none
+      std::pmr::memory_resource * getMemoryResource() const
+      {
+        return itsMemoryResource;
+      }
+      #endif // CEREAL_HAS_MEMORY_RESOURCE
+
       //! Retrieves a shared pointer given a unique key for it
       /*! This is used to retrieve a previously registered shared_ptr
           which has already been loaded.
@@ -794,11 +911,14 @@ namespace cereal
       {
         if(id == 0) return std::shared_ptr<void>(nullptr);
 
-        auto iter = itsSharedPointerMap.find( id );
-        if(iter == itsSharedPointerMap.end())
+        if(id < itsSharedPointerMap.size() && itsSharedPointerMap[id])
+          return itsSharedPointerMap[id];
+
+        auto const ptr = itsSparseSharedPointerMap.find(id);
+        if(ptr == itsSparseSharedPointerMap.end() || !ptr->second)
           throw Exception("Error while trying to deserialize a smart pointer. Could not find id " + std::to_string(id));
 
-        return iter->second;
+        return ptr->second;
       }
 
       //! Registers a shared pointer to its unique identifier
@@ -811,7 +931,11 @@ namespace cereal
       inline void registerSharedPointer(std::uint32_t const id, std::shared_ptr<void> ptr)
       {
         std::uint32_t const stripped_id = id & ~detail::msb_32bit;
-        itsSharedPointerMap[stripped_id] = ptr;
+
+        if(auto slot = sequentialSlot(itsSharedPointerMap, stripped_id))
+          *slot = std::move(ptr);
+        else
+          itsSparseSharedPointerMap[stripped_id] = std::move(ptr);
       }
 
       //! Retrieves the string for a polymorphic type given a unique key for it
@@ -821,14 +945,22 @@ namespace cereal
           @internal
           @param id The unique id that was serialized for the polymorphic type
           @return The string identifier for the tyep */
-      inline std::string getPolymorphicName(std::uint32_t const id)
+      inline std::string const & getPolymorphicName(std::uint32_t const id)
       {
-        auto name = itsPolymorphicTypeMap.find( id );
-        if(name == itsPolymorphicTypeMap.end())
-        {
-          throw Exception("Error while trying to deserialize a polymorphic pointer. Could not find type id " + std::to_string(id));
-        }
-        return name->second;
+        return getPolymorphicType(id).name;
+      }
+
+      //! Retrieves the polymorphic binding for a polymorphic type given a unique key for it
+      /*! This lets polymorphic loads skip looking up the binding map for types
+          that have already been loaded with this archive.
+
+          @internal
+          @param id The unique id that was serialized for the polymorphic type
+          @return The binding given to registerPolymorphicName for the type
+          @throw Exception if the id does not exist */
+      inline void const * getPolymorphicBinding(std::uint32_t const id)
+      {
+        return getPolymorphicType(id).binding;
       }
 
       //! Registers a polymorphic name string to its unique identifier
@@ -837,11 +969,33 @@ namespace cereal
 
           @internal
           @param id The unique identifier for the polymorphic type
-          @param name The name associated with the tyep */
-      inline void registerPolymorphicName(std::uint32_t const id, std::string const & name)
+          @param name The name associated with the tyep
+          @param binding The input binding map entry for the type */
+      inline void registerPolymorphicName(std::uint32_t const id, std::string const & name, void const * binding)
       {
         std::uint32_t const stripped_id = id & ~detail::msb_32bit;
-        itsPolymorphicTypeMap.insert( {stripped_id, name} );
+        auto slot = sequentialSlot(itsPolymorphicTypeMap, stripped_id);
+
+        auto & type = slot ? *slot : itsSparsePolymorphicTypeMap[stripped_id];
+        if(type.binding == nullptr)
+        {
+          type.name = name;
+          type.binding = binding;
+        }
+      }
+
+    protected:
+      //! Forgets the shared pointers, polymorphic types and class versions that have been loaded
+      /*! Called at the points where the output archive called OutputArchive::resetTracking, this
+          allows data saved after that point to be loaded without loading what came before it. */
+      void resetTracking()
+      {
+        itsBaseClassSet.clear();
+        itsSharedPointerMap.clear();
+        itsSparseSharedPointerMap.clear();
+        itsPolymorphicTypeMap.clear();
+        itsSparsePolymorphicTypeMap.clear();
+        itsVersionedTypes.clear();
       }
 
     private:
@@ -849,6 +1003,7 @@ namespace cereal
       template <class T> inline
       void process( T && head )
       {
+        CEREAL_PROFILE_SCOPE( T );
         prologue( *self, head );
         self->processImpl( head );
         epilogue( *self, head );
@@ -1013,17 +1168,19 @@ namespace cereal
       template <class T> inline
       std::uint32_t loadClassVersion()
       {
-        static const auto hash = std::type_index(typeid(T)).hash_code();
-        auto lookupResult = itsVersionedTypes.find( hash );
+        const auto slot = detail::versionedType<T>().slot;
 
-        if( lookupResult != itsVersionedTypes.end() ) // already exists
-          return lookupResult->second;
+        if( slot < itsVersionedTypes.size() && itsVersionedTypes[slot] >= 0 ) // already exists
+          return static_cast<std::uint32_t>( itsVersionedTypes[slot] );
         else // need to load
         {
           std::uint32_t version;
 
           process( make_nvp<ArchiveType>("cereal_class_version", version) );
-          itsVersionedTypes.emplace_hint( lookupResult, hash, version );
+
+          if( slot >= itsVersionedTypes.size() )
+            itsVersionedTypes.resize( slot + 1, -1 );
+          itsVersionedTypes[slot] = version;
 
           return version;
         }
@@ -1103,14 +1260,62 @@ namespace cereal
       //! A set of all base classes that have been serialized
       std::unordered_set<traits::detail::base_class_id, traits::detail::base_class_id_hash> itsBaseClassSet;
 
-      //! Maps from pointer ids to metadata
-      std::unordered_map<std::uint32_t, std::shared_ptr<void>> itsSharedPointerMap;
+      //! Loaded shared pointers, indexed by pointer id
+      std::vector<std::shared_ptr<void>> itsSharedPointerMap;
+
+      //! Loaded shared pointers whose ids did not follow those before them, see sequentialSlot
+      std::unordered_map<std::uint32_t, std::shared_ptr<void>> itsSparseSharedPointerMap;
+
+      //! A polymorphic type that has been loaded
+      struct PolymorphicType
+      {
+        std::string name;
+        void const * binding; //!< The input binding map entry for the type, null until the type is loaded
+      };
+
+      //! Loaded polymorphic types, indexed by name id
+      std::vector<PolymorphicType> itsPolymorphicTypeMap;
+
+      //! Loaded polymorphic types whose ids did not follow those before them, see sequentialSlot
+      std::unordered_map<std::uint32_t, PolymorphicType> itsSparsePolymorphicTypeMap;
+
+      PolymorphicType const & getPolymorphicType(std::uint32_t const id) const
+      {
+        if(id < itsPolymorphicTypeMap.size() && itsPolymorphicTypeMap[id].binding != nullptr)
+          return itsPolymorphicTypeMap[id];
+
+        auto const type = itsSparsePolymorphicTypeMap.find(id);
+        if(type == itsSparsePolymorphicTypeMap.end() || type->second.binding == nullptr)
+        {
+          throw Exception("Error while trying to deserialize a polymorphic pointer. Could not find type id " + std::to_string(id));
+        }
+        return type->second;
+      }
+
+      //! Returns the entry of the table for id, growing it by one if id is the next id, or null otherwise
+      /*! Output archives give out ids sequentially from 1, so the tables stay dense.  Archives that
+          search for names may load ids out of order, and corrupt input may hold any id, so those
+          go to a sparse map instead of growing the table to the size of the id. */
+      template <class T> static
+      T * sequentialSlot(std::vector<T> & table, std::uint32_t const id)
+      {
+        if(id >= table.size())
+        {
+          std::size_t const next = table.empty() ? 1 : table.size();
+          if(id > next)
+            return nullptr;
+          table.resize(id + 1);
+        }
+        return &table[id];
+      }
 
-      //! Maps from name ids to names
-      std::unordered_map<std::uint32_t, std::string> itsPolymorphicTypeMap;
+      //! Version numbers indexed by detail::VersionedType::slot, or -1 for classes not yet loaded
+      std::vector<std::int64_t> itsVersionedTypes;
 
-      //! Maps from type hash codes to version numbers
-      std::unordered_map<std::size_t, std::uint32_t> itsVersionedTypes;
+      #ifdef CEREAL_HAS_MEMORY_RESOURCE
+      //! The resource loaded pointers allocate from, see setMemoryResource
+      std::pmr::memory_resource * itsMemoryResource = nullptr;
+      #endif // CEREAL_HAS_MEMORY_RESOURCE
   }; // class InputArchive
 } // namespace cereal
 
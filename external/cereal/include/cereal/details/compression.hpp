@@ -0,0 +1,886 @@
+/*! \file compression.hpp
+    \brief Block compression for the binary archives
+    \ingroup Internal */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_DETAILS_COMPRESSION_HPP_
+#define CEREAL_DETAILS_COMPRESSION_HPP_
+
+#include "cereal/macros.hpp"
+#include "cereal/details/helpers.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <ios>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+//! Define CEREAL_USE_ZLIB, and link zlib, to make ZlibCodec available
+#ifdef CEREAL_USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace cereal
+{
+  // ######################################################################
+  //! A codec compressing the blocks of a compressed binary archive
+  /*! Each block is compressed on its own, and blocks are compressed on several threads
+      sharing one codec, so the functions of a codec must be safe to call concurrently.
+
+      The id of the codec is stored with every block it compressed and checked when the
+      block is loaded.  The codecs shipped with cereal use ids below 128; other codecs
+      should use ids from 128 to 255. */
+  class Codec
+  {
+    public:
+      virtual ~Codec() = default;
+
+      //! Returns the id stored with the blocks this codec compressed, which is never 0
+      virtual std::uint8_t id() const = 0;
+
+      //! Returns the largest size compress can produce from size bytes
+      virtual std::size_t maxCompressedSize( std::size_t size ) const = 0;
+
+      //! Compresses size bytes from src into dst, which has room for maxCompressedSize( size ) bytes
+      /*! @return The number of bytes written to dst */
+      virtual std::size_t compress( const char * src, std::size_t size, char * dst ) const = 0;
+
+      //! Decompresses size bytes from src into exactly decompressedSize bytes at dst
+      /*! @throw Exception if the data is corrupt */
+      virtual void decompress( const char * src, std::size_t size, char * dst, std::size_t decompressedSize ) const = 0;
+  };
+
+  // ######################################################################
+  //! A fast LZ77 codec in the style of LZ4, shipped with cereal
+  /*! Matches of at least four bytes are found within the last 64 KiB with a single
+      hash table probe per position, and searching speeds up through data that does not
+      compress.  This favors speed over ratio: expect output noticeably larger than
+      zlib's, produced several times faster.
+
+      A compressed block is a list of sequences.  Each starts with a token byte holding
+      the number of literals in its high four bits and the match length minus four in its
+      low four bits, where 15 means the value continues in the following bytes, which are
+      added up to and including the first byte that is not 255.  The literals follow, then
+      the distance back to the match as two little endian bytes.  The last sequence ends
+      after its literals. */
+  class LZCodec : public Codec
+  {
+    public:
+      std::uint8_t id() const override
+      { return 1; }
+
+      std::size_t maxCompressedSize( std::size_t size ) const override
+      { return size + size / 255 + 16; }
+
+      std::size_t compress( const char * src, std::size_t size, char * dst ) const override
+      {
+        auto const in = reinterpret_cast<const std::uint8_t *>( src );
+        auto const end = in + size;
+        auto out = reinterpret_cast<std::uint8_t *>( dst );
+
+        std::uint32_t table[hashSize];
+        std::fill( table, table + hashSize, std::uint32_t( 0 ) );
+
+        auto anchor = in;
+        auto pos = in;
+        std::size_t misses = 0;
+        while( end - pos >= minMatch )
+        {
+          auto const sequence = read32( pos );
+          auto & entry = table[hash( sequence )];
+          auto const candidate = in + entry;
+          entry = static_cast<std::uint32_t>( pos - in );
+
+          if( candidate < pos && pos - candidate <= maxOffset && read32( candidate ) == sequence )
+          {
+            auto const length = minMatch + matchLength( candidate + minMatch, pos + minMatch, end );
+            out = writeSequence( out, anchor, static_cast<std::size_t>( pos - anchor ), static_cast<std::size_t>( pos - candidate ), length );
+            pos += length;
+            anchor = pos;
+            misses = 0;
+          }
+          else
+          {
+            // step further the longer nothing matched
+            auto const step = static_cast<std::ptrdiff_t>( 1 + ( misses++ >> 6 ) );
+            if( end - pos <= step )
+              break;
+            pos += step;
+          }
+        }
+
+        out = writeLiterals( out, anchor, static_cast<std::size_t>( end - anchor ) );
+        return static_cast<std::size_t>( out - reinterpret_cast<std::uint8_t *>( dst ) );
+      }
+
+      void decompress( const char * src, std::size_t size, char * dst, std::size_t decompressedSize ) const override
+      {
+        auto in = reinterpret_cast<const std::uint8_t *>( src );
+        auto const inEnd = in + size;
+        auto const outBegin = reinterpret_cast<std::uint8_t *>( dst );
+        auto const outEnd = outBegin + decompressedSize;
+        auto out = outBegin;
+
+        while( true )
+        {
+          if( in == inEnd )
+            corrupt();
+
+          auto const token = *in++;
+
+          std::size_t literals = token >> 4;
+          if( literals == 15 )
+            literals += readLength( in, inEnd );
+          if( literals > static_cast<std::size_t>( inEnd - in ) || literals > static_cast<std::size_t>( outEnd - out ) )
+            corrupt();
+
+          std::memcpy( out, in, literals );
+          in += literals;
+          out += literals;
+
+          if( in == inEnd )
+            break;
+
+          if( inEnd - in < 2 )
+            corrupt();
+          std::size_t const offset = static_cast<std::size_t>( in[0] ) | ( static_cast<std::size_t>( in[1] ) << 8 );
+          in += 2;
+
+          std::size_t length = ( token & 15 ) + minMatch;
+          if( ( token & 15 ) == 15 )
+            length += readLength( in, inEnd );
+          if( offset == 0 || offset > static_cast<std::size_t>( out - outBegin ) || length > static_cast<std::size_t>( outEnd - out ) )
+            corrupt();
+
+          auto match = out - offset;
+          if( offset >= length )
+          {
+            std::memcpy( out, match, length );
+            out += length;
+          }
+          else // the match overlaps the bytes it produces, repeating the last offset bytes
+            for( ; length > 0; --length )
+              *out++ = *match++;
+        }
+
+        if( out != outEnd )
+          corrupt();
+      }
+
+    private:
+      static const std::ptrdiff_t minMatch = 4;
+      static const std::ptrdiff_t maxOffset = 65535;
+      static const std::size_t hashBits = 14;
+      static const std::size_t hashSize = std::size_t( 1 ) << hashBits;
+
+      static std::uint32_t read32( const std::uint8_t * p )
+      {
+        std::uint32_t value;
+        std::memcpy( &value, p, sizeof(value) );
+        return value;
+      }
+
+      static std::size_t hash( std::uint32_t sequence )
+      {
+        return static_cast<std::size_t>( ( sequence * 2654435761u ) >> ( 32 - hashBits ) );
+      }
+
+      //! Returns the number of bytes at pos, up to end, that equal those at match
+      static std::size_t matchLength( const std::uint8_t * match, const std::uint8_t * pos, const std::uint8_t * end )
+      {
+        auto const start = pos;
+
+        while( end - pos >= 8 )
+        {
+          std::uint64_t a, b;
+          std::memcpy( &a, match, sizeof(a) );
+          std::memcpy( &b, pos, sizeof(b) );
+          if( a != b )
+            break;
+
+          match += 8;
+          pos += 8;
+        }
+
+        while( pos < end && *pos == *match )
+        {
+          ++match;
+          ++pos;
+        }
+
+        return static_cast<std::size_t>( pos - start );
+      }
+
+      static std::uint8_t * writeLength( std::uint8_t * out, std::size_t value )
+      {
+        for( ; value >= 255; value -= 255 )
+          *out++ = 255;
+        *out++ = static_cast<std::uint8_t>( value );
+        return out;
+      }
+
+      static std::uint8_t * writeLiterals( std::uint8_t * out, const std::uint8_t * literals, std::size_t count, std::uint8_t matchCode = 0 )
+      {
+        *out++ = static_cast<std::uint8_t>( ( std::min<std::size_t>( count, 15 ) << 4 ) | matchCode );
+        if( count >= 15 )
+          out = writeLength( out, count - 15 );
+
+        std::memcpy( out, literals, count );
+        return out + count;
+      }
+
+      static std::uint8_t * writeSequence( std::uint8_t * out, const std::uint8_t * literals, std::size_t count, std::size_t offset, std::size_t length )
+      {
+        auto const matchCode = length - minMatch;
+
+        out = writeLiterals( out, literals, count, static_cast<std::uint8_t>( std::min<std::size_t>( matchCode, 15 ) ) );
+        *out++ = static_cast<std::uint8_t>( offset & 0xff );
+        *out++ = static_cast<std::uint8_t>( offset >> 8 );
+        if( matchCode >= 15 )
+          out = writeLength( out, matchCode - 15 );
+
+        return out;
+      }
+
+      static std::size_t readLength( const std::uint8_t * & in, const std::uint8_t * end )
+      {
+        std::size_t value = 0;
+        std::uint8_t byte;
+        do
+        {
+          if( in == end )
+            corrupt();
+          byte = *in++;
+          value += byte;
+        } while( byte == 255 );
+
+        return value;
+      }
+
+      [[noreturn]] static void corrupt()
+      {
+        throw Exception("LZ compressed block is corrupt");
+      }
+  };
+
+  #ifdef CEREAL_USE_ZLIB
+  // ######################################################################
+  //! A codec using zlib, which compresses better and more slowly than LZCodec
+  /*! Available when CEREAL_USE_ZLIB is defined, in which case the program must link zlib. */
+  class ZlibCodec : public Codec
+  {
+    public:
+      //! @param level The zlib compression level, from 1 (fastest) to 9 (smallest)
+      explicit ZlibCodec( int level = Z_DEFAULT_COMPRESSION ) : itsLevel( level ) {}
+
+      std::uint8_t id() const override
+      { return 2; }
+
+      std::size_t maxCompressedSize( std::size_t size ) const override
+      { return static_cast<std::size_t>( compressBound( static_cast<uLong>( size ) ) ); }
+
+      std::size_t compress( const char * src, std::size_t size, char * dst ) const override
+      {
+        auto dstSize = compressBound( static_cast<uLong>( size ) );
+        if( compress2( reinterpret_cast<Bytef *>( dst ), &dstSize, reinterpret_cast<const Bytef *>( src ), static_cast<uLong>( size ), itsLevel ) != Z_OK )
+          throw Exception("zlib failed to compress a block");
+
+        return static_cast<std::size_t>( dstSize );
+      }
+
+      void decompress( const char * src, std::size_t size, char * dst, std::size_t decompressedSize ) const override
+      {
+        auto dstSize = static_cast<uLongf>( decompressedSize );
+        if( uncompress( reinterpret_cast<Bytef *>( dst ), &dstSize, reinterpret_cast<const Bytef *>( src ), static_cast<uLong>( size ) ) != Z_OK ||
+            dstSize != decompressedSize )
+          throw Exception("zlib compressed block is corrupt");
+      }
+
+    private:
+      int itsLevel;
+  };
+  #endif // CEREAL_USE_ZLIB
+
+  namespace compression_detail
+  {
+    //! The default size of the blocks data is compressed in
+    static const std::size_t defaultBlockSize = 256 * 1024;
+    //! The largest size of the blocks data is compressed in
+    static const std::size_t maxBlockSize = 64 * 1024 * 1024;
+  }
+
+  // ######################################################################
+  //! Selects how a binary archive compresses its data
+  /*! Pass one to BinaryOutputArchive or PortableBinaryOutputArchive, and one with the same
+      codec to the matching input archive:
+
+      @code{.cpp}
+      {
+        std::ofstream os( "snapshot.bin", std::ios::binary );
+        cereal::BinaryOutputArchive ar( os, cereal::Compression::LZ() );
+        ar( snapshot );
+      } // the last block is written when the archive is destroyed
+
+      std::ifstream is( "snapshot.bin", std::ios::binary );
+      cereal::BinaryInputArchive ar( is, cereal::Compression::LZ() );
+      ar( snapshot );
+      @endcode
+
+      The archive collects its output in blocks of blockSize bytes.  Full blocks are compressed
+      on a pool of threads while the archive serializes the next ones, and written to the stream
+      in order, each preceded by its size and the id of its codec.  Blocks that do not get smaller
+      are written as they are.  Loading reads blocks ahead and decompresses them on a pool of
+      threads in the same way.
+
+      The blocks end with a marker, so an input archive stops reading where its compressed data
+      ends.  If writing the last blocks fails when the output archive is destroyed, the badbit of
+      the stream is set. */
+  class Compression
+  {
+    public:
+      //! No compression
+      static Compression None()
+      { return Compression(); }
+
+      //! Compression with the built in LZCodec
+      /*! @param threads The number of threads to use, or 0 for one per hardware thread */
+      static Compression LZ( std::size_t threads = 0 )
+      { return Compression( std::make_shared<LZCodec>(), compression_detail::defaultBlockSize, threads ); }
+
+      #ifdef CEREAL_USE_ZLIB
+      //! Compression with ZlibCodec
+      /*! @param level The zlib compression level, from 1 (fastest) to 9 (smallest)
+          @param threads The number of threads to use, or 0 for one per hardware thread */
+      static Compression Zlib( int level = Z_DEFAULT_COMPRESSION, std::size_t threads = 0 )
+      { return Compression( std::make_shared<ZlibCodec>( level ), compression_detail::defaultBlockSize, threads ); }
+      #endif // CEREAL_USE_ZLIB
+
+      //! Specify the codec, block size and threads to use
+      /*! @param c The codec, or nullptr for no compression
+          @param bs The size of a block, up to 64 MiB.  Larger blocks compress better and use
+                    more memory: the archive holds a few blocks per thread.
+          @param t The number of threads to use, including the thread using the archive, or 0 for
+                   one per hardware thread */
+      explicit Compression( std::shared_ptr<Codec const> c = nullptr,
+                            std::size_t bs = compression_detail::defaultBlockSize,
+                            std::size_t t = 0 ) :
+        codec( std::move( c ) ), blockSize( bs ), threads( t ) {}
+
+      std::shared_ptr<Codec const> codec;
+      std::size_t blockSize;
+      std::size_t threads;
+  };
+
+  namespace compression_detail
+  {
+    //! The bytes compressed data starts with, the last one being the version of the format
+    static const char header[5] = { 'C', 'R', 'L', 'B', 1 };
+
+    //! The size of the header of a block: its size, its size as stored (4 little endian bytes each) and the id of its codec
+    static const std::size_t blockHeaderSize = 9;
+
+    inline void write32( char * p, std::uint32_t value )
+    {
+      for( int i = 0; i < 4; ++i )
+        p[i] = static_cast<char>( ( value >> ( 8 * i ) ) & 0xff );
+    }
+
+    inline std::uint32_t read32( const char * p )
+    {
+      std::uint32_t value = 0;
+      for( int i = 0; i < 4; ++i )
+        value |= static_cast<std::uint32_t>( static_cast<std::uint8_t>( p[i] ) ) << ( 8 * i );
+      return value;
+    }
+
+    //! Returns the number of threads to use, resolving 0 to one per hardware thread
+    inline std::size_t threadCount( std::size_t threads )
+    {
+      return threads == 0 ? std::max( 1u, std::thread::hardware_concurrency() ) : threads;
+    }
+
+    //! Returns the number of blocks to have compressed or decompressed ahead of the archive
+    /*! Two per thread keep the workers busy.  Without workers, blocks are processed as soon
+        as they are submitted, so there is no point in holding more than one. */
+    inline std::size_t maxPending( std::size_t threads )
+    {
+      return threadCount( threads ) == 1 ? 1 : 2 * threadCount( threads );
+    }
+
+    //! Checks that a block size can be used
+    inline std::size_t checkBlockSize( std::size_t size )
+    {
+      if( size == 0 || size > maxBlockSize )
+        throw Exception("Compression block size must be between 1 byte and " + std::to_string( maxBlockSize ) + " bytes");
+      return size;
+    }
+
+    //! A block of data on its way between an archive and its stream
+    struct Block
+    {
+      std::vector<char> raw;      //!< The uncompressed data
+      std::size_t rawSize = 0;
+      std::vector<char> stored;   //!< The data as stored, after the block header when saving
+      std::size_t storedSize = 0;
+      bool done = true;           //!< Whether the worker processing the block has finished
+      std::exception_ptr error;   //!< The exception thrown while processing the block, if any
+    };
+
+    //! Threads processing blocks in the order they were submitted
+    /*! With no threads, blocks are processed by the thread submitting them.  So is the first
+        block, and the threads are only started when a second one is submitted, so that archives
+        holding a single block do not pay for starting and joining them. */
+    class Workers
+    {
+      public:
+        Workers( std::size_t threads, std::function<void( Block & )> job ) :
+          itsJob( std::move( job ) ), itsThreadCount( threads ), itsSubmitted( false ), itsStop( false )
+        { }
+
+        ~Workers()
+        {
+          {
+            std::lock_guard<std::mutex> lock( itsMutex );
+            itsStop = true;
+          }
+          itsWork.notify_all();
+
+          for( auto & thread : itsThreads )
+            thread.join();
+        }
+
+        //! Queues a block for processing
+        void submit( Block & block )
+        {
+          block.error = nullptr;
+
+          if( itsThreads.empty() )
+          {
+            if( itsThreadCount == 0 || !itsSubmitted )
+            {
+              itsSubmitted = true;
+              return process( block );
+            }
+
+            for( std::size_t i = 0; i < itsThreadCount; ++i )
+              itsThreads.emplace_back( [this]() { run(); } );
+          }
+
+          {
+            std::lock_guard<std::mutex> lock( itsMutex );
+            block.done = false;
+            itsQueue.push_back( &block );
+          }
+          itsWork.notify_one();
+        }
+
+        //! Waits for a block to be processed, rethrowing what processing it threw
+        void wait( Block & block )
+        {
+          {
+            std::unique_lock<std::mutex> lock( itsMutex );
+            itsDone.wait( lock, [&]() { return block.done; } );
+          }
+
+          if( block.error )
+            std::rethrow_exception( block.error );
+        }
+
+      private:
+        void process( Block & block )
+        {
+          try
+          {
+            itsJob( block );
+          }
+          catch( ... )
+          {
+            block.error = std::current_exception();
+          }
+        }
+
+        void run()
+        {
+          while( true )
+          {
+            Block * block;
+            {
+              std::unique_lock<std::mutex> lock( itsMutex );
+              itsWork.wait( lock, [this]() { return itsStop || !itsQueue.empty(); } );
+              if( itsStop )
+                return;
+
+              block = itsQueue.front();
+              itsQueue.pop_front();
+            }
+
+            process( *block );
+
+            {
+              std::lock_guard<std::mutex> lock( itsMutex );
+              block->done = true;
+            }
+            itsDone.notify_all();
+          }
+        }
+
+        std::function<void( Block & )> itsJob;
+        std::size_t itsThreadCount; //!< The number of threads to start
+        bool itsSubmitted;          //!< Whether a block has been submitted
+        std::mutex itsMutex;
+        std::condition_variable itsWork;
+        std::condition_variable itsDone;
+        std::deque<Block *> itsQueue;
+        bool itsStop;
+        std::vector<std::thread> itsThreads;
+    };
+
+    //! Owns the blocks of a compressed stream and recycles them
+    class BlockPool
+    {
+      public:
+        Block & acquire()
+        {
+          if( itsFree.empty() )
+          {
+            itsBlocks.emplace_back( new Block() );
+            return *itsBlocks.back();
+          }
+
+          auto & block = *itsFree.back();
+          itsFree.pop_back();
+
+          block.done = true;
+          block.error = nullptr;
+          return block;
+        }
+
+        void release( Block & block )
+        {
+          itsFree.push_back( &block );
+        }
+
+      private:
+        std::vector<std::unique_ptr<Block>> itsBlocks;
+        std::vector<Block *> itsFree;
+    };
+
+    // ######################################################################
+    //! A stream buffer that compresses what is written to it in blocks, writing them to another stream buffer
+    /*! Writes go straight into the current block, so the other stream buffer is called once per
+        block rather than once per write. */
+    class OutputBuffer : public std::streambuf
+    {
+      public:
+        OutputBuffer( std::streambuf & sink, Compression const & compression ) :
+          itsSink( sink ),
+          itsCodec( compression.codec ),
+          itsBlockSize( checkBlockSize( compression.blockSize ) ),
+          itsMaxPending( maxPending( compression.threads ) ),
+          itsCurrent( nullptr ),
+          itsFinished( false ),
+          itsWorkers( threadCount( compression.threads ) - 1, [this]( Block & block ) { compressBlock( block ); } )
+        {
+          write( header, sizeof(header) );
+          startBlock();
+        }
+
+        //! Writes the current block, waits for the blocks being compressed and writes the end marker
+        /*! Does nothing after the first call.
+            @throw Exception if a block could not be compressed or written */
+        void finish()
+        {
+          if( itsFinished )
+            return;
+          itsFinished = true;
+
+          submitBlock();
+          while( !itsPending.empty() )
+            writeBlock();
+
+          char end[blockHeaderSize] = {};
+          write( end, sizeof(end) );
+        }
+
+      protected:
+        int_type overflow( int_type c ) override
+        {
+          if( itsFinished )
+            return traits_type::eof();
+
+          submitBlock();
+          startBlock();
+
+          if( !traits_type::eq_int_type( c, traits_type::eof() ) )
+            return sputc( traits_type::to_char_type( c ) );
+
+          return traits_type::not_eof( c );
+        }
+
+      private:
+        void write( const char * data, std::size_t size )
+        {
+          auto const written = itsSink.sputn( data, static_cast<std::streamsize>( size ) );
+          if( written != static_cast<std::streamsize>( size ) )
+            throw Exception("Failed to write " + std::to_string(size) + " bytes of compressed data to output stream! Wrote " + std::to_string(written));
+        }
+
+        void startBlock()
+        {
+          itsCurrent = &itsPool.acquire();
+          itsCurrent->raw.resize( itsBlockSize );
+          setp( itsCurrent->raw.data(), itsCurrent->raw.data() + itsBlockSize );
+        }
+
+        //! Hands the current block to the workers, first writing out blocks if too many are pending
+        void submitBlock()
+        {
+          auto & block = *itsCurrent;
+          block.rawSize = static_cast<std::size_t>( pptr() - pbase() );
+          setp( nullptr, nullptr );
+          itsCurrent = nullptr;
+
+          if( block.rawSize == 0 )
+            return itsPool.release( block );
+
+          while( itsPending.size() >= itsMaxPending )
+            writeBlock();
+
+          itsPending.push_back( &block );
+          itsWorkers.submit( block );
+        }
+
+        //! Waits for the oldest pending block to be compressed and writes it
+        void writeBlock()
+        {
+          auto & block = *itsPending.front();
+          itsPending.pop_front();
+
+          itsWorkers.wait( block );
+          write( block.stored.data(), block.storedSize );
+          itsPool.release( block );
+        }
+
+        //! Compresses a block into its stored data, after the block header
+        void compressBlock( Block & block ) const
+        {
+          auto const bound = std::max( itsCodec->maxCompressedSize( block.rawSize ), block.rawSize );
+          if( block.stored.size() < blockHeaderSize + bound )
+            block.stored.resize( blockHeaderSize + bound );
+
+          auto const data = block.stored.data() + blockHeaderSize;
+          auto size = itsCodec->compress( block.raw.data(), block.rawSize, data );
+          auto codec = itsCodec->id();
+
+          if( size >= block.rawSize )
+          {
+            std::memcpy( data, block.raw.data(), block.rawSize );
+            size = block.rawSize;
+            codec = 0;
+          }
+
+          write32( block.stored.data(), static_cast<std::uint32_t>( block.rawSize ) );
+          write32( block.stored.data() + 4, static_cast<std::uint32_t>( size ) );
+          block.stored[8] = static_cast<char>( codec );
+          block.storedSize = blockHeaderSize + size;
+        }
+
+        std::streambuf & itsSink;
+        std::shared_ptr<Codec const> itsCodec;
+        std::size_t itsBlockSize;
+        std::size_t itsMaxPending;
+        BlockPool itsPool;
+        Block * itsCurrent;
+        std::deque<Block *> itsPending;
+        bool itsFinished;
+        Workers itsWorkers; //!< Declared last, so that its threads stop before the blocks they use are destroyed
+    };
+
+    // ######################################################################
+    //! A stream buffer that reads blocks written by OutputBuffer from another stream buffer, decompressing them
+    /*! Reads are served from the current block.  The other stream buffer is read up to the end
+        marker of the blocks and no further. */
+    class InputBuffer : public std::streambuf
+    {
+      public:
+        InputBuffer( std::streambuf & source, Compression const & compression ) :
+          itsSource( source ),
+          itsCodec( compression.codec ),
+          itsMaxPending( maxPending( compression.threads ) ),
+          itsCurrent( nullptr ),
+          itsEnded( false ),
+          itsWorkers( threadCount( compression.threads ) - 1, [this]( Block & block ) { decompressBlock( block ); } )
+        {
+          char start[sizeof(header)];
+          if( itsSource.sgetn( start, sizeof(start) ) != static_cast<std::streamsize>( sizeof(start) ) ||
+              std::memcmp( start, header, sizeof(header) ) != 0 )
+            throw Exception("Input stream does not start with compressed data");
+        }
+
+      protected:
+        int_type underflow() override
+        {
+          if( gptr() < egptr() )
+            return traits_type::to_int_type( *gptr() );
+
+          if( itsCurrent )
+          {
+            itsPool.release( *itsCurrent );
+            itsCurrent = nullptr;
+            setg( nullptr, nullptr, nullptr );
+          }
+
+          readAhead();
+          if( itsPending.empty() )
+            return traits_type::eof();
+
+          auto & block = *itsPending.front();
+          itsPending.pop_front();
+          itsWorkers.wait( block );
+          itsCurrent = &block;
+
+          // keep the workers busy while this block is read
+          readAhead();
+
+          setg( block.raw.data(), block.raw.data(), block.raw.data() + block.rawSize );
+          return traits_type::to_int_type( *gptr() );
+        }
+
+      private:
+        void read( char * data, std::size_t size )
+        {
+          auto const readSize = itsSource.sgetn( data, static_cast<std::streamsize>( size ) );
+          if( readSize != static_cast<std::streamsize>( size ) )
+            throw Exception("Failed to read " + std::to_string(size) + " bytes of compressed data from input stream! Read " + std::to_string(readSize));
+        }
+
+        //! Reads blocks and hands them to the workers until enough are pending or the end marker is read
+        void readAhead()
+        {
+          while( !itsEnded && itsPending.size() < itsMaxPending )
+          {
+            char blockHeader[blockHeaderSize];
+            read( blockHeader, sizeof(blockHeader) );
+
+            std::size_t const rawSize = read32( blockHeader );
+            std::size_t const storedSize = read32( blockHeader + 4 );
+            auto const codec = static_cast<std::uint8_t>( blockHeader[8] );
+
+            if( rawSize == 0 )
+            {
+              itsEnded = true;
+              return;
+            }
+
+            if( codec != 0 && codec != itsCodec->id() )
+              throw Exception("Compressed block uses codec " + std::to_string(codec) + ", but the archive was given codec " + std::to_string(itsCodec->id()));
+            if( rawSize > maxBlockSize || ( codec == 0 && storedSize != rawSize ) || storedSize > itsCodec->maxCompressedSize( rawSize ) )
+              throw Exception("Compressed block header is corrupt");
+
+            auto & block = itsPool.acquire();
+            block.rawSize = rawSize;
+            block.storedSize = storedSize;
+            block.raw.resize( rawSize );
+
+            if( codec == 0 )
+              read( block.raw.data(), rawSize );
+            else
+            {
+              block.stored.resize( storedSize );
+              read( block.stored.data(), storedSize );
+              itsWorkers.submit( block );
+            }
+
+            itsPending.push_back( &block );
+          }
+        }
+
+        void decompressBlock( Block & block ) const
+        {
+          itsCodec->decompress( block.stored.data(), block.storedSize, block.raw.data(), block.rawSize );
+        }
+
+        std::streambuf & itsSource;
+        std::shared_ptr<Codec const> itsCodec;
+        std::size_t itsMaxPending;
+        BlockPool itsPool;
+        Block * itsCurrent;
+        std::deque<Block *> itsPending;
+        bool itsEnded;
+        Workers itsWorkers; //!< Declared last, so that its threads stop before the blocks they use are destroyed
+    };
+
+    //! Creates the stream buffer an output archive writes to when compressing, or nullptr without a codec
+    inline std::unique_ptr<OutputBuffer> makeOutputBuffer( std::ostream & stream, Compression const & compression )
+    {
+      if( !compression.codec )
+        return nullptr;
+      return std::unique_ptr<OutputBuffer>( new OutputBuffer( *stream.rdbuf(), compression ) );
+    }
+
+    //! Creates the stream buffer an input archive reads from when decompressing, or nullptr without a codec
+    inline std::unique_ptr<InputBuffer> makeInputBuffer( std::istream & stream, Compression const & compression )
+    {
+      if( !compression.codec )
+        return nullptr;
+      return std::unique_ptr<InputBuffer>( new InputBuffer( *stream.rdbuf(), compression ) );
+    }
+
+    //! Finishes the compressed output of an archive being destroyed, setting the badbit of its stream on failure
+    inline void finish( OutputBuffer * buffer, std::ios & stream ) CEREAL_NOEXCEPT
+    {
+      if( !buffer )
+        return;
+
+      try
+      {
+        buffer->finish();
+      }
+      catch( ... )
+      {
+        try
+        {
+          stream.setstate( std::ios::badbit );
+        }
+        catch( ... )
+        {
+        }
+      }
+    }
+  } // namespace compression_detail
+} // namespace cereal
+
+#endif // CEREAL_DETAILS_COMPRESSION_HPP_
@@ -33,9 +33,12 @@
 #include <type_traits>
 #include <cstdint>
 #include <utility>
+#include <algorithm>
+#include <vector>
 #include <memory>
 #include <unordered_map>
 #include <stdexcept>
+#include <typeindex>
 
 #include "cereal/macros.hpp"
 #include "cereal/details/static_object.hpp"
@@ -222,6 +225,15 @@ namespace cereal
     uint64_t size; //!< size in bytes
   };
 
+  namespace detail
+  {
+    //! The element type of the data referenced by a BinaryData<T>, which may point to or be a C style array
+    /*! @internal */
+    template <class T>
+    using binary_data_element = typename std::remove_cv<typename std::remove_all_extents<
+      typename std::remove_pointer<typename std::remove_reference<T>::type>::type>::type>::type;
+  } // namespace detail
+
   // ######################################################################
   //! A wrapper around data that should be serialized after all non-deferred data
   /*! This class is used to demarcate data that can only be safely serialized after
@@ -297,6 +309,110 @@ namespace cereal
     // used during saving pointers
     static const uint32_t msb_32bit  = 0x80000000;
     static const int32_t msb2_32bit = 0x40000000;
+
+    //! A map from addresses to small values, used by archives to track pointers and types
+    /*! Entries are kept in a single array that is probed linearly from the hashed address,
+        so a lookup usually touches one cache line and never allocates.  The null address
+        cannot be used as a key.
+
+        @tparam T A trivially copyable value type
+        @internal */
+    template <class T>
+    class PointerMap
+    {
+      public:
+        PointerMap() : itsSize( 0 ) {}
+
+        //! Returns the value for key, or nullptr if there is none
+        T const * find( void const * key ) const
+        {
+          if( itsEntries.empty() )
+            return nullptr;
+
+          for( auto i = index( key ); ; i = ( i + 1 ) & ( itsEntries.size() - 1 ) )
+          {
+            if( itsEntries[i].key == key )
+              return &itsEntries[i].value;
+            if( itsEntries[i].key == nullptr )
+              return nullptr;
+          }
+        }
+
+        //! Adds a value for a key that is not yet in the map
+        void insert( void const * key, T const & value )
+        {
+          // keep at least half of the entries empty so that probe sequences stay short
+          if( 2 * ( itsSize + 1 ) > itsEntries.size() )
+            rehash( itsEntries.empty() ? 16 : 2 * itsEntries.size() );
+
+          place( key, value );
+          ++itsSize;
+        }
+
+        //! Removes all entries
+        void clear()
+        {
+          if( itsSize == 0 )
+            return;
+
+          // don't keep scanning a large table if it is now being used for few entries
+          std::size_t capacity = 16;
+          while( capacity < 4 * itsSize )
+            capacity *= 2;
+
+          if( capacity < itsEntries.size() )
+            itsEntries.assign( capacity, Entry() );
+          else
+            std::fill( itsEntries.begin(), itsEntries.end(), Entry() );
+
+          itsSize = 0;
+        }
+
+        //! The number of entries
+        std::size_t size() const { return itsSize; }
+
+      private:
+        struct Entry
+        {
+          Entry() : key( nullptr ), value() {}
+          void const * key;
+          T value;
+        };
+
+        //! Returns the first entry to probe for a key
+        std::size_t index( void const * key ) const
+        {
+          // mix the bits of the address, whose low bits are often zero due to alignment
+          auto h = static_cast<std::uint64_t>( reinterpret_cast<std::uintptr_t>( key ) );
+          h ^= h >> 33;
+          h *= 0xff51afd7ed558ccdULL;
+          h ^= h >> 33;
+          return static_cast<std::size_t>( h ) & ( itsEntries.size() - 1 );
+        }
+
+        void place( void const * key, T const & value )
+        {
+          auto i = index( key );
+          while( itsEntries[i].key != nullptr )
+            i = ( i + 1 ) & ( itsEntries.size() - 1 );
+
+          itsEntries[i].key = key;
+          itsEntries[i].value = value;
+        }
+
+        void rehash( std::size_t capacity )
+        {
+          std::vector<Entry> entries( capacity );
+          itsEntries.swap( entries );
+
+          for( auto const & entry : entries )
+            if( entry.key != nullptr )
+              place( entry.key, entry.value );
+        }
+
+        std::vector<Entry> itsEntries; //!< A power of two number of entries, empty when their key is null
+        std::size_t itsSize;
+    };
   }
 
   // ######################################################################
@@ -409,13 +525,88 @@ namespace cereal
     struct Versions
     {
       std::unordered_map<std::size_t, std::uint32_t> mapping;
+      std::unordered_map<std::size_t, std::size_t> slots;
 
       std::uint32_t find( std::size_t hash, std::uint32_t version )
       {
         const auto result = mapping.emplace( hash, version );
         return result.first->second;
       }
+
+      //! Returns the index of the slot archives use to track a type, assigning the next free one on first use
+      std::size_t slot( std::size_t hash )
+      {
+        const auto result = slots.emplace( hash, slots.size() );
+        return result.first->second;
+      }
     }; // struct Versions
+
+    //! The version of a class and the slot archives use to track whether it has been serialized
+    struct VersionedType
+    {
+      std::uint32_t version;
+      std::size_t slot;
+    };
+
+    //! Returns the version and slot of a class
+    /*! These are looked up in Versions the first time this is called for a type and are
+        afterwards read without taking its lock or hashing the type.  Slots are assigned
+        by type hash, so they are shared by every translation unit and shared library.
+
+        @tparam T The type of the class
+        @internal */
+    template <class T, class BindingTag = version_binding_tag> inline
+    VersionedType const & versionedType()
+    {
+      static const VersionedType type = []()
+      {
+        const auto hash = std::type_index(typeid(T)).hash_code();
+        const auto lock = StaticObject<Versions>::lock();
+        auto & versions = StaticObject<Versions>::getInstance();
+        return VersionedType{ versions.find( hash, Version<T, BindingTag>::version ), versions.slot( hash ) };
+      }();
+
+      return type;
+    }
+
+    // ######################################################################
+    //! Creates a T that allocates with alloc, if T is allocator aware
+    /*! This follows uses-allocator construction: when std::uses_allocator is true for T,
+        alloc is passed to its constructor, either after std::allocator_arg or alone.
+        Other types are value initialized.
+
+        Containers load their elements into temporaries made this way before moving them
+        in, so that elements of containers with a stateful allocator, such as the
+        std::pmr containers, allocate from the container's memory rather than from the
+        default heap.  With std::allocator this is the same as default construction.
+
+        @internal */
+    template <class T, class Alloc> inline
+    typename std::enable_if<std::uses_allocator<T, Alloc>::value &&
+                            std::is_constructible<T, std::allocator_arg_t, Alloc const &>::value, T>::type
+    makeWithAllocator( Alloc const & alloc )
+    {
+      return T( std::allocator_arg, alloc );
+    }
+
+    //! Creates a T that allocates with alloc, for types taking the allocator as their only argument
+    /*! @internal */
+    template <class T, class Alloc> inline
+    typename std::enable_if<std::uses_allocator<T, Alloc>::value &&
+                            !std::is_constructible<T, std::allocator_arg_t, Alloc const &>::value, T>::type
+    makeWithAllocator( Alloc const & alloc )
+    {
+      return T( alloc );
+    }
+
+    //! Creates a T that is not allocator aware
+    /*! @internal */
+    template <class T, class Alloc> inline
+    typename std::enable_if<!std::uses_allocator<T, Alloc>::value, T>::type
+    makeWithAllocator( Alloc const & )
+    {
+      return T();
+    }
   } // namespace detail
 } // namespace cereal
 
@@ -49,6 +49,7 @@
 #include "cereal/details/static_object.hpp"
 #include "cereal/types/memory.hpp"
 #include "cereal/types/string.hpp"
+#include <atomic>
 #include <functional>
 #include <typeindex>
 #include <map>
@@ -197,11 +198,39 @@ namespace cereal
         return derivedIter->second;
       }
 
+      //! Gets the mapping object that can perform the upcast or downcast for Derived, remembering it
+      /*! Each derived type keeps a list of the base types it has been cast to along with their
+          casters.  The list only grows and is read without locking, so after the first cast to a
+          base type the nested hash lookups in map are skipped. */
+      template <class Derived, class F> inline
+      static std::vector<PolymorphicCaster const *> const & cachedLookup( std::type_info const & baseInfo, F && exceptionFunc )
+      {
+        struct Entry
+        {
+          std::type_info const * base;
+          std::vector<PolymorphicCaster const *> const * mapping;
+          Entry const * next;
+        };
+        static std::atomic<Entry const *> entries( nullptr );
+
+        for( auto entry = entries.load( std::memory_order_acquire ); entry != nullptr; entry = entry->next )
+          if( *entry->base == baseInfo )
+            return *entry->mapping;
+
+        auto const & mapping = lookup( baseInfo, typeid(Derived), std::forward<F>( exceptionFunc ) );
+
+        auto entry = new Entry{ &baseInfo, &mapping, entries.load( std::memory_order_relaxed ) };
+        while( !entries.compare_exchange_weak( entry->next, entry, std::memory_order_release, std::memory_order_relaxed ) )
+          ;
+
+        return mapping;
+      }
+
       //! Performs a downcast to the derived type using a registered mapping
       template <class Derived> inline
       static const Derived * downcast( const void * dptr, std::type_info const & baseInfo )
       {
-        auto const & mapping = lookup( baseInfo, typeid(Derived), [&](){ UNREGISTERED_POLYMORPHIC_CAST_EXCEPTION(save) } );
+        auto const & mapping = cachedLookup<Derived>( baseInfo, [&](){ UNREGISTERED_POLYMORPHIC_CAST_EXCEPTION(save) } );
 
         for( auto const * dmap : mapping )
           dptr = dmap->downcast( dptr );
@@ -215,7 +244,7 @@ namespace cereal
       template <class Derived> inline
       static void * upcast( Derived * const dptr, std::type_info const & baseInfo )
       {
-        auto const & mapping = lookup( baseInfo, typeid(Derived), [&](){ UNREGISTERED_POLYMORPHIC_CAST_EXCEPTION(load) } );
+        auto const & mapping = cachedLookup<Derived>( baseInfo, [&](){ UNREGISTERED_POLYMORPHIC_CAST_EXCEPTION(load) } );
 
         void * uptr = dptr;
         for( auto mIter = mapping.rbegin(), mEnd = mapping.rend(); mIter != mEnd; ++mIter )
@@ -228,7 +257,7 @@ namespace cereal
       template <class Derived> inline
       static std::shared_ptr<void> upcast( std::shared_ptr<Derived> const & dptr, std::type_info const & baseInfo )
       {
-        auto const & mapping = lookup( baseInfo, typeid(Derived), [&](){ UNREGISTERED_POLYMORPHIC_CAST_EXCEPTION(load) } );
+        auto const & mapping = cachedLookup<Derived>( baseInfo, [&](){ UNREGISTERED_POLYMORPHIC_CAST_EXCEPTION(load) } );
 
         std::shared_ptr<void> uptr = dptr;
         for( auto mIter = mapping.rbegin(), mEnd = mapping.rend(); mIter != mEnd; ++mIter )
@@ -0,0 +1,421 @@
+/*! \file profiling.hpp
+    \brief Per type profiling of serialization
+    \ingroup Internal */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_DETAILS_PROFILING_HPP_
+#define CEREAL_DETAILS_PROFILING_HPP_
+
+#include "cereal/macros.hpp"
+#include "cereal/details/helpers.hpp"
+#include "cereal/details/util.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+#if CEREAL_PROFILING
+#if defined(_MSC_VER) && ( defined(_M_X64) || defined(_M_IX86) )
+#include <intrin.h>
+#define CEREAL_PROFILING_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CEREAL_PROFILING_RDTSC 1
+#endif
+#endif // CEREAL_PROFILING
+
+namespace cereal
+{
+  // ######################################################################
+  //! The profile of one type, or of one type at one place in the call tree
+  /*! @sa Profile */
+  struct ProfileEntry
+  {
+    std::string name;               //!< The demangled name of the type
+    std::uint64_t calls = 0;        //!< How many values of the type were serialized
+    std::uint64_t bytes = 0;        //!< The bytes written or read while serializing them, including nested types
+    double inclusiveNs = 0;         //!< The time spent serializing them, including nested types
+    double exclusiveNs = 0;         //!< The time spent serializing them, excluding nested types
+    std::vector<ProfileEntry> children; //!< The nested types, in the call tree only
+  };
+
+  namespace profile_detail
+  {
+    //! Reads the time stamp counter, or a steady clock where there is none
+    inline std::uint64_t ticks()
+    {
+      #ifdef CEREAL_PROFILING_RDTSC
+      return static_cast<std::uint64_t>( __rdtsc() );
+      #else
+      return static_cast<std::uint64_t>( std::chrono::steady_clock::now().time_since_epoch().count() );
+      #endif
+    }
+
+    //! A type at one place in the call tree of a thread
+    struct Node
+    {
+      std::type_info const * type;
+      std::size_t parent;
+      std::vector<std::size_t> children;
+      std::uint64_t calls;
+      std::uint64_t bytes;
+      std::uint64_t ticks;
+      std::uint64_t childTicks;
+    };
+
+    //! The call tree of one thread
+    /*! Only the owning thread writes to it, so recording needs no locking.  Node 0
+        is the root, above the outermost types serialized. */
+    class ThreadProfile
+    {
+      public:
+        ThreadProfile() : itsNodes( 1, Node{ nullptr, 0, {}, 0, 0, 0, 0 } ), itsBytes( 0 )
+        { }
+
+        //! Starts serializing a value of some type
+        void enter( std::type_info const & type )
+        {
+          auto const parent = itsStack.empty() ? 0 : itsStack.back().node;
+          itsStack.push_back( { child( parent, type ), itsBytes, 0 } );
+          itsStack.back().start = ticks();
+        }
+
+        //! Finishes serializing the value passed to the matching enter
+        void exit()
+        {
+          auto const elapsed = ticks() - itsStack.back().start;
+          auto & node = itsNodes[itsStack.back().node];
+          node.calls += 1;
+          node.bytes += itsBytes - itsStack.back().bytes;
+          node.ticks += elapsed;
+          itsNodes[node.parent].childTicks += elapsed;
+          itsStack.pop_back();
+        }
+
+        //! Counts bytes written or read by an archive
+        void countBytes( std::uint64_t size )
+        { itsBytes += size; }
+
+        //! Zeroes the counters, keeping the nodes that values being serialized refer to
+        void reset()
+        {
+          for( auto & node : itsNodes )
+            node.calls = node.bytes = node.ticks = node.childTicks = 0;
+        }
+
+        std::vector<Node> const & nodes() const
+        { return itsNodes; }
+
+      private:
+        //! Finds or adds the node for type below parent
+        std::size_t child( std::size_t parent, std::type_info const & type )
+        {
+          for( auto const index : itsNodes[parent].children )
+            if( *itsNodes[index].type == type )
+              return index;
+
+          itsNodes.push_back( Node{ &type, parent, {}, 0, 0, 0, 0 } );
+          itsNodes[parent].children.push_back( itsNodes.size() - 1 );
+          return itsNodes.size() - 1;
+        }
+
+        struct Frame
+        {
+          std::size_t node;
+          std::uint64_t bytes;
+          std::uint64_t start;
+        };
+
+        std::vector<Node> itsNodes;
+        std::vector<Frame> itsStack;
+        std::uint64_t itsBytes;
+    };
+
+    //! The call trees of every thread that has serialized something
+    /*! Trees outlive their threads, so that work done on threads that have finished is
+        still reported. */
+    struct Registry
+    {
+      Registry() : startTicks( ticks() ), startTime( std::chrono::steady_clock::now() )
+      { }
+
+      std::mutex mutex;
+      std::vector<std::shared_ptr<ThreadProfile>> threads;
+      std::uint64_t startTicks;
+      std::chrono::steady_clock::time_point startTime;
+    };
+
+    inline Registry & registry()
+    {
+      static Registry r;
+      return r;
+    }
+
+    //! Returns the call tree of the calling thread, registering it on first use
+    inline ThreadProfile & threadProfile()
+    {
+      thread_local std::shared_ptr<ThreadProfile> const profile = []()
+      {
+        auto p = std::make_shared<ThreadProfile>();
+        auto & r = registry();
+        std::lock_guard<std::mutex> lock( r.mutex );
+        r.threads.push_back( p );
+        return p;
+      }();
+      return *profile;
+    }
+
+    //! Whether values of T are profiled
+    /*! Wrappers that only name or size what they wrap are not, since their time and
+        bytes belong to the value inside them. */
+    template <class T> struct is_profiled : std::true_type {};
+    template <class T> struct is_profiled<NameValuePair<T>> : std::false_type {};
+    template <class T> struct is_profiled<SizeTag<T>> : std::false_type {};
+
+    //! Records serializing a value of T for as long as it lives
+    template <class T, bool = is_profiled<typename std::decay<T>::type>::value>
+    class Scope
+    {
+      public:
+        Scope() : itsProfile( threadProfile() )
+        { itsProfile.enter( typeid( typename std::decay<T>::type ) ); }
+
+        ~Scope()
+        { itsProfile.exit(); }
+
+        Scope( Scope const & ) = delete;
+        Scope & operator=( Scope const & ) = delete;
+
+      private:
+        ThreadProfile & itsProfile;
+    };
+
+    //! Records nothing, for the types that are not profiled
+    /*! The user provided constructor keeps unused variable warnings away from the hooks. */
+    template <class T>
+    class Scope<T, false>
+    {
+      public:
+        Scope() {}
+    };
+
+    //! Adds the node at index of a thread's tree to the matching entry below parent
+    inline void merge( ProfileEntry & parent, std::vector<Node> const & nodes, std::size_t index, double nsPerTick )
+    {
+      auto const & node = nodes[index];
+      if( node.calls == 0 )
+        return;
+
+      auto const name = util::demangle( node.type->name() );
+      auto entry = std::find_if( parent.children.begin(), parent.children.end(),
+                                 [&]( ProfileEntry const & e ) { return e.name == name; } );
+      if( entry == parent.children.end() )
+      {
+        parent.children.emplace_back();
+        entry = parent.children.end() - 1;
+        entry->name = name;
+      }
+
+      entry->calls += node.calls;
+      entry->bytes += node.bytes;
+      entry->inclusiveNs += static_cast<double>( node.ticks ) * nsPerTick;
+      entry->exclusiveNs += static_cast<double>( node.ticks - std::min( node.ticks, node.childTicks ) ) * nsPerTick;
+
+      for( auto const child : node.children )
+        merge( *entry, nodes, child, nsPerTick );
+    }
+
+    //! Adds entry and what is below it to flat, by type
+    /*! Inclusive time and bytes are only added where no caller is of the same type, so
+        that recursive types are not counted twice. */
+    inline void flatten( ProfileEntry const & entry, std::vector<ProfileEntry> & flat, std::vector<std::string> & callers )
+    {
+      auto const recursive = std::find( callers.begin(), callers.end(), entry.name ) != callers.end();
+
+      auto e = std::find_if( flat.begin(), flat.end(), [&]( ProfileEntry const & f ) { return f.name == entry.name; } );
+      if( e == flat.end() )
+      {
+        flat.emplace_back();
+        e = flat.end() - 1;
+        e->name = entry.name;
+      }
+
+      e->calls += entry.calls;
+      e->exclusiveNs += entry.exclusiveNs;
+      if( !recursive )
+      {
+        e->bytes += entry.bytes;
+        e->inclusiveNs += entry.inclusiveNs;
+      }
+
+      callers.push_back( entry.name );
+      for( auto const & child : entry.children )
+        flatten( child, flat, callers );
+      callers.pop_back();
+    }
+
+    //! Prints one line of a report
+    inline void print( std::ostream & os, ProfileEntry const & entry, std::size_t indent )
+    {
+      char line[64];
+      std::snprintf( line, sizeof( line ), "%12llu %14llu %12.3f %12.3f  ",
+                     static_cast<unsigned long long>( entry.calls ), static_cast<unsigned long long>( entry.bytes ),
+                     entry.inclusiveNs / 1e6, entry.exclusiveNs / 1e6 );
+      os << line << std::string( indent, ' ' ) << entry.name << '\n';
+    }
+
+    inline void printTree( std::ostream & os, ProfileEntry const & entry, std::size_t indent )
+    {
+      for( auto const & child : entry.children )
+      {
+        print( os, child, indent );
+        printTree( os, child, indent + 2 );
+      }
+    }
+  } // namespace profile_detail
+
+  // ######################################################################
+  //! Reports where serialization spends its time, per serialized type
+  /*! When cereal is compiled with CEREAL_PROFILING defined to 1, every value an archive
+      serializes is recorded: how often each type was serialized, the bytes the binary
+      archives wrote or read for it, and the time spent on it with and without the types
+      nested in it.  Text archives report no bytes.  Each thread records into its own
+      counters, timed with the time stamp counter where the processor has one.
+
+      Without CEREAL_PROFILING nothing is recorded, and collect returns an empty profile.
+
+      @code{.cpp}
+      // compiled with -DCEREAL_PROFILING=1
+      cereal::Profile::reset();
+      {
+        cereal::BinaryOutputArchive ar( os );
+        ar( data );
+      }
+      auto const profile = cereal::Profile::collect();
+      profile.printFlat( std::cout );
+      profile.printTree( std::cout );
+      @endcode
+
+      Collect and reset while no archive is in use, since threads record without locking.
+      \ingroup Utility */
+  class Profile
+  {
+    public:
+      //! Whether profiling was compiled in
+      static constexpr bool enabled()
+      { return CEREAL_PROFILING != 0; }
+
+      //! Gathers what every thread recorded since the last reset
+      static Profile collect()
+      {
+        Profile profile;
+        auto & r = profile_detail::registry();
+        std::lock_guard<std::mutex> lock( r.mutex );
+
+        // calibrate the ticks against a steady clock over the time since the last reset,
+        // waiting for a millisecond to pass so that the calibration is not all noise
+        auto const minimum = std::chrono::steady_clock::time_point( r.startTime + std::chrono::milliseconds( 1 ) );
+        while( std::chrono::steady_clock::now() < minimum )
+          std::this_thread::yield();
+        auto const ns = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - r.startTime ).count();
+        auto const ticks = profile_detail::ticks() - r.startTicks;
+        auto const nsPerTick = ticks == 0 ? 0.0 : ns / static_cast<double>( ticks );
+
+        for( auto const & thread : r.threads )
+          for( auto const child : thread->nodes()[0].children )
+            profile_detail::merge( profile.itsTree, thread->nodes(), child, nsPerTick );
+
+        return profile;
+      }
+
+      //! Zeroes what every thread recorded
+      static void reset()
+      {
+        auto & r = profile_detail::registry();
+        std::lock_guard<std::mutex> lock( r.mutex );
+        for( auto const & thread : r.threads )
+          thread->reset();
+        r.startTicks = profile_detail::ticks();
+        r.startTime = std::chrono::steady_clock::now();
+      }
+
+      //! Returns the outermost types serialized, with the types nested in them as children
+      std::vector<ProfileEntry> const & tree() const
+      { return itsTree.children; }
+
+      //! Returns one entry per type, sorted by exclusive time, slowest first
+      std::vector<ProfileEntry> flat() const
+      {
+        std::vector<ProfileEntry> flat;
+        std::vector<std::string> callers;
+        for( auto const & entry : itsTree.children )
+          profile_detail::flatten( entry, flat, callers );
+
+        std::sort( flat.begin(), flat.end(),
+                   []( ProfileEntry const & a, ProfileEntry const & b ) { return a.exclusiveNs > b.exclusiveNs; } );
+        return flat;
+      }
+
+      //! Prints the flat profile, one line per type
+      void printFlat( std::ostream & os ) const
+      {
+        os << "       calls          bytes inclusive ms exclusive ms  type\n";
+        for( auto const & entry : flat() )
+          profile_detail::print( os, entry, 0 );
+      }
+
+      //! Prints the call tree, indenting nested types below the types they are nested in
+      void printTree( std::ostream & os ) const
+      {
+        os << "       calls          bytes inclusive ms exclusive ms  type\n";
+        profile_detail::printTree( os, itsTree, 0 );
+      }
+
+    private:
+      ProfileEntry itsTree;
+  };
+} // namespace cereal
+
+#if CEREAL_PROFILING
+//! Records the serialization of a value of type T until the end of the enclosing scope
+#define CEREAL_PROFILE_SCOPE(T) ::cereal::profile_detail::Scope<T> cereal_profile_scope_
+//! Counts size bytes written or read by an archive
+#define CEREAL_PROFILE_BYTES(size) ::cereal::profile_detail::threadProfile().countBytes( static_cast<std::uint64_t>( size ) )
+#else
+#define CEREAL_PROFILE_SCOPE(T)
+#define CEREAL_PROFILE_BYTES(size)
+#endif // CEREAL_PROFILING
+
+#endif // CEREAL_DETAILS_PROFILING_HPP_
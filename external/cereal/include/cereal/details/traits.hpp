@@ -1325,6 +1325,29 @@ namespace cereal
     struct is_text_archive : std::integral_constant<bool,
       std::is_base_of<TextArchive, detail::decay_archive<A>>::value>
     { };
+
+    //! Type traits only struct used to mark an input archive as reading from contiguous memory
+    /*! Archives that inherit from this struct must provide a member function
+        void const * borrowBinary( std::size_t size ), which advances the archive by
+        size bytes and returns a pointer to them inside the memory being read.  This allows
+        serialization functions to reference loaded data instead of copying it. */
+    struct ContiguousInputArchive {};
+
+    //! Checks if an archive reads from contiguous memory
+    template <class A>
+    struct is_contiguous_input_archive : std::integral_constant<bool,
+      std::is_base_of<ContiguousInputArchive, detail::decay_archive<A>>::value>
+    { };
+
+    //! Checks if a type can be serialized by copying its bytes
+    /*! Arithmetic types are memcpy serializable.  Trivially copyable user types can
+        be marked as memcpy serializable with CEREAL_MEMCPY_SERIALIZABLE, which lets
+        contiguous containers of them (e.g. std::vector) be serialized as a single
+        block of binary data by archives supporting BinaryData.
+
+        @sa CEREAL_MEMCPY_SERIALIZABLE */
+    template <class T>
+    struct is_memcpy_serializable : std::is_arithmetic<T> {};
   } // namespace traits
 
   // ######################################################################
@@ -56,6 +56,14 @@
 #define CEREAL_THREAD_SAFE 0
 #endif // CEREAL_THREAD_SAFE
 
+#ifndef CEREAL_PROFILING
+//! Whether archives record per type profiles of what they serialize
+/*! Define this as 1 to have every value serialized counted and timed,
+    see cereal::Profile.  It must have the same value in every translation
+    unit.  When it is 0, the profiling hooks compile to nothing. */
+#define CEREAL_PROFILING 0
+#endif // CEREAL_PROFILING
+
 #ifndef CEREAL_SIZE_TYPE
 //! Determines the data type used for size_type
 /*! cereal uses size_type to ensure that the serialized size of
@@ -145,6 +153,13 @@
 #define CEREAL_HAS_CPP14
 #endif
 
+//! Checks if std::pmr memory resources are available
+#ifdef CEREAL_HAS_CPP17
+  #if __has_include(<memory_resource>)
+    #define CEREAL_HAS_MEMORY_RESOURCE
+  #endif
+#endif
+
 // ######################################################################
 //! Defines the CEREAL_ALIGNOF macro to use instead of alignof
 #if defined(_MSC_VER) && _MSC_VER < 1900
@@ -35,30 +35,30 @@
 
 namespace cereal
 {
-  //! Saving for std::array primitive types
+  //! Saving for std::array memcpy serializable types (e.g. arithmetic)
   //! using binary serialization, if supported
   template <class Archive, class T, size_t N> inline
   typename std::enable_if<traits::is_output_serializable<BinaryData<T>, Archive>::value
-                          && std::is_arithmetic<T>::value, void>::type
+                          && traits::is_memcpy_serializable<T>::value, void>::type
   CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::array<T, N> const & array )
   {
-    ar( binary_data( array.data(), sizeof(array) ) );
+    common_detail::saveMemcpy( ar, array.data(), N );
   }
 
-  //! Loading for std::array primitive types
+  //! Loading for std::array memcpy serializable types (e.g. arithmetic)
   //! using binary serialization, if supported
   template <class Archive, class T, size_t N> inline
   typename std::enable_if<traits::is_input_serializable<BinaryData<T>, Archive>::value
-                          && std::is_arithmetic<T>::value, void>::type
+                          && traits::is_memcpy_serializable<T>::value, void>::type
   CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::array<T, N> & array )
   {
-    ar( binary_data( array.data(), sizeof(array) ) );
+    common_detail::loadMemcpy( ar, array.data(), N );
   }
 
   //! Saving for std::array all other types
   template <class Archive, class T, size_t N> inline
   typename std::enable_if<!traits::is_output_serializable<BinaryData<T>, Archive>::value
-                          || !std::is_arithmetic<T>::value, void>::type
+                          || !traits::is_memcpy_serializable<T>::value, void>::type
   CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::array<T, N> const & array )
   {
     for( auto const & i : array )
@@ -68,7 +68,7 @@ namespace cereal
   //! Loading for std::array all other types
   template <class Archive, class T, size_t N> inline
   typename std::enable_if<!traits::is_input_serializable<BinaryData<T>, Archive>::value
-                          || !std::is_arithmetic<T>::value, void>::type
+                          || !traits::is_memcpy_serializable<T>::value, void>::type
   CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::array<T, N> & array )
   {
     for( auto & i : array )
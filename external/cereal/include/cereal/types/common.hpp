@@ -53,6 +53,141 @@ namespace cereal
         ar( i );
     }
 
+    //! The arithmetic members of a memcpy serializable type, in the order it serializes them
+    /*! @internal */
+    struct MemcpyLayout
+    {
+      MemcpyLayout() : packed( true ) {}
+
+      std::vector<std::size_t> fields; //!< The size of each member
+      bool packed;                     //!< Whether the members cover the type in memory order without padding
+    };
+
+    //! An archive that records the address of each arithmetic value a type loads
+    /*! No data is ever read; this is run once over each memcpy serializable type
+        to find out whether its bytes are exactly the data it serializes.
+        @internal */
+    class MemcpyLayoutArchive : public InputArchive<MemcpyLayoutArchive, AllowEmptyClassElision>
+    {
+      public:
+        //! Construct, recording the members of the size bytes at object into layout
+        MemcpyLayoutArchive( void const * object, std::size_t size, MemcpyLayout & layout ) :
+          InputArchive<MemcpyLayoutArchive, AllowEmptyClassElision>( this ),
+          itsPosition( static_cast<const char *>( object ) ),
+          itsEnd( itsPosition + size ),
+          itsLayout( layout )
+        { }
+
+        //! Records a member of size bytes at address
+        void field( void const * address, std::size_t size )
+        {
+          auto const position = static_cast<const char *>( address );
+
+          // anything loaded outside of the object (e.g. a class version) cannot be copied
+          itsLayout.packed = itsLayout.packed && position == itsPosition &&
+                             size <= static_cast<std::size_t>( itsEnd - position );
+          itsLayout.fields.push_back( size );
+          itsPosition = position + size;
+        }
+
+        //! Whether the members recorded so far reach the end of the object
+        bool complete() const
+        {
+          return itsPosition == itsEnd;
+        }
+
+      private:
+        const char * itsPosition;
+        const char * const itsEnd;
+        MemcpyLayout & itsLayout;
+    };
+  } // namespace common_detail
+
+  //! Records arithmetic members for MemcpyLayoutArchive
+  template <class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( common_detail::MemcpyLayoutArchive & ar, T & t )
+  {
+    ar.field( std::addressof( t ), sizeof(T) );
+  }
+
+  //! Records NVP members for MemcpyLayoutArchive
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( common_detail::MemcpyLayoutArchive & ar, NameValuePair<T> & t )
+  {
+    ar( t.value );
+  }
+
+  namespace common_detail
+  {
+    //! Gets the layout of a memcpy serializable type, finding it the first time it is needed
+    /*! @internal */
+    template <class T> inline
+    MemcpyLayout const & memcpyLayout()
+    {
+      static const MemcpyLayout layout = []
+      {
+        MemcpyLayout result;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage = {};
+
+        MemcpyLayoutArchive ar( &storage, sizeof(T), result );
+        ar( *reinterpret_cast<T *>( &storage ) );
+        result.packed = result.packed && ar.complete();
+
+        return result;
+      }();
+
+      return layout;
+    }
+
+    //! Arithmetic types are always serialized as their bytes
+    /*! @internal */
+    template <class T> inline
+    typename std::enable_if<std::is_arithmetic<T>::value, bool>::type
+    isMemcpyPacked()
+    {
+      return true;
+    }
+
+    //! Checks if the bytes of a memcpy serializable type are exactly the data it serializes
+    /*! @internal */
+    template <class T> inline
+    typename std::enable_if<!std::is_arithmetic<T>::value, bool>::type
+    isMemcpyPacked()
+    {
+      return memcpyLayout<T>().packed;
+    }
+
+    //! The number of elements of a memcpy serializable type loaded into a local buffer at a time
+    /*! @internal */
+    template <class T>
+    struct memcpy_chunk_size : std::integral_constant<std::size_t, sizeof(T) < 4096 ? 4096 / sizeof(T) : 1> {};
+
+    //! Saves contiguous memcpy serializable elements as one block of binary data
+    /*! Elements whose bytes are not exactly their data are saved one at a time.
+        @internal */
+    template <class Archive, class T> inline
+    void saveMemcpy( Archive & ar, T const * data, std::size_t count )
+    {
+      if( isMemcpyPacked<T>() )
+        ar( binary_data( data, count * sizeof(T) ) );
+      else
+        for( auto const end = data + count; data != end; ++data )
+          ar( *data );
+    }
+
+    //! Loads contiguous memcpy serializable elements saved by saveMemcpy
+    /*! @internal */
+    template <class Archive, class T> inline
+    void loadMemcpy( Archive & ar, T * data, std::size_t count )
+    {
+      if( isMemcpyPacked<T>() )
+        ar( binary_data( data, count * sizeof(T) ) );
+      else
+        for( auto const end = data + count; data != end; ++data )
+          ar( *data );
+    }
+
     namespace
     {
       //! Gets the underlying type of an enum
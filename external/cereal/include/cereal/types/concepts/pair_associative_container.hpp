@@ -57,8 +57,10 @@ namespace cereal
     auto hint = map.begin();
     for( size_t i = 0; i < size; ++i )
     {
-      typename Map<Args...>::key_type key;
-      typename Map<Args...>::mapped_type value;
+      // made with the map's allocator, so that keys and values of maps with a stateful
+      // allocator allocate from the map's memory rather than being copied into it
+      auto key = detail::makeWithAllocator<typename Map<Args...>::key_type>( map.get_allocator() );
+      auto value = detail::makeWithAllocator<typename Map<Args...>::mapped_type>( map.get_allocator() );
 
       ar( make_map_item(key, value) );
       #ifdef CEREAL_OLDER_GCC
@@ -200,6 +200,85 @@ namespace cereal
       memory_detail::LoadAndConstructLoadWrapper<Archive, T> loadWrapper( ptr );
       ar( CEREAL_NVP_("data", loadWrapper) );
     }
+
+    #ifdef CEREAL_HAS_MEMORY_RESOURCE
+    //! Default constructs a T in place, passing it an allocator using resource (allocator_arg form)
+    /*! Types that are not allocator aware are default constructed.  This goes through
+        cereal::access so that private default constructors can still be used.
+        @internal */
+    template <class T> inline
+    typename std::enable_if<std::uses_allocator<T, std::pmr::polymorphic_allocator<T>>::value &&
+                            std::is_constructible<T, std::allocator_arg_t, std::pmr::polymorphic_allocator<T> const &>::value, void>::type
+    constructWithResource( T * ptr, std::pmr::memory_resource * resource )
+    {
+      ::cereal::access::construct( ptr, std::allocator_arg, std::pmr::polymorphic_allocator<T>( resource ) );
+    }
+
+    //! Default constructs a T in place, passing it an allocator using resource (trailing allocator form)
+    /*! @internal */
+    template <class T> inline
+    typename std::enable_if<std::uses_allocator<T, std::pmr::polymorphic_allocator<T>>::value &&
+                            !std::is_constructible<T, std::allocator_arg_t, std::pmr::polymorphic_allocator<T> const &>::value, void>::type
+    constructWithResource( T * ptr, std::pmr::memory_resource * resource )
+    {
+      ::cereal::access::construct( ptr, std::pmr::polymorphic_allocator<T>( resource ) );
+    }
+
+    //! Default constructs a T that is not allocator aware in place
+    /*! @internal */
+    template <class T> inline
+    typename std::enable_if<!std::uses_allocator<T, std::pmr::polymorphic_allocator<T>>::value, void>::type
+    constructWithResource( T * ptr, std::pmr::memory_resource * )
+    {
+      ::cereal::access::construct( ptr );
+    }
+
+    //! Creates a default constructed T whose storage and control block are allocated from resource
+    /*! Used in place of new when the archive has a memory resource.
+        @internal */
+    template <class T> inline
+    std::shared_ptr<T> makeSharedFromResource( std::pmr::memory_resource * resource )
+    {
+      std::pmr::polymorphic_allocator<T> alloc( resource );
+      T * ptr = alloc.allocate( 1 );
+
+      try
+      {
+        constructWithResource( ptr, resource );
+      }
+      catch( ... )
+      {
+        alloc.deallocate( ptr, 1 );
+        throw;
+      }
+
+      return std::shared_ptr<T>( ptr,
+          [alloc]( T * t ) mutable
+          {
+            t->~T();
+            alloc.deallocate( t, 1 );
+          }, alloc );
+    }
+
+    //! Allocates uninitialized storage for a T, and its control block, from resource
+    /*! The object is destroyed on deletion only once valid has been set, as with the
+        storage allocated by load_and_construct when there is no resource.
+        @internal */
+    template <class T> inline
+    std::shared_ptr<T> allocateSharedFromResource( std::pmr::memory_resource * resource, std::shared_ptr<bool> const & valid )
+    {
+      std::pmr::polymorphic_allocator<T> alloc( resource );
+
+      return std::shared_ptr<T>( alloc.allocate( 1 ),
+          [alloc, valid]( T * t ) mutable
+          {
+            if( *valid )
+              t->~T();
+
+            alloc.deallocate( t, 1 );
+          }, alloc );
+    }
+    #endif // CEREAL_HAS_MEMORY_RESOURCE
   } // end namespace memory_detail
 
   //! Saving std::shared_ptr for non polymorphic types
@@ -296,7 +375,14 @@ namespace cereal
       // Allocate our storage, which we will treat as
       //  uninitialized until initialized with placement new
       using NonConstT = typename std::remove_const<T>::type;
-      std::shared_ptr<NonConstT> ptr(reinterpret_cast<NonConstT *>(new ST()),
+      std::shared_ptr<NonConstT> ptr;
+
+      #ifdef CEREAL_HAS_MEMORY_RESOURCE
+      if( auto resource = ar.getMemoryResource() )
+        ptr = memory_detail::allocateSharedFromResource<NonConstT>( resource, valid );
+      else
+      #endif // CEREAL_HAS_MEMORY_RESOURCE
+      ptr = std::shared_ptr<NonConstT>(reinterpret_cast<NonConstT *>(new ST()),
           [=]( NonConstT * t )
           {
             if( *valid )
@@ -332,7 +418,15 @@ namespace cereal
     if( id & detail::msb_32bit )
     {
       using NonConstT = typename std::remove_const<T>::type;
-      std::shared_ptr<NonConstT> ptr( detail::Construct<NonConstT, Archive>::load_andor_construct() );
+      std::shared_ptr<NonConstT> ptr;
+
+      #ifdef CEREAL_HAS_MEMORY_RESOURCE
+      if( auto resource = ar.getMemoryResource() )
+        ptr = memory_detail::makeSharedFromResource<NonConstT>( resource );
+      else
+      #endif // CEREAL_HAS_MEMORY_RESOURCE
+      ptr.reset( detail::Construct<NonConstT, Archive>::load_andor_construct() );
+
       ar.registerSharedPointer( id, ptr );
       ar( CEREAL_NVP_("data", *ptr) );
       wrapper.ptr = std::move(ptr);
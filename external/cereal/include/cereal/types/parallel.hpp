@@ -0,0 +1,554 @@
+/*! \file parallel.hpp
+    \brief Support for serializing large containers in chunks on several threads
+    \ingroup STLSupport */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TYPES_PARALLEL_HPP_
+#define CEREAL_TYPES_PARALLEL_HPP_
+
+#include "cereal/cereal.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cereal
+{
+  // ######################################################################
+  //! A wrapper around a container that should be serialized in chunks on several threads
+  /*! Create one with make_parallel:
+
+      @code{.cpp}
+      std::vector<Record> records;
+      archive( cereal::make_parallel( records ) );      // one thread per hardware thread
+      archive( cereal::make_parallel( records, 8 ) );   // eight threads
+      @endcode
+
+      With binary archives, the container is split into chunks of chunkSize elements and each
+      chunk is serialized into its own buffer, on a pool of threads, by a new archive of the same
+      type.  The archive then receives the number of elements, the chunk size, an index holding
+      the size in bytes of each chunk, and the chunks themselves.  Loading reads the index and the
+      chunks, then decodes the chunks on a pool of threads.  The data does not depend on the number
+      of threads, so a container saved with any number of threads can be loaded with any other.
+
+      Text archives serialize the container element by element, exactly as they do without the
+      wrapper.
+
+      Since each chunk is serialized by its own archive:
+        - shared pointers are only tracked within a chunk, so an object shared by elements in
+          different chunks is saved and loaded once per chunk
+        - class versions and polymorphic type names are saved once per chunk
+        - element types with class versions use the registry shared by all threads, which requires
+          CEREAL_THREAD_SAFE, as for any other use of cereal from several threads
+
+      Saving holds the serialized chunks in memory until all have been written, and loading holds
+      the chunks being decoded, unless the archive reads from contiguous memory.
+
+      std::vector (except std::vector<bool>) and std-like pair associative containers, such as
+      std::map and std::unordered_map, are supported.  Associative containers are decoded on
+      several threads but filled in by the thread loading them. */
+  template <class T>
+  class ParallelData
+  {
+    private:
+      // Store a reference if we were passed an l value reference, else copy the value
+      using Type = typename std::conditional<std::is_lvalue_reference<T>::value,
+                                             T,
+                                             typename std::decay<T>::type>::type;
+
+      ParallelData & operator=( ParallelData const & ) = delete;
+
+    public:
+      //! Constructs a new ParallelData
+      /*! @param c The container to serialize
+          @param t The number of threads to use, or 0 for one per hardware thread
+          @param cs The number of elements in each chunk */
+      ParallelData( T && c, std::size_t t, std::size_t cs ) :
+        container(std::forward<T>(c)), threads(t), chunkSize(cs) {}
+
+      Type container;
+      std::size_t threads;
+      std::size_t chunkSize;
+  };
+
+  //! Creates a ParallelData for a container
+  /*! @param container The container to serialize
+      @param threads The number of threads to use, or 0 for one per hardware thread
+      @param chunkSize The number of elements in each chunk, which only affects saving
+      @relates ParallelData */
+  template <class T> inline
+  ParallelData<T> make_parallel( T && container, std::size_t threads = 0, std::size_t chunkSize = 16 * 1024 )
+  {
+    return {std::forward<T>(container), threads, chunkSize};
+  }
+
+  namespace parallel_detail
+  {
+    //! A stream buffer that appends to a std::vector<char>
+    /*! Characters are written directly into the vector, which is grown geometrically and
+        trimmed to the characters written when the stream buffer is destroyed. */
+    class OutputBuffer : public std::streambuf
+    {
+      public:
+        OutputBuffer( std::vector<char> & buffer ) : itsBuffer( buffer ), itsSize( buffer.size() ) {}
+
+        ~OutputBuffer()
+        {
+          itsBuffer.resize( size() );
+        }
+
+      protected:
+        int_type overflow( int_type c ) override
+        {
+          auto const used = size();
+          itsBuffer.resize( std::max<std::size_t>( { 4096, itsBuffer.capacity(), itsBuffer.size() * 2 } ) );
+          setp( itsBuffer.data() + used, itsBuffer.data() + itsBuffer.size() );
+          itsSize = used;
+
+          if( !traits_type::eq_int_type( c, traits_type::eof() ) )
+          {
+            *pptr() = traits_type::to_char_type( c );
+            pbump( 1 );
+          }
+          return traits_type::not_eof( c );
+        }
+
+      private:
+        //! The number of characters in the vector that have been written
+        std::size_t size() const
+        {
+          return itsSize + static_cast<std::size_t>( pptr() - pbase() );
+        }
+
+        std::vector<char> & itsBuffer;
+        std::size_t itsSize; //!< The number of characters written before the current put area
+    };
+
+    //! A stream buffer that reads from memory it does not own
+    class InputBuffer : public std::streambuf
+    {
+      public:
+        InputBuffer( const char * data, std::size_t size )
+        {
+          auto const begin = const_cast<char *>( data );
+          setg( begin, begin, begin + size );
+        }
+    };
+
+    //! Whether an output archive saves containers in chunks
+    template <class Archive>
+    struct is_chunked_output : std::integral_constant<bool,
+      !std::is_base_of<traits::TextArchive, Archive>::value &&
+      ( std::is_constructible<Archive, std::vector<char> &>::value || std::is_constructible<Archive, std::ostream &>::value )>
+    { };
+
+    //! Whether an input archive loads containers in chunks
+    template <class Archive>
+    struct is_chunked_input : std::integral_constant<bool,
+      !std::is_base_of<traits::TextArchive, Archive>::value &&
+      ( std::is_constructible<Archive, const void *, std::size_t>::value || std::is_constructible<Archive, std::istream &>::value )>
+    { };
+
+    //! Runs f with an archive of type Archive that appends to buffer, using the buffer directly
+    template <class Archive, class F> inline
+    typename std::enable_if<std::is_constructible<Archive, std::vector<char> &>::value, void>::type
+    withChunkArchive( std::vector<char> & buffer, F const & f )
+    {
+      Archive ar( buffer );
+      f( ar );
+    }
+
+    //! Runs f with an archive of type Archive that appends to buffer, through a stream
+    template <class Archive, class F> inline
+    typename std::enable_if<!std::is_constructible<Archive, std::vector<char> &>::value, void>::type
+    withChunkArchive( std::vector<char> & buffer, F const & f )
+    {
+      OutputBuffer streamBuffer( buffer );
+      std::ostream stream( &streamBuffer );
+      Archive ar( stream );
+      f( ar );
+    }
+
+    //! Runs f with an archive of type Archive that reads from memory, using the memory directly
+    template <class Archive, class F> inline
+    typename std::enable_if<std::is_constructible<Archive, const void *, std::size_t>::value, void>::type
+    withChunkArchive( const char * data, std::size_t size, F const & f )
+    {
+      Archive ar( data, size );
+      f( ar );
+    }
+
+    //! Runs f with an archive of type Archive that reads from memory, through a stream
+    template <class Archive, class F> inline
+    typename std::enable_if<!std::is_constructible<Archive, const void *, std::size_t>::value, void>::type
+    withChunkArchive( const char * data, std::size_t size, F const & f )
+    {
+      InputBuffer streamBuffer( data, size );
+      std::istream stream( &streamBuffer );
+      Archive ar( stream );
+      f( ar );
+    }
+
+    //! Runs f(i) for each i in [0, count) on up to threads threads, including the calling thread
+    /*! Threads take the next i as they finish the previous one.  If any call throws, no new calls
+        are started and the first exception is rethrown once all threads have finished. */
+    template <class F> inline
+    void parallelFor( std::size_t count, std::size_t threads, F const & f )
+    {
+      if( threads == 0 )
+        threads = std::max( 1u, std::thread::hardware_concurrency() );
+      threads = std::min( threads, count );
+
+      std::atomic<std::size_t> next( 0 );
+      std::exception_ptr error;
+      std::mutex errorMutex;
+
+      auto work = [&]()
+      {
+        for( auto i = next++; i < count; i = next++ )
+        {
+          try
+          {
+            f( i );
+          }
+          catch( ... )
+          {
+            std::lock_guard<std::mutex> lock( errorMutex );
+            if( !error )
+              error = std::current_exception();
+            next = count;
+          }
+        }
+      };
+
+      std::vector<std::thread> pool;
+      for( std::size_t t = 1; t < threads; ++t )
+        pool.emplace_back( work );
+
+      work();
+
+      for( auto & thread : pool )
+        thread.join();
+
+      if( error )
+        std::rethrow_exception( error );
+    }
+
+    //! Saves size elements in chunks of chunkSize on several threads, followed by the chunk index and the chunks
+    /*! @param saveChunk Called as saveChunk( archive, first, count ) to save the elements
+                         [first, first + count) to the archive for a chunk */
+    template <class Archive, class F> inline
+    void saveChunks( Archive & ar, std::size_t size, std::size_t chunkSize, std::size_t threads, F const & saveChunk )
+    {
+      auto const chunks = ( size + chunkSize - 1 ) / chunkSize;
+      std::vector<std::vector<char>> buffers( chunks );
+
+      // chunks usually have similar sizes, so reserve the size of the last one finished to avoid growing buffers
+      std::atomic<std::size_t> estimate( 0 );
+
+      parallelFor( chunks, threads, [&]( std::size_t chunk )
+      {
+        auto const first = chunk * chunkSize;
+        auto & buffer = buffers[chunk];
+        buffer.reserve( estimate + estimate / 8 );
+
+        withChunkArchive<Archive>( buffer, [&]( Archive & chunkArchive )
+        {
+          saveChunk( chunkArchive, first, std::min( chunkSize, size - first ) );
+        } );
+
+        estimate = buffer.size();
+      } );
+
+      ar( make_size_tag( static_cast<size_type>( size ) ) );
+      ar( static_cast<std::uint64_t>( chunkSize ) );
+
+      for( auto const & buffer : buffers )
+        ar( make_size_tag( static_cast<size_type>( buffer.size() ) ) );
+
+      for( auto const & buffer : buffers )
+        ar( binary_data( buffer.data(), buffer.size() ) );
+    }
+
+    //! Reads the bytes of a chunk, pointing data into the archive's memory
+    template <class Archive> inline
+    typename std::enable_if<traits::is_contiguous_input_archive<Archive>::value, void>::type
+    readChunk( Archive & ar, std::size_t size, const char * & data, std::vector<char> & )
+    {
+      data = static_cast<const char *>( ar.borrowBinary( size ) );
+    }
+
+    //! Reads the bytes of a chunk into buffer
+    template <class Archive> inline
+    typename std::enable_if<!traits::is_contiguous_input_archive<Archive>::value, void>::type
+    readChunk( Archive & ar, std::size_t size, const char * & data, std::vector<char> & buffer )
+    {
+      buffer.resize( size );
+      ar( binary_data( buffer.data(), size ) );
+      data = buffer.data();
+    }
+
+    //! Loads elements saved by saveChunks, decoding the chunks on several threads
+    /*! @param prepare Called as prepare( size ) with the number of elements before any are loaded
+        @param loadChunk Called as loadChunk( archive, first, count ) to load the elements
+                         [first, first + count) from the archive for a chunk */
+    template <class Archive, class P, class F> inline
+    void loadChunks( Archive & ar, std::size_t threads, P const & prepare, F const & loadChunk )
+    {
+      size_type size;
+      std::uint64_t chunkSize;
+      ar( make_size_tag( size ) );
+      ar( chunkSize );
+
+      if( size > 0 && chunkSize == 0 )
+        throw Exception("Invalid chunk size for a parallel container");
+
+      auto const chunks = size > 0 ? static_cast<std::size_t>( ( size - 1 ) / chunkSize + 1 ) : 0;
+      std::vector<size_type> sizes( chunks );
+      for( auto & s : sizes )
+        ar( make_size_tag( s ) );
+
+      std::vector<const char *> data( chunks );
+      std::vector<std::vector<char>> buffers( chunks );
+      for( std::size_t chunk = 0; chunk < chunks; ++chunk )
+        readChunk( ar, static_cast<std::size_t>( sizes[chunk] ), data[chunk], buffers[chunk] );
+
+      prepare( static_cast<std::size_t>( size ) );
+
+      parallelFor( chunks, threads, [&]( std::size_t chunk )
+      {
+        auto const first = static_cast<std::size_t>( chunk * chunkSize );
+        withChunkArchive<Archive>( data[chunk], static_cast<std::size_t>( sizes[chunk] ), [&]( Archive & chunkArchive )
+        {
+          loadChunk( chunkArchive, first, std::min( static_cast<std::size_t>( chunkSize ), static_cast<std::size_t>( size ) - first ) );
+        } );
+      } );
+    }
+
+    //! Saves contiguous memcpy serializable elements as binary data, if supported
+    template <class Archive, class T> inline
+    typename std::enable_if<traits::is_output_serializable<BinaryData<T>, Archive>::value && traits::is_memcpy_serializable<T>::value, void>::type
+    saveElements( Archive & ar, T const * elements, std::size_t count )
+    {
+      common_detail::saveMemcpy( ar, elements, count );
+    }
+
+    //! Saves contiguous elements one at a time
+    template <class Archive, class T> inline
+    typename std::enable_if<!traits::is_output_serializable<BinaryData<T>, Archive>::value || !traits::is_memcpy_serializable<T>::value, void>::type
+    saveElements( Archive & ar, T const * elements, std::size_t count )
+    {
+      for( auto const end = elements + count; elements != end; ++elements )
+        ar( *elements );
+    }
+
+    //! Loads contiguous memcpy serializable elements as binary data, if supported
+    template <class Archive, class T> inline
+    typename std::enable_if<traits::is_input_serializable<BinaryData<T>, Archive>::value && traits::is_memcpy_serializable<T>::value, void>::type
+    loadElements( Archive & ar, T * elements, std::size_t count )
+    {
+      common_detail::loadMemcpy( ar, elements, count );
+    }
+
+    //! Loads contiguous elements one at a time
+    template <class Archive, class T> inline
+    typename std::enable_if<!traits::is_input_serializable<BinaryData<T>, Archive>::value || !traits::is_memcpy_serializable<T>::value, void>::type
+    loadElements( Archive & ar, T * elements, std::size_t count )
+    {
+      for( auto const end = elements + count; elements != end; ++elements )
+        ar( *elements );
+    }
+
+    //! Reserves space in containers that support it
+    template <class C> inline
+    auto reserve( C & container, std::size_t size, int ) -> decltype( container.reserve( size ), void() )
+    {
+      container.reserve( size );
+    }
+
+    template <class C> inline
+    void reserve( C &, std::size_t, long )
+    { }
+
+    // ######################################################################
+    //! Saving for std::vector in chunks
+    template <class Archive, class T, class A> inline
+    void save( Archive & ar, std::vector<T, A> const & vector, std::size_t threads, std::size_t chunkSize, std::true_type )
+    {
+      saveChunks( ar, vector.size(), chunkSize, threads, [&]( Archive & chunkArchive, std::size_t first, std::size_t count )
+      {
+        saveElements( chunkArchive, vector.data() + first, count );
+      } );
+    }
+
+    //! Saving for std::vector one element at a time
+    template <class Archive, class T, class A> inline
+    void save( Archive & ar, std::vector<T, A> const & vector, std::size_t, std::size_t, std::false_type )
+    {
+      ar( make_size_tag( static_cast<size_type>( vector.size() ) ) );
+      saveElements( ar, vector.data(), vector.size() );
+    }
+
+    //! Loading for std::vector in chunks
+    template <class Archive, class T, class A> inline
+    void load( Archive & ar, std::vector<T, A> & vector, std::size_t threads, std::true_type )
+    {
+      loadChunks( ar, threads,
+                  [&]( std::size_t size ) { vector.resize( size ); },
+                  [&]( Archive & chunkArchive, std::size_t first, std::size_t count )
+                  {
+                    loadElements( chunkArchive, vector.data() + first, count );
+                  } );
+    }
+
+    //! Loading for std::vector one element at a time
+    template <class Archive, class T, class A> inline
+    void load( Archive & ar, std::vector<T, A> & vector, std::size_t, std::false_type )
+    {
+      size_type size;
+      ar( make_size_tag( size ) );
+
+      vector.resize( static_cast<std::size_t>( size ) );
+      loadElements( ar, vector.data(), vector.size() );
+    }
+
+    // ######################################################################
+    //! Saving for std-like pair associative containers in chunks
+    template <class Archive, template <typename...> class Map, typename... Args, typename = typename Map<Args...>::mapped_type> inline
+    void save( Archive & ar, Map<Args...> const & map, std::size_t threads, std::size_t chunkSize, std::true_type )
+    {
+      // the first element of each chunk
+      std::vector<typename Map<Args...>::const_iterator> starts;
+      starts.reserve( map.size() / chunkSize + 1 );
+
+      std::size_t index = 0;
+      for( auto i = map.begin(); i != map.end(); ++i, ++index )
+        if( index % chunkSize == 0 )
+          starts.push_back( i );
+
+      saveChunks( ar, map.size(), chunkSize, threads, [&]( Archive & chunkArchive, std::size_t first, std::size_t count )
+      {
+        auto i = starts[first / chunkSize];
+        for( ; count > 0; --count, ++i )
+          chunkArchive( make_map_item( i->first, i->second ) );
+      } );
+    }
+
+    //! Saving for std-like pair associative containers one element at a time
+    template <class Archive, template <typename...> class Map, typename... Args, typename = typename Map<Args...>::mapped_type> inline
+    void save( Archive & ar, Map<Args...> const & map, std::size_t, std::size_t, std::false_type )
+    {
+      ar( make_size_tag( static_cast<size_type>( map.size() ) ) );
+
+      for( const auto & i : map )
+        ar( make_map_item( i.first, i.second ) );
+    }
+
+    //! Inserts loaded elements into a std-like pair associative container
+    template <template <typename...> class Map, typename... Args, class Elements> inline
+    void insert( Map<Args...> & map, Elements & elements )
+    {
+      map.clear();
+      reserve( map, elements.size(), 0 );
+
+      auto hint = map.begin();
+      for( auto & element : elements )
+      {
+        #ifdef CEREAL_OLDER_GCC
+        hint = map.insert( hint, std::make_pair( std::move( element.first ), std::move( element.second ) ) );
+        #else // NOT CEREAL_OLDER_GCC
+        hint = map.emplace_hint( hint, std::move( element.first ), std::move( element.second ) );
+        #endif // NOT CEREAL_OLDER_GCC
+      }
+    }
+
+    //! Loading for std-like pair associative containers in chunks
+    template <class Archive, template <typename...> class Map, typename... Args, typename = typename Map<Args...>::mapped_type> inline
+    void load( Archive & ar, Map<Args...> & map, std::size_t threads, std::true_type )
+    {
+      std::vector<std::pair<typename Map<Args...>::key_type, typename Map<Args...>::mapped_type>> elements;
+
+      loadChunks( ar, threads,
+                  [&]( std::size_t size ) { elements.resize( size ); },
+                  [&]( Archive & chunkArchive, std::size_t first, std::size_t count )
+                  {
+                    for( auto i = elements.begin() + static_cast<std::ptrdiff_t>( first ), end = i + static_cast<std::ptrdiff_t>( count ); i != end; ++i )
+                      chunkArchive( make_map_item( i->first, i->second ) );
+                  } );
+
+      insert( map, elements );
+    }
+
+    //! Loading for std-like pair associative containers one element at a time
+    template <class Archive, template <typename...> class Map, typename... Args, typename = typename Map<Args...>::mapped_type> inline
+    void load( Archive & ar, Map<Args...> & map, std::size_t, std::false_type )
+    {
+      size_type size;
+      ar( make_size_tag( size ) );
+
+      map.clear();
+
+      auto hint = map.begin();
+      for( size_t i = 0; i < size; ++i )
+      {
+        auto key = detail::makeWithAllocator<typename Map<Args...>::key_type>( map.get_allocator() );
+        auto value = detail::makeWithAllocator<typename Map<Args...>::mapped_type>( map.get_allocator() );
+
+        ar( make_map_item( key, value ) );
+        #ifdef CEREAL_OLDER_GCC
+        hint = map.insert( hint, std::make_pair( std::move( key ), std::move( value ) ) );
+        #else // NOT CEREAL_OLDER_GCC
+        hint = map.emplace_hint( hint, std::move( key ), std::move( value ) );
+        #endif // NOT CEREAL_OLDER_GCC
+      }
+    }
+  } // namespace parallel_detail
+
+  //! Saving for ParallelData
+  template <class Archive, class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, ParallelData<T> const & data )
+  {
+    parallel_detail::save( ar, data.container, data.threads, std::max<std::size_t>( data.chunkSize, 1 ),
+                           parallel_detail::is_chunked_output<Archive>() );
+  }
+
+  //! Loading for ParallelData
+  template <class Archive, class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, ParallelData<T> & data )
+  {
+    parallel_detail::load( ar, data.container, data.threads, parallel_detail::is_chunked_input<Archive>() );
+  }
+} // namespace cereal
+
+#endif // CEREAL_TYPES_PARALLEL_HPP_
@@ -194,31 +194,58 @@ namespace cereal
     //! Get an input binding from the given archive by deserializing the type meta data
     /*! @internal */
     template<class Archive> inline
-    typename ::cereal::detail::InputBindingMap<Archive>::Serializers getInputBinding(Archive & ar, std::uint32_t const nameid)
+    typename ::cereal::detail::InputBindingMap<Archive>::Serializers const & getInputBinding(Archive & ar, std::uint32_t const nameid)
     {
+      using Serializers = typename ::cereal::detail::InputBindingMap<Archive>::Serializers;
+
       // If the nameid is zero, we serialized a null pointer
       if(nameid == 0)
       {
-        typename ::cereal::detail::InputBindingMap<Archive>::Serializers emptySerializers;
-        emptySerializers.shared_ptr = [](void*, std::shared_ptr<void> & ptr, std::type_info const &) { ptr.reset(); };
-        emptySerializers.unique_ptr = [](void*, std::unique_ptr<void, ::cereal::detail::EmptyDeleter<void>> & ptr, std::type_info const &) { ptr.reset( nullptr ); };
+        static Serializers const emptySerializers = []()
+        {
+          Serializers serializers;
+          serializers.shared_ptr = [](void*, std::shared_ptr<void> & ptr, std::type_info const &) { ptr.reset(); };
+          serializers.unique_ptr = [](void*, std::unique_ptr<void, ::cereal::detail::EmptyDeleter<void>> & ptr, std::type_info const &) { ptr.reset( nullptr ); };
+          return serializers;
+        }();
         return emptySerializers;
       }
 
+      // The archive remembers the binding for each type it has loaded, so the map is only searched once per type
+      if(!(nameid & detail::msb_32bit))
+        return *static_cast<Serializers const *>(ar.getPolymorphicBinding(nameid));
+
       std::string name;
-      if(nameid & detail::msb_32bit)
-      {
-        ar( CEREAL_NVP_("polymorphic_name", name) );
-        ar.registerPolymorphicName(nameid, name);
-      }
-      else
-        name = ar.getPolymorphicName(nameid);
+      ar( CEREAL_NVP_("polymorphic_name", name) );
 
       auto const & bindingMap = detail::StaticObject<detail::InputBindingMap<Archive>>::getInstance().map;
 
       auto binding = bindingMap.find(name);
       if(binding == bindingMap.end())
         UNREGISTERED_POLYMORPHIC_EXCEPTION(load, name)
+
+      ar.registerPolymorphicName(nameid, name, &binding->second);
+      return binding->second;
+    }
+
+    //! Get the output binding for the dynamic type of a polymorphic object
+    /*! @internal */
+    template<class Archive> inline
+    typename ::cereal::detail::OutputBindingMap<Archive>::Serializers const & getOutputBinding(Archive & ar, std::type_info const & ptrinfo)
+    {
+      using Serializers = typename ::cereal::detail::OutputBindingMap<Archive>::Serializers;
+
+      // The archive remembers the binding for each type it has saved, so the map is only searched once per type
+      if(auto cached = ar.getPolymorphicBinding(ptrinfo))
+        return *static_cast<Serializers const *>(cached);
+
+      auto const & bindingMap = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().map;
+
+      auto binding = bindingMap.find(std::type_index(ptrinfo));
+      if(binding == bindingMap.end())
+        UNREGISTERED_POLYMORPHIC_EXCEPTION(save, cereal::util::demangle(ptrinfo.name()))
+
+      ar.registerPolymorphicBinding(ptrinfo, &binding->second);
       return binding->second;
     }
 
@@ -317,13 +344,7 @@ namespace cereal
     // of an abstract object
     //  this implies we need to do the lookup
 
-    auto const & bindingMap = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().map;
-
-    auto binding = bindingMap.find(std::type_index(ptrinfo));
-    if(binding == bindingMap.end())
-      UNREGISTERED_POLYMORPHIC_EXCEPTION(save, cereal::util::demangle(ptrinfo.name()))
-
-    binding->second.shared_ptr(&ar, ptr.get(), tinfo);
+    polymorphic_detail::getOutputBinding(ar, ptrinfo).shared_ptr(&ar, ptr.get(), tinfo);
   }
 
   //! Saving std::shared_ptr for polymorphic types, not abstract
@@ -352,13 +373,7 @@ namespace cereal
       return;
     }
 
-    auto const & bindingMap = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().map;
-
-    auto binding = bindingMap.find(std::type_index(ptrinfo));
-    if(binding == bindingMap.end())
-      UNREGISTERED_POLYMORPHIC_EXCEPTION(save, cereal::util::demangle(ptrinfo.name()))
-
-    binding->second.shared_ptr(&ar, ptr.get(), tinfo);
+    polymorphic_detail::getOutputBinding(ar, ptrinfo).shared_ptr(&ar, ptr.get(), tinfo);
   }
 
   //! Loading std::shared_ptr for polymorphic types
@@ -373,7 +388,7 @@ namespace cereal
     if(polymorphic_detail::serialize_wrapper(ar, ptr, nameid))
       return;
 
-    auto binding = polymorphic_detail::getInputBinding(ar, nameid);
+    auto const & binding = polymorphic_detail::getInputBinding(ar, nameid);
     std::shared_ptr<void> result;
     binding.shared_ptr(&ar, result, typeid(T));
     ptr = std::static_pointer_cast<T>(result);
@@ -416,13 +431,7 @@ namespace cereal
     // of an abstract object
     //  this implies we need to do the lookup
 
-    auto const & bindingMap = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().map;
-
-    auto binding = bindingMap.find(std::type_index(ptrinfo));
-    if(binding == bindingMap.end())
-      UNREGISTERED_POLYMORPHIC_EXCEPTION(save, cereal::util::demangle(ptrinfo.name()))
-
-    binding->second.unique_ptr(&ar, ptr.get(), tinfo);
+    polymorphic_detail::getOutputBinding(ar, ptrinfo).unique_ptr(&ar, ptr.get(), tinfo);
   }
 
   //! Saving std::unique_ptr for polymorphic types, not abstract
@@ -451,13 +460,7 @@ namespace cereal
       return;
     }
 
-    auto const & bindingMap = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().map;
-
-    auto binding = bindingMap.find(std::type_index(ptrinfo));
-    if(binding == bindingMap.end())
-      UNREGISTERED_POLYMORPHIC_EXCEPTION(save, cereal::util::demangle(ptrinfo.name()))
-
-    binding->second.unique_ptr(&ar, ptr.get(), tinfo);
+    polymorphic_detail::getOutputBinding(ar, ptrinfo).unique_ptr(&ar, ptr.get(), tinfo);
   }
 
   //! Loading std::unique_ptr, case when user provides load_and_construct for polymorphic types
@@ -472,7 +475,7 @@ namespace cereal
     if(polymorphic_detail::serialize_wrapper(ar, ptr, nameid))
       return;
 
-    auto binding = polymorphic_detail::getInputBinding(ar, nameid);
+    auto const & binding = polymorphic_detail::getInputBinding(ar, nameid);
     std::unique_ptr<void, ::cereal::detail::EmptyDeleter<void>> result;
     binding.unique_ptr(&ar, result, typeid(T));
     ptr.reset(static_cast<T*>(result.release()));
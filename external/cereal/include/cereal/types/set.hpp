@@ -59,7 +59,7 @@ namespace cereal
       auto hint = set.begin();
       for( size_type i = 0; i < size; ++i )
       {
-        typename SetT::key_type key;
+        auto key = detail::makeWithAllocator<typename SetT::key_type>( set.get_allocator() );
 
         ar( key );
         #ifdef CEREAL_OLDER_GCC
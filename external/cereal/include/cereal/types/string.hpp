@@ -33,6 +33,10 @@
 #include "cereal/cereal.hpp"
 #include <string>
 
+#ifdef CEREAL_HAS_CPP17
+#include <string_view>
+#endif
+
 namespace cereal
 {
   //! Serialization for basic_string types, if binary data is supported
@@ -55,6 +59,34 @@ namespace cereal
     str.resize(static_cast<std::size_t>(size));
     ar( binary_data( const_cast<CharT *>( str.data() ), static_cast<std::size_t>(size) * sizeof(CharT) ) );
   }
+
+#ifdef CEREAL_HAS_CPP17
+  //! Saving for basic_string_view types, if binary data is supported
+  /*! The output is identical to that of the equivalent std::basic_string */
+  template<class Archive, class CharT, class Traits> inline
+  typename std::enable_if<traits::is_output_serializable<BinaryData<CharT>, Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(Archive & ar, std::basic_string_view<CharT, Traits> const & str)
+  {
+    // Save number of chars + the data
+    ar( make_size_tag( static_cast<size_type>(str.size()) ) );
+    ar( binary_data( str.data(), str.size() * sizeof(CharT) ) );
+  }
+
+  //! Loading for basic_string_view types from archives reading contiguous memory
+  /*! The loaded view points directly into the memory the archive reads from and
+      is only valid for as long as that memory is.  Limited to single byte
+      characters, as the archive gives no alignment guarantees.
+      \sa traits::ContiguousInputArchive */
+  template<class Archive, class CharT, class Traits> inline
+  typename std::enable_if<traits::is_contiguous_input_archive<Archive>::value && sizeof(CharT) == 1, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(Archive & ar, std::basic_string_view<CharT, Traits> & str)
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+    auto const data = ar.borrowBinary( static_cast<std::size_t>(size) );
+    str = std::basic_string_view<CharT, Traits>( static_cast<CharT const *>( data ), static_cast<std::size_t>(size) );
+  }
+#endif // CEREAL_HAS_CPP17
 } // namespace cereal
 
 #endif // CEREAL_TYPES_STRING_HPP_
@@ -59,7 +59,7 @@ namespace cereal
 
       for( size_type i = 0; i < size; ++i )
       {
-        typename SetT::key_type key;
+        auto key = detail::makeWithAllocator<typename SetT::key_type>( set.get_allocator() );
 
         ar( key );
         set.emplace( std::move( key ) );
@@ -35,33 +35,53 @@
 
 namespace cereal
 {
-  //! Serialization for std::vectors of arithmetic (but not bool) using binary serialization, if supported
+  //! Serialization for std::vectors of memcpy serializable types (e.g. arithmetic, but not bool) using binary serialization, if supported
   template <class Archive, class T, class A> inline
   typename std::enable_if<traits::is_output_serializable<BinaryData<T>, Archive>::value
-                          && std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, void>::type
+                          && traits::is_memcpy_serializable<T>::value && !std::is_same<T, bool>::value, void>::type
   CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::vector<T, A> const & vector )
   {
     ar( make_size_tag( static_cast<size_type>(vector.size()) ) ); // number of elements
-    ar( binary_data( vector.data(), vector.size() * sizeof(T) ) );
+    common_detail::saveMemcpy( ar, vector.data(), vector.size() );
   }
 
-  //! Serialization for std::vectors of arithmetic (but not bool) using binary serialization, if supported
+  //! Serialization for std::vectors of memcpy serializable types (e.g. arithmetic, but not bool) using binary serialization, if supported
+  /*! When the vector needs to grow, elements are loaded a chunk at a time and appended,
+      which avoids value initializing them before they are overwritten. */
   template <class Archive, class T, class A> inline
   typename std::enable_if<traits::is_input_serializable<BinaryData<T>, Archive>::value
-                          && std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, void>::type
+                          && traits::is_memcpy_serializable<T>::value && !std::is_same<T, bool>::value, void>::type
   CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::vector<T, A> & vector )
   {
     size_type vectorSize;
     ar( make_size_tag( vectorSize ) );
 
-    vector.resize( static_cast<std::size_t>( vectorSize ) );
-    ar( binary_data( vector.data(), static_cast<std::size_t>( vectorSize ) * sizeof(T) ) );
+    auto const size = static_cast<std::size_t>( vectorSize );
+    if( size <= vector.size() )
+    {
+      vector.resize( size );
+      common_detail::loadMemcpy( ar, vector.data(), size );
+      return;
+    }
+
+    vector.clear();
+    vector.reserve( size );
+
+    static const std::size_t chunkSize = common_detail::memcpy_chunk_size<T>::value;
+    T chunk[chunkSize];
+
+    for( std::size_t loaded = 0; loaded < size; loaded += chunkSize )
+    {
+      auto const count = size - loaded < chunkSize ? size - loaded : chunkSize;
+      common_detail::loadMemcpy( ar, chunk, count );
+      vector.insert( vector.end(), chunk, chunk + count );
+    }
   }
 
-  //! Serialization for non-arithmetic vector types
+  //! Serialization for non memcpy serializable vector types
   template <class Archive, class T, class A> inline
   typename std::enable_if<(!traits::is_output_serializable<BinaryData<T>, Archive>::value
-                          || !std::is_arithmetic<T>::value) && !std::is_same<T, bool>::value, void>::type
+                          || !traits::is_memcpy_serializable<T>::value) && !std::is_same<T, bool>::value, void>::type
   CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::vector<T, A> const & vector )
   {
     ar( make_size_tag( static_cast<size_type>(vector.size()) ) ); // number of elements
@@ -69,10 +89,10 @@ namespace cereal
       ar( v );
   }
 
-  //! Serialization for non-arithmetic vector types
+  //! Serialization for non memcpy serializable vector types
   template <class Archive, class T, class A> inline
   typename std::enable_if<(!traits::is_input_serializable<BinaryData<T>, Archive>::value
-                          || !std::is_arithmetic<T>::value) && !std::is_same<T, bool>::value, void>::type
+                          || !traits::is_memcpy_serializable<T>::value) && !std::is_same<T, bool>::value, void>::type
   CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::vector<T, A> & vector )
   {
     size_type size;
@@ -0,0 +1,167 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include <cereal/archives/compact_binary.hpp>
+
+// only the test types are used, not the test framework
+#define DOCTEST_CONFIG_DISABLE
+#include "../unittests/common.hpp"
+
+//! Size and timing of saving and loading one data set with one archive pair
+struct Measurement
+{
+  size_t size = 0;
+  std::chrono::nanoseconds save{0};
+  std::chrono::nanoseconds load{0};
+};
+
+//! Saves and loads data numAverages times, returning the archive size and the average times
+template <class IArchive, class OArchive, class T>
+Measurement measure( T const & data, size_t numAverages )
+{
+  Measurement result;
+
+  for( size_t i = 0; i < numAverages; ++i )
+  {
+    std::ostringstream os;
+    auto start = std::chrono::high_resolution_clock::now();
+    {
+      OArchive oar(os);
+      oar( data );
+    }
+    result.save += std::chrono::high_resolution_clock::now() - start;
+
+    std::istringstream is( os.str() );
+    result.size = os.str().size();
+
+    T loaded;
+    start = std::chrono::high_resolution_clock::now();
+    {
+      IArchive iar(is);
+      iar( loaded );
+    }
+    result.load += std::chrono::high_resolution_clock::now() - start;
+  }
+
+  result.save /= numAverages;
+  result.load /= numAverages;
+  return result;
+}
+
+//! Compares the compact binary archive against the portable binary archive for some data
+template <class T>
+void compare( std::string const & name, T const & data, size_t numAverages = 100 )
+{
+  auto const portable = measure<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>( data, numAverages );
+  auto const compact  = measure<cereal::CompactBinaryInputArchive, cereal::CompactBinaryOutputArchive>( data, numAverages );
+
+  auto const us = []( std::chrono::nanoseconds t ) { return static_cast<double>( t.count() ) / 1000.0; };
+
+  std::cout << std::left << std::setw(36) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << portable.size << std::setw(12) << compact.size
+            << std::setw(8) << 100.0 * static_cast<double>( compact.size ) / static_cast<double>( portable.size ) << '%'
+            << std::setw(12) << us( portable.save ) << std::setw(12) << us( compact.save )
+            << std::setw(12) << us( portable.load ) << std::setw(12) << us( compact.load ) << std::endl;
+}
+
+int main()
+{
+  std::mt19937 gen( 5489u );
+  auto small = [&]() { return std::uniform_int_distribution<int>( -1000, 1000 )(gen); };
+
+  std::cout << std::left << std::setw(36) << "data" << std::right
+            << std::setw(12) << "portable B" << std::setw(12) << "compact B" << std::setw(9) << "ratio"
+            << std::setw(12) << "p save us" << std::setw(12) << "c save us"
+            << std::setw(12) << "p load us" << std::setw(12) << "c load us" << std::endl;
+
+  {
+    std::vector<StructInternalSerialize> data( 100000 );
+    for( auto & d : data )
+      d = StructInternalSerialize( small(), small() );
+    compare( "vector<Struct>, small ints", data );
+  }
+
+  {
+    std::vector<StructInternalSerialize> data( 100000 );
+    for( auto & d : data )
+      d = StructInternalSerialize( random_value<int>(gen), random_value<int>(gen) );
+    compare( "vector<Struct>, random ints", data );
+  }
+
+  {
+    std::vector<std::uint64_t> data( 100000 );
+    for( auto & d : data )
+      d = static_cast<std::uint64_t>( std::abs( small() ) );
+    compare( "vector<uint64_t>, small counts", data );
+  }
+
+  {
+    std::vector<double> data( 100000 );
+    for( auto & d : data )
+      d = random_value<double>(gen);
+    compare( "vector<double>", data );
+  }
+
+  {
+    std::vector<std::string> data( 20000 );
+    for( auto & d : data )
+      d = random_value<std::string>(gen);
+    compare( "vector<string>", data );
+  }
+
+  {
+    std::map<std::string, int> data;
+    for( size_t i = 0; i < 20000; ++i )
+      data.emplace( random_value<std::string>(gen), small() );
+    compare( "map<string, int>", data );
+  }
+
+  {
+    std::vector<std::vector<int>> data( 10000 );
+    for( auto & d : data )
+    {
+      d.resize( random_index( 0, 8, gen ) );
+      for( auto & i : d )
+        i = small();
+    }
+    compare( "vector<vector<int>>, short", data );
+  }
+
+  {
+    std::vector<std::shared_ptr<StructInternalSplit>> data( 20000 );
+    for( auto & d : data )
+      d = std::make_shared<StructInternalSplit>( small(), small() );
+    compare( "vector<shared_ptr<Struct>>", data );
+  }
+
+  return 0;
+}
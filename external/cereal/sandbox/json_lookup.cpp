@@ -0,0 +1,139 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cereal/archives/json.hpp>
+
+//! An object with many named members, loaded in a configurable order
+struct Wide
+{
+  std::vector<std::string> const * names;
+  std::vector<std::size_t> const * order;
+  std::vector<int> values;
+
+  template <class Archive>
+  void save( Archive & ar ) const
+  {
+    for( std::size_t i = 0; i < values.size(); ++i )
+      ar( cereal::make_nvp( (*names)[i], values[i] ) );
+  }
+
+  template <class Archive>
+  void load( Archive & ar )
+  {
+    for( auto i : *order )
+      ar( cereal::make_nvp( (*names)[i], values[i] ) );
+  }
+};
+
+//! Repeatedly runs f and returns the average time in milliseconds
+template <class F>
+double milliseconds( F && f, std::size_t numAverages = 5 )
+{
+  auto const start = std::chrono::high_resolution_clock::now();
+  for( std::size_t i = 0; i < numAverages; ++i )
+    f();
+  std::chrono::duration<double, std::milli> const elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  return elapsed.count() / static_cast<double>( numAverages );
+}
+
+//! Loads objects with the given number of members from a stream and, if available, in-situ
+void measure( std::size_t objects, std::size_t members, bool shuffled, std::mt19937 & gen )
+{
+  std::vector<std::string> names( members );
+  for( std::size_t i = 0; i < members; ++i )
+    names[i] = "member_" + std::to_string( i );
+
+  std::vector<std::size_t> order( members );
+  for( std::size_t i = 0; i < members; ++i )
+    order[i] = i;
+  if( shuffled )
+    std::shuffle( order.begin(), order.end(), gen );
+
+  std::vector<Wide> data( objects, Wide{ &names, &order, {} } );
+  for( auto & d : data )
+  {
+    d.values.resize( members );
+    for( auto & v : d.values )
+      v = static_cast<int>( gen() % 100000 );
+  }
+
+  std::ostringstream os;
+  {
+    cereal::JSONOutputArchive oar(os);
+    for( auto const & d : data )
+      oar( d );
+  }
+  auto const json = os.str();
+
+  auto loaded = data;
+  auto const stream = milliseconds( [&]()
+  {
+    std::istringstream is( json );
+    cereal::JSONInputArchive iar(is);
+    for( auto & d : loaded )
+      iar( d );
+  } );
+
+  std::cout << std::setw(8) << objects << std::setw(9) << members << std::setw(10) << ( shuffled ? "shuffled" : "in order" )
+            << std::fixed << std::setprecision(2) << std::setw(12) << stream;
+
+#ifndef CEREAL_JSON_LOOKUP_NO_INSITU
+  std::vector<char> buffer;
+  auto const insitu = milliseconds( [&]()
+  {
+    buffer.assign( json.begin(), json.end() );
+    buffer.push_back( '\0' );
+    cereal::JSONInputArchive iar( buffer.data() );
+    for( auto & d : loaded )
+      iar( d );
+  } );
+  std::cout << std::setw(12) << insitu;
+#endif
+
+  std::cout << std::endl;
+}
+
+int main()
+{
+  std::mt19937 gen( 5489u );
+
+  std::cout << " objects  members     order   stream ms   insitu ms" << std::endl;
+  for( std::size_t members : { 8, 32, 256, 1024 } )
+    for( bool shuffled : { false, true } )
+      measure( ( 1 << 18 ) / members, members, shuffled, gen );
+
+  return 0;
+}
@@ -0,0 +1,151 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __unix__
+#include <sys/resource.h>
+#endif
+
+#include <cereal/archives/json.hpp>
+#include <cereal/archives/json_stream.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+struct Record
+{
+  std::uint64_t id;
+  std::string name;
+  double score;
+  std::vector<int> tags;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( CEREAL_NVP(id), CEREAL_NVP(name), CEREAL_NVP(score), CEREAL_NVP(tags) );
+  }
+};
+
+//! Returns the peak resident set size of this process in MiB, or 0 if unknown
+double peakMemory()
+{
+#ifdef __unix__
+  rusage usage;
+  getrusage( RUSAGE_SELF, &usage );
+  return static_cast<double>( usage.ru_maxrss ) / 1024;
+#else
+  return 0;
+#endif
+}
+
+//! Loads the records in a file one at a time, as an export would be consumed
+template <class IArchive>
+void load( std::string const & file, std::size_t records )
+{
+  std::ifstream is( file );
+
+  auto const start = std::chrono::high_resolution_clock::now();
+  std::size_t loaded = 0;
+  {
+    IArchive iar(is);
+    cereal::size_type size;
+    iar.startNode();
+    iar( cereal::make_size_tag( size ) );
+
+    Record record;
+    for( ; loaded < size; ++loaded )
+      iar( record );
+    iar.finishNode();
+  }
+  std::chrono::duration<double, std::milli> const elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  if( loaded != records )
+    std::cout << "loaded " << loaded << " of " << records << " records" << std::endl;
+
+  std::cout << std::fixed << std::setprecision(1) << std::setw(10) << elapsed.count() << std::setw(14) << peakMemory() << std::endl;
+}
+
+//! Saves records to a file
+void generate( std::string const & file, std::size_t records )
+{
+  std::mt19937 gen( 5489u );
+  std::vector<Record> data( records );
+  for( std::size_t i = 0; i < records; ++i )
+  {
+    data[i].id = i;
+    data[i].name = "record " + std::to_string( gen() );
+    data[i].score = std::uniform_real_distribution<double>( 0, 100 )(gen);
+    data[i].tags.resize( gen() % 8 );
+    for( auto & t : data[i].tags )
+      t = static_cast<int>( gen() % 1000 );
+  }
+
+  std::ofstream os( file );
+  cereal::JSONOutputArchive oar(os);
+  oar( data );
+}
+
+//! Without arguments, generates files and loads each of them in a new process so that peak memory is measured separately
+int main( int argc, char * argv[] )
+{
+  if( argc == 4 )
+  {
+    auto const records = static_cast<std::size_t>( std::stoull( argv[3] ) );
+    if( std::string( argv[2] ) == "document" )
+      load<cereal::JSONInputArchive>( argv[1], records );
+    else
+      load<cereal::JSONStreamInputArchive>( argv[1], records );
+    return 0;
+  }
+
+  for( std::size_t records : { 10000, 100000, 1000000 } )
+  {
+    std::string const file = "json_stream_" + std::to_string( records ) + ".json";
+    generate( file, records );
+
+    std::ifstream is( file, std::ios::ate );
+    std::cout << records << " records, " << is.tellg() / ( 1024 * 1024 ) << " MiB of json"
+              << std::setw(14) << "ms" << std::setw(14) << "peak MiB" << std::endl;
+
+    for( std::string archive : { "document", "streaming" } )
+    {
+      std::cout << "  " << std::left << std::setw(20) << archive << std::right << std::flush;
+      std::system( ( std::string( argv[0] ) + " " + file + " " + archive + " " + std::to_string( records ) ).c_str() );
+    }
+
+    std::remove( file.c_str() );
+  }
+
+  return 0;
+}
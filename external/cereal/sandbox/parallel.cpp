@@ -0,0 +1,156 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/types/parallel.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+struct Record
+{
+  std::uint64_t id;
+  std::string name;
+  double score;
+  std::vector<int> tags;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( id, name, score, tags );
+  }
+};
+
+//! Runs f a few times and returns the shortest time in ms
+template <class F>
+double best( F && f, int runs = 3 )
+{
+  double shortest = 0;
+  for( int i = 0; i < runs; ++i )
+  {
+    auto const start = std::chrono::high_resolution_clock::now();
+    f();
+    std::chrono::duration<double, std::milli> const elapsed = std::chrono::high_resolution_clock::now() - start;
+    shortest = i == 0 ? elapsed.count() : std::min( shortest, elapsed.count() );
+  }
+  return shortest;
+}
+
+//! Saves and loads the records with the wrapper at each thread count, and without it
+template <class IArchive, class OArchive>
+void measure( std::string const & name, std::vector<Record> const & records )
+{
+  std::cout << name << std::setw(30 - name.size()) << "save ms" << std::setw(10) << "MB/s"
+            << std::setw(10) << "load ms" << std::setw(10) << "MB/s" << std::endl;
+
+  auto const report = [&]( std::string const & label, std::size_t bytes, double saveMs, double loadMs )
+  {
+    std::cout << "  " << std::left << std::setw(18) << label << std::right << std::fixed << std::setprecision(0)
+              << std::setw(10) << saveMs << std::setw(10) << bytes / saveMs / 1e3
+              << std::setw(10) << loadMs << std::setw(10) << bytes / loadMs / 1e3 << std::endl;
+  };
+
+  {
+    std::string saved;
+    auto const saveMs = best( [&]()
+    {
+      std::ostringstream os;
+      {
+        OArchive oar(os);
+        oar( records );
+      }
+      saved = os.str();
+    } );
+
+    auto const loadMs = best( [&]()
+    {
+      std::vector<Record> loaded;
+      std::istringstream is( saved );
+      IArchive iar(is);
+      iar( loaded );
+    } );
+
+    report( "sequential", saved.size(), saveMs, loadMs );
+  }
+
+  for( std::size_t threads : {1, 2, 4, 8, 16} )
+  {
+    std::string saved;
+    auto const saveMs = best( [&]()
+    {
+      std::ostringstream os;
+      {
+        OArchive oar(os);
+        oar( cereal::make_parallel( records, threads ) );
+      }
+      saved = os.str();
+    } );
+
+    auto const loadMs = best( [&]()
+    {
+      std::vector<Record> loaded;
+      std::istringstream is( saved );
+      IArchive iar(is);
+      iar( cereal::make_parallel( loaded, threads ) );
+    } );
+
+    report( std::to_string( threads ) + " threads", saved.size(), saveMs, loadMs );
+  }
+}
+
+//! Serializes a vector of records sequentially and in parallel chunks
+/*! The number of records can be given as the first argument */
+int main( int argc, char * argv[] )
+{
+  std::size_t const count = argc > 1 ? static_cast<std::size_t>( std::stoull( argv[1] ) ) : 2000000;
+
+  std::mt19937 gen( 5489u );
+  std::vector<Record> records( count );
+  for( std::size_t i = 0; i < count; ++i )
+  {
+    records[i].id = i;
+    records[i].name = "record " + std::to_string( gen() );
+    records[i].score = std::uniform_real_distribution<double>( 0, 100 )(gen);
+    records[i].tags.resize( gen() % 8 );
+    for( auto & t : records[i].tags )
+      t = static_cast<int>( gen() % 1000 );
+  }
+
+  std::cout << count << " records, " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+  measure<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>( "binary", records );
+  measure<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>( "portable binary", records );
+
+  return 0;
+}
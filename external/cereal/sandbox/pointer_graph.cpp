@@ -0,0 +1,191 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/memory.hpp>
+#include <cereal/types/polymorphic.hpp>
+#include <cereal/types/vector.hpp>
+
+//! A node in a graph, holding shared pointers to its neighbours
+struct Node
+{
+  std::uint32_t id;
+  std::vector<std::shared_ptr<Node>> edges;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( id, edges );
+  }
+};
+
+struct Shape
+{
+  virtual ~Shape() = default;
+  float x, y;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( x, y );
+  }
+};
+
+struct Circle : Shape
+{
+  float radius;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( cereal::base_class<Shape>( this ), radius );
+  }
+};
+
+struct Rectangle : Shape
+{
+  float width, height;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( cereal::base_class<Shape>( this ), width, height );
+  }
+};
+
+struct Square : Rectangle
+{
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( cereal::base_class<Rectangle>( this ) );
+  }
+};
+
+CEREAL_REGISTER_TYPE(Circle)
+CEREAL_REGISTER_TYPE(Rectangle)
+CEREAL_REGISTER_TYPE(Square)
+
+//! Runs f a few times and returns the shortest time in ms
+template <class F>
+double best( F && f, int runs = 5 )
+{
+  double shortest = 0;
+  for( int i = 0; i < runs; ++i )
+  {
+    auto const start = std::chrono::high_resolution_clock::now();
+    f();
+    std::chrono::duration<double, std::milli> const elapsed = std::chrono::high_resolution_clock::now() - start;
+    shortest = i == 0 ? elapsed.count() : std::min( shortest, elapsed.count() );
+  }
+  return shortest;
+}
+
+//! Saves and loads data, reporting the time per pointer
+template <class T>
+void measure( std::string const & name, T const & data, std::size_t pointers )
+{
+  std::string saved;
+  auto const saveMs = best( [&]()
+  {
+    std::ostringstream os;
+    {
+      cereal::BinaryOutputArchive oar(os);
+      oar( data );
+    }
+    saved = os.str();
+  } );
+
+  auto const loadMs = best( [&]()
+  {
+    T loaded;
+    std::istringstream is( saved );
+    cereal::BinaryInputArchive iar(is);
+    iar( loaded );
+  } );
+
+  std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << saveMs * 1e6 / pointers << std::setw(12) << loadMs * 1e6 / pointers << std::endl;
+}
+
+//! Serializes pointer heavy data: a graph of shared nodes and a list of polymorphic shapes
+/*! The number of nodes and shapes can be given as the first argument */
+int main( int argc, char * argv[] )
+{
+  std::size_t const count = argc > 1 ? static_cast<std::size_t>( std::stoull( argv[1] ) ) : 200000;
+  std::mt19937 gen( 5489u );
+
+  // every node is referred to by the list and by some nodes in the layer before it, which keeps
+  // the recursion while saving the first node to the number of layers
+  std::size_t const layer = std::max<std::size_t>( count / 16, 1 );
+  std::vector<std::shared_ptr<Node>> graph( count );
+  for( std::size_t i = 0; i < count; ++i )
+  {
+    graph[i] = std::make_shared<Node>();
+    graph[i]->id = static_cast<std::uint32_t>( i );
+  }
+
+  std::size_t edges = 0;
+  for( std::size_t i = 0; i + layer < count; ++i )
+  {
+    auto const next = ( i / layer + 1 ) * layer;
+    graph[i]->edges.resize( gen() % 8 );
+    for( auto & edge : graph[i]->edges )
+      edge = graph[next + gen() % std::min( layer, count - next )];
+    edges += graph[i]->edges.size();
+  }
+
+  std::vector<std::shared_ptr<Shape>> shapes( count );
+  std::vector<std::unique_ptr<Shape>> uniqueShapes( count );
+  for( std::size_t i = 0; i < count; ++i )
+  {
+    switch( gen() % 3 )
+    {
+      case 0: shapes[i] = std::make_shared<Circle>(); uniqueShapes[i].reset( new Circle ); break;
+      case 1: shapes[i] = std::make_shared<Rectangle>(); uniqueShapes[i].reset( new Rectangle ); break;
+      default: shapes[i] = std::make_shared<Square>(); uniqueShapes[i].reset( new Square ); break;
+    }
+  }
+
+  std::cout << count << " nodes with " << edges << " edges, " << count << " shapes" << std::endl
+            << std::left << std::setw(22) << "" << std::right << std::setw(12) << "save ns/ptr" << std::setw(12) << "load ns/ptr" << std::endl;
+
+  measure( "graph", graph, count + edges );
+  measure( "polymorphic shared", shapes, count );
+  measure( "polymorphic unique", uniqueShapes, count );
+
+  return 0;
+}
@@ -0,0 +1,159 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/types/array.hpp>
+#include <cereal/types/vector.hpp>
+
+//! Repeatedly runs f and returns the throughput in MB/s for processing bytes each time
+template <class F>
+double throughput( std::size_t bytes, F && f, size_t numAverages = 20 )
+{
+  auto const start = std::chrono::high_resolution_clock::now();
+  for( size_t i = 0; i < numAverages; ++i )
+    f();
+  std::chrono::duration<double> const elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  return static_cast<double>( bytes * numAverages ) / elapsed.count() / 1e6;
+}
+
+//! Saves data with an output archive constructed from os and options
+template <class OArchive, class T, class ... Options>
+std::string save( T const & data, Options && ... options )
+{
+  std::ostringstream os;
+  {
+    OArchive oar(os, std::forward<Options>(options)...);
+    oar( data );
+  }
+  return os.str();
+}
+
+//! Measures save and load throughput for one archive configuration
+template <class IArchive, class OArchive, class T, class ... Options>
+void measure( std::string const & name, T const & data, std::size_t bytes, Options const & ... options )
+{
+  auto const saved = save<OArchive>( data, options... );
+
+  auto const saveRate = throughput( bytes, [&]() { save<OArchive>( data, options... ); } );
+
+  std::unique_ptr<T> loaded( new T() );
+  std::istringstream is;
+  auto const loadRate = throughput( bytes, [&]()
+  {
+    is.str( saved );
+    IArchive iar(is);
+    iar( *loaded );
+  } );
+
+  std::cout << "  " << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(0)
+            << std::setw(10) << saveRate << std::setw(10) << loadRate << std::endl;
+}
+
+//! Compares binary, portable binary without conversion and portable binary with byte swapping
+template <class T>
+void compare( std::string const & name, T const & data, std::size_t bytes )
+{
+  auto const opposite = cereal::portable_binary_detail::is_little_endian() ?
+    cereal::PortableBinaryOutputArchive::Options::BigEndian() :
+    cereal::PortableBinaryOutputArchive::Options::LittleEndian();
+
+  std::cout << name << " (" << bytes / 1024 << " KiB)" << std::setw(38 - name.size()) << "save MB/s" << std::setw(10) << "load MB/s" << std::endl;
+  measure<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>( "binary", data, bytes );
+  measure<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>( "portable binary, native", data, bytes );
+  measure<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>( "portable binary, swapped", data, bytes, opposite );
+}
+
+//! Compares swapping a block element by element with the kernel picked for this machine
+template <std::size_t DataSize>
+void compare_kernels( std::size_t bytes )
+{
+  std::vector<std::uint8_t> data( bytes );
+
+  auto const elementwise = throughput( bytes, [&]()
+  {
+    for( std::size_t i = 0; i < bytes; i += DataSize )
+      cereal::portable_binary_detail::swap_bytes<DataSize>( data.data() + i );
+  }, 100 );
+  auto const scalar = throughput( bytes, [&]()
+  { cereal::portable_binary_detail::swap_bytes_block_scalar<DataSize>( data.data(), bytes ); }, 100 );
+  auto const selected = throughput( bytes, [&]()
+  { cereal::portable_binary_detail::swap_bytes_block<DataSize>( data.data(), bytes ); }, 100 );
+
+  std::cout << "  " << DataSize << " byte elements" << std::fixed << std::setprecision(0)
+            << std::setw(16) << elementwise << std::setw(10) << scalar << std::setw(10) << selected << std::endl;
+}
+
+int main()
+{
+  std::mt19937 gen( 5489u );
+  std::size_t const count = 1 << 20;
+
+  std::cout << "byte swap kernels, MB/s" << std::setw(17) << "per element" << std::setw(10) << "scalar" << std::setw(10) << "selected" << std::endl;
+  compare_kernels<2>( count * 8 );
+  compare_kernels<4>( count * 8 );
+  compare_kernels<8>( count * 8 );
+  std::cout << std::endl;
+
+  {
+    std::vector<double> data( count );
+    for( auto & d : data )
+      d = std::uniform_real_distribution<double>( -1e6, 1e6 )(gen);
+    compare( "vector<double>", data, data.size() * sizeof(double) );
+  }
+
+  {
+    std::vector<std::uint32_t> data( count );
+    for( auto & d : data )
+      d = static_cast<std::uint32_t>( gen() );
+    compare( "vector<uint32_t>", data, data.size() * sizeof(std::uint32_t) );
+  }
+
+  {
+    std::vector<std::uint16_t> data( count );
+    for( auto & d : data )
+      d = static_cast<std::uint16_t>( gen() );
+    compare( "vector<uint16_t>", data, data.size() * sizeof(std::uint16_t) );
+  }
+
+  {
+    std::unique_ptr<std::array<std::uint32_t, 1 << 18>> data( new std::array<std::uint32_t, 1 << 18>() );
+    for( auto & d : *data )
+      d = static_cast<std::uint32_t>( gen() );
+    compare( "array<uint32_t, 2^18>", *data, sizeof(*data) );
+  }
+
+  return 0;
+}
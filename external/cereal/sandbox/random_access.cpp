@@ -0,0 +1,171 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/archives/random_access.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+struct Record
+{
+  std::uint64_t id;
+  std::string name;
+  double score;
+  std::vector<int> tags;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( id, name, score, tags );
+  }
+};
+
+//! Runs f a few times and returns the shortest time in ms
+template <class F>
+double best( F && f, int runs = 3 )
+{
+  double shortest = 0;
+  for( int i = 0; i < runs; ++i )
+  {
+    auto const start = std::chrono::high_resolution_clock::now();
+    f();
+    std::chrono::duration<double, std::milli> const elapsed = std::chrono::high_resolution_clock::now() - start;
+    shortest = i == 0 ? elapsed.count() : std::min( shortest, elapsed.count() );
+  }
+  return shortest;
+}
+
+//! Compares loading a whole snapshot with looking up single records in it
+/*! Each lookup opens the file and reads its index first.  The number of records can be given
+    as the first argument */
+int main( int argc, char * argv[] )
+{
+  std::size_t const count = argc > 1 ? static_cast<std::size_t>( std::stoull( argv[1] ) ) : 2000000;
+
+  std::mt19937 gen( 5489u );
+  std::vector<Record> records( count );
+  std::map<std::string, std::uint64_t> byName;
+  for( std::size_t i = 0; i < count; ++i )
+  {
+    records[i].id = i;
+    records[i].name = "record " + std::to_string( gen() );
+    records[i].score = std::uniform_real_distribution<double>( 0, 100 )(gen);
+    records[i].tags.resize( gen() % 8 );
+    for( auto & t : records[i].tags )
+      t = static_cast<int>( gen() % 1000 );
+    byName.emplace( records[i].name, i );
+  }
+
+  std::string const binaryFile = "random_access_binary.bin";
+  std::string const randomFile = "random_access_indexed.bin";
+
+  auto const binarySave = best( [&]()
+  {
+    std::ofstream os( binaryFile, std::ios::binary );
+    cereal::BinaryOutputArchive oar(os);
+    oar( records, byName );
+  } );
+
+  auto const randomSave = best( [&]()
+  {
+    std::ofstream os( randomFile, std::ios::binary );
+    cereal::RandomAccessOutputArchive oar(os);
+    oar( cereal::make_nvp( "records", records ), cereal::make_nvp( "byName", byName ) );
+  } );
+
+  std::cout << count << " records" << std::endl
+            << std::fixed << std::setprecision(3)
+            << "save binary:                  " << binarySave << " ms" << std::endl
+            << "save random access:           " << randomSave << " ms" << std::endl;
+
+  auto const fullLoad = best( [&]()
+  {
+    std::vector<Record> loaded;
+    std::map<std::string, std::uint64_t> loadedByName;
+    std::ifstream is( binaryFile, std::ios::binary );
+    cereal::BinaryInputArchive iar(is);
+    iar( loaded, loadedByName );
+  } );
+  std::cout << "full load, binary:            " << fullLoad << " ms" << std::endl;
+
+  Record last;
+  auto const element = best( [&]()
+  {
+    std::ifstream is( randomFile, std::ios::binary );
+    cereal::RandomAccessInputArchive iar(is);
+    iar.loadElement( "records", count - 1, last );
+  } );
+  std::cout << "open and load last element:   " << element << " ms" << std::endl;
+
+  std::vector<Record> slice;
+  auto const range = best( [&]()
+  {
+    std::ifstream is( randomFile, std::ios::binary );
+    cereal::RandomAccessInputArchive iar(is);
+    iar.loadElements( "records", count / 2, 1000, slice );
+  } );
+  std::cout << "open and load 1000 elements:  " << range << " ms" << std::endl;
+
+  std::uint64_t found = 0;
+  auto const key = records[count / 3].name;
+  auto const lookup = best( [&]()
+  {
+    std::ifstream is( randomFile, std::ios::binary );
+    cereal::RandomAccessInputArchive iar(is);
+    iar.loadMapValue( "byName", key, found );
+  } );
+  std::cout << "open and look up a map key:   " << lookup << " ms" << std::endl;
+
+  std::ifstream is( randomFile, std::ios::binary );
+  cereal::RandomAccessInputArchive iar(is);
+  auto const many = best( [&]()
+  {
+    for( std::size_t i = 0; i < 10000; ++i )
+    {
+      Record r;
+      iar.loadElement( "records", gen() % count, r );
+    }
+  } );
+  std::cout << "10000 random elements:        " << many << " ms" << std::endl;
+
+  if( last.id != count - 1 || slice.front().id != count / 2 || found != count / 3 )
+    std::cout << "unexpected result" << std::endl;
+
+  std::remove( binaryFile.c_str() );
+  std::remove( randomFile.c_str() );
+
+  return 0;
+}
@@ -0,0 +1,148 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/vector.hpp>
+
+struct Point
+{
+  float x, y, z;
+
+  template <class Archive>
+  void serialize( Archive & ar, std::uint32_t const )
+  {
+    ar( x, y, z );
+  }
+};
+
+struct Shape
+{
+  std::uint32_t id;
+  Point center;
+  std::vector<Point> corners;
+
+  template <class Archive>
+  void serialize( Archive & ar, std::uint32_t const version )
+  {
+    ar( id, center );
+    if( version > 0 )
+      ar( corners );
+  }
+};
+
+CEREAL_CLASS_VERSION(Point, 2)
+CEREAL_CLASS_VERSION(Shape, 1)
+
+//! Saves and loads the shapes once on each of threads threads, each with its own archives, returning the time in ms
+double run( std::vector<Shape> const & shapes, std::size_t threads )
+{
+  auto const start = std::chrono::high_resolution_clock::now();
+
+  std::vector<std::thread> workers;
+  for( std::size_t t = 0; t < threads; ++t )
+    workers.emplace_back( [&]()
+    {
+      std::ostringstream os;
+      {
+        cereal::BinaryOutputArchive oar(os);
+        for( auto const & shape : shapes )
+          oar( shape );
+      }
+
+      std::istringstream is( os.str() );
+      cereal::BinaryInputArchive iar(is);
+      Shape shape;
+      for( std::size_t i = 0; i < shapes.size(); ++i )
+        iar( shape );
+    } );
+
+  for( auto & worker : workers )
+    worker.join();
+
+  std::chrono::duration<double, std::milli> const elapsed = std::chrono::high_resolution_clock::now() - start;
+  return elapsed.count();
+}
+
+//! Serializes many small versioned objects with independent archives on an increasing number of threads
+/*! Each thread does the same amount of work, so with linear scaling the time stays constant
+    as long as there are enough hardware threads.  The number of shapes per thread can be
+    given as the first argument */
+int main( int argc, char * argv[] )
+{
+  std::size_t const count = argc > 1 ? static_cast<std::size_t>( std::stoull( argv[1] ) ) : 200000;
+
+  std::vector<Shape> shapes( count );
+  for( std::size_t i = 0; i < count; ++i )
+  {
+    shapes[i].id = static_cast<std::uint32_t>( i );
+    shapes[i].center = { 1.0f * i, 2.0f * i, 3.0f * i };
+    shapes[i].corners.resize( i % 4 + 1, shapes[i].center );
+  }
+
+  // each shape saves 1 + corners.size() + 1 versioned objects
+  std::size_t objects = 0;
+  for( auto const & shape : shapes )
+    objects += shape.corners.size() + 2;
+
+  auto const hardware = std::max( 1u, std::thread::hardware_concurrency() );
+  std::cout << count << " shapes (" << objects << " versioned objects) per thread, "
+            << hardware << " hardware threads" << std::endl
+            << std::setw(8) << "threads" << std::setw(12) << "ms" << std::setw(16) << "ns/object"
+            << std::setw(12) << "speedup" << std::setw(14) << "efficiency" << std::endl;
+
+  double single = 0;
+  for( std::size_t threads : {1, 2, 4, 8, 16} )
+  {
+    double shortest = 0;
+    for( int i = 0; i < 3; ++i )
+    {
+      auto const ms = run( shapes, threads );
+      shortest = i == 0 ? ms : std::min( shortest, ms );
+    }
+
+    if( threads == 1 )
+      single = shortest;
+
+    // the best possible speedup is limited by the hardware threads
+    auto const speedup = single * threads / shortest;
+    std::cout << std::fixed << std::setprecision(2)
+              << std::setw(8) << threads << std::setw(12) << shortest
+              << std::setw(16) << shortest * 1e6 / ( objects * threads )
+              << std::setw(12) << speedup
+              << std::setw(13) << 100 * speedup / std::min<std::size_t>( threads, hardware ) << "%" << std::endl;
+  }
+
+  return 0;
+}
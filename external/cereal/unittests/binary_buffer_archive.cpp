@@ -0,0 +1,150 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "binary_buffer_archive.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+  std::atomic<std::size_t> allocationCount{0};
+}
+
+// count every allocation made by this test executable
+void * operator new( std::size_t size )
+{
+  ++allocationCount;
+  if( void * ptr = std::malloc( size ? size : 1 ) )
+    return ptr;
+  throw std::bad_alloc();
+}
+
+// gcc sees the replaced operator new in the delete expressions these are inlined into, not malloc
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete( void * ptr ) noexcept
+{
+  std::free( ptr );
+}
+
+void operator delete( void * ptr, std::size_t ) noexcept
+{
+  std::free( ptr );
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+TEST_SUITE_BEGIN("binary_buffer_archive");
+
+TEST_CASE("binary_buffer_roundtrip")
+{
+  test_binary_buffer_roundtrip();
+}
+
+TEST_CASE("binary_buffer_multiple_archives")
+{
+  std::vector<char> buffer;
+  {
+    cereal::BinaryBufferOutputArchive oar(buffer);
+    oar( std::uint32_t{7}, std::string("first") );
+  }
+  {
+    cereal::BinaryBufferOutputArchive oar(buffer);
+    oar( std::uint32_t{8}, std::string("second") );
+  }
+
+  std::uint32_t i_first = 0, i_second = 0;
+  std::string   s_first, s_second;
+
+  cereal::BinaryBufferInputArchive first(buffer);
+  first( i_first, s_first );
+
+  cereal::BinaryBufferInputArchive second( buffer.data() + first.position(), buffer.size() - first.position() );
+  second( i_second, s_second );
+
+  CHECK_EQ( i_first, 7 );
+  CHECK_EQ( s_first, "first" );
+  CHECK_EQ( i_second, 8 );
+  CHECK_EQ( s_second, "second" );
+  CHECK_EQ( first.position() + second.position(), buffer.size() );
+}
+
+TEST_CASE("binary_buffer_out_of_range")
+{
+  std::vector<char> buffer;
+  {
+    cereal::BinaryBufferOutputArchive oar(buffer);
+    oar( std::vector<double>( 10, 1.0 ) );
+  }
+  buffer.resize( buffer.size() - 1 );
+
+  std::vector<double> i_vector;
+  cereal::BinaryBufferInputArchive iar(buffer);
+  CHECK_THROWS_AS( iar( i_vector ), cereal::Exception );
+}
+
+TEST_CASE("binary_buffer_steady_state_allocations")
+{
+  std::vector<char> buffer;
+  std::vector<std::uint64_t> o_vector( 256, 0xCAFE );
+  std::vector<std::uint64_t> i_vector;
+  std::string const o_string( "short" );
+  std::string i_string;
+
+  auto roundtrip = [&]()
+  {
+    buffer.clear();
+    {
+      cereal::BinaryBufferOutputArchive oar(buffer);
+      oar( o_vector, o_string );
+    }
+    {
+      cereal::BinaryBufferInputArchive iar(buffer);
+      iar( i_vector, i_string );
+    }
+  };
+
+  // the first pass sizes the buffer and the loaded containers
+  roundtrip();
+
+  auto const before = allocationCount.load();
+  for( int ii = 0; ii < 100; ++ii )
+    roundtrip();
+
+  CHECK_EQ( allocationCount.load(), before );
+  CHECK_EQ( i_vector, o_vector );
+  CHECK_EQ( i_string, o_string );
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,124 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_BINARY_BUFFER_ARCHIVE_H_
+#define CEREAL_TEST_BINARY_BUFFER_ARCHIVE_H_
+#include "common.hpp"
+#include <cereal/archives/binary_buffer.hpp>
+
+struct BinaryBufferData
+{
+  int                                  i = 0;
+  double                               d = 0;
+  std::string                          s;
+  std::vector<float>                   v;
+  std::map<std::string, std::uint16_t> m;
+  std::shared_ptr<StructInternalSplit> p;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( CEREAL_NVP(i), CEREAL_NVP(d), CEREAL_NVP(s), CEREAL_NVP(v), CEREAL_NVP(m), CEREAL_NVP(p) );
+  }
+
+  bool operator==( BinaryBufferData const & other ) const
+  {
+    return i == other.i && d == other.d && s == other.s && v == other.v && m == other.m &&
+           ( p == other.p || ( p && other.p && *p == *other.p ) );
+  }
+};
+
+inline std::ostream & operator<<( std::ostream & os, BinaryBufferData const & b )
+{
+  return os << "[i: " << b.i << " d: " << b.d << " s: " << b.s << " v: " << b.v.size() << " m: " << b.m.size() << "]";
+}
+
+inline BinaryBufferData random_binary_buffer_data( std::mt19937 & gen )
+{
+  BinaryBufferData data;
+  data.i = random_value<int>(gen);
+  data.d = random_value<double>(gen);
+  data.s = random_value<std::string>(gen);
+  data.v.resize( random_index( 0, 100, gen ) );
+  for( auto & f : data.v )
+    f = random_value<float>(gen);
+  for( size_t j = 0, n = random_index( 0, 10, gen ); j < n; ++j )
+    data.m.emplace( random_value<std::string>(gen), random_value<std::uint16_t>(gen) );
+  if( random_value<int>(gen) % 2 )
+    data.p = std::make_shared<StructInternalSplit>( random_value<int>(gen), random_value<int>(gen) );
+  return data;
+}
+
+// Saves with both the stream and the buffer based binary archives, which must agree byte for byte,
+// then loads the buffer with each of the two input archives
+inline void test_binary_buffer_roundtrip()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<char> buffer;
+  for( int ii = 0; ii < 100; ++ii )
+  {
+    auto const o_data = random_binary_buffer_data( gen );
+    auto const o_int  = random_value<std::int64_t>(gen);
+
+    std::ostringstream os;
+    {
+      cereal::BinaryOutputArchive oar(os);
+      oar( o_data, o_int );
+    }
+
+    buffer.clear();
+    {
+      cereal::BinaryBufferOutputArchive oar(buffer);
+      oar( o_data, o_int );
+    }
+
+    CHECK_EQ( std::string( buffer.begin(), buffer.end() ), os.str() );
+
+    BinaryBufferData i_data;
+    std::int64_t     i_int = 0;
+    {
+      cereal::BinaryBufferInputArchive iar(buffer);
+      iar( i_data, i_int );
+      CHECK_EQ( iar.position(), buffer.size() );
+    }
+
+    CHECK_EQ( i_data, o_data );
+    CHECK_EQ( i_int, o_int );
+
+    BinaryBufferData i_data_stream;
+    std::istringstream is( std::string( buffer.begin(), buffer.end() ) );
+    {
+      cereal::BinaryInputArchive iar(is);
+      iar( i_data_stream );
+    }
+
+    CHECK_EQ( i_data_stream, o_data );
+  }
+}
+
+#endif // CEREAL_TEST_BINARY_BUFFER_ARCHIVE_H_
@@ -53,6 +53,7 @@
 #include <cereal/archives/portable_binary.hpp>
 #include <cereal/archives/xml.hpp>
 #include <cereal/archives/json.hpp>
+#include <cstdint>
 #include <limits>
 #include <random>
 
@@ -69,6 +70,16 @@ namespace std
   }
 }
 
+// Character types other than char can no longer be printed to an ostream in C++20, which
+// CHECK_EQ does with the values it compares, so those are compared as integers
+template <class T> inline
+T const & checkable( T const & t )
+{ return t; }
+
+inline std::uint_least32_t checkable( wchar_t t ) { return static_cast<std::uint_least32_t>( t ); }
+inline std::uint_least32_t checkable( char16_t t ) { return t; }
+inline std::uint_least32_t checkable( char32_t t ) { return t; }
+
 // Checks that collections have equal size and all elements are the same
 template <class T> inline
 void check_collection( T const & a, T const & b )
@@ -81,7 +92,7 @@ void check_collection( T const & a, T const & b )
   CHECK_EQ( std::distance(aIter, aEnd), std::distance(bIter, bEnd) );
 
   for( ; aIter != aEnd; ++aIter, ++bIter )
-    CHECK_EQ( *aIter, *bIter );
+    CHECK_EQ( checkable( *aIter ), checkable( *bIter ) );
 }
 
 template <class T> inline
@@ -147,6 +158,17 @@ std::string random_binary_string(std::mt19937 & gen)
   return s;
 }
 
+// A string buffer that, like a pipe, cannot be repositioned
+class unseekable_stringbuf : public std::stringbuf
+{
+  public:
+    unseekable_stringbuf( std::string const & str ) : std::stringbuf( str, std::ios_base::in ) {}
+
+  protected:
+    pos_type seekoff( off_type, std::ios_base::seekdir, std::ios_base::openmode ) override { return pos_type( off_type( -1 ) ); }
+    pos_type seekpos( pos_type, std::ios_base::openmode ) override { return pos_type( off_type( -1 ) ); }
+};
+
 // Generic struct useful for testing many serialization functions
 struct StructBase
 {
@@ -0,0 +1,104 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "compact_binary_archive.hpp"
+#include "pod.hpp"
+#include "vector.hpp"
+#include "map.hpp"
+#include "basic_string.hpp"
+#include "structs.hpp"
+#include "memory.hpp"
+#include "polymorphic.hpp"
+#include "versioning.hpp"
+
+TEST_SUITE_BEGIN("compact_binary_archive");
+
+TEST_CASE("compact_binary_encoding")
+{
+  test_compact_encoding();
+}
+
+TEST_CASE("compact_binary_limits")
+{
+  test_compact_limits<std::int16_t>();
+  test_compact_limits<std::uint16_t>();
+  test_compact_limits<std::int32_t>();
+  test_compact_limits<std::uint32_t>();
+  test_compact_limits<std::int64_t>();
+  test_compact_limits<std::uint64_t>();
+  test_compact_limits<wchar_t>();
+  test_compact_limits<char16_t>();
+  test_compact_limits<char32_t>();
+  test_compact_limits<double>();
+}
+
+TEST_CASE("compact_binary_range_errors")
+{
+  test_compact_range_errors();
+}
+
+TEST_CASE("compact_binary_pod")
+{
+  test_pod<cereal::CompactBinaryInputArchive, cereal::CompactBinaryOutputArchive>();
+}
+
+TEST_CASE("compact_binary_vector")
+{
+  test_vector<cereal::CompactBinaryInputArchive, cereal::CompactBinaryOutputArchive>();
+}
+
+TEST_CASE("compact_binary_map")
+{
+  test_map<cereal::CompactBinaryInputArchive, cereal::CompactBinaryOutputArchive>();
+}
+
+TEST_CASE("compact_binary_string")
+{
+  test_string_all<cereal::CompactBinaryInputArchive, cereal::CompactBinaryOutputArchive>();
+}
+
+TEST_CASE("compact_binary_structs")
+{
+  test_structs<cereal::CompactBinaryInputArchive, cereal::CompactBinaryOutputArchive>();
+}
+
+TEST_CASE("compact_binary_memory")
+{
+  test_memory<cereal::CompactBinaryInputArchive, cereal::CompactBinaryOutputArchive>();
+}
+
+TEST_CASE("compact_binary_polymorphic")
+{
+  test_polymorphic<cereal::CompactBinaryInputArchive, cereal::CompactBinaryOutputArchive>();
+}
+
+TEST_CASE("compact_binary_versioning")
+{
+  test_versioning<cereal::CompactBinaryInputArchive, cereal::CompactBinaryOutputArchive>();
+}
+
+TEST_SUITE_END();
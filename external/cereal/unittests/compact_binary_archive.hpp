@@ -0,0 +1,125 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_COMPACT_BINARY_ARCHIVE_H_
+#define CEREAL_TEST_COMPACT_BINARY_ARCHIVE_H_
+#include <cereal/archives/compact_binary.hpp>
+#include "common.hpp"
+
+// Returns the number of bytes the compact binary archive uses to store value
+template <class T> inline
+size_t compact_size( T const & value )
+{
+  std::ostringstream os;
+  {
+    cereal::CompactBinaryOutputArchive oar(os);
+    oar( value );
+  }
+  return os.str().size();
+}
+
+// Saves value and loads it back as a U
+template <class U, class T> inline
+U compact_roundtrip( T const & value )
+{
+  std::ostringstream os;
+  {
+    cereal::CompactBinaryOutputArchive oar(os);
+    oar( value );
+  }
+
+  U result{};
+  std::istringstream is( os.str() );
+  {
+    cereal::CompactBinaryInputArchive iar(is);
+    iar( result );
+  }
+  return result;
+}
+
+template <class T> inline
+void test_compact_limits()
+{
+  CHECK_EQ( checkable( compact_roundtrip<T>( std::numeric_limits<T>::lowest() ) ), checkable( std::numeric_limits<T>::lowest() ) );
+  CHECK_EQ( checkable( compact_roundtrip<T>( std::numeric_limits<T>::max() ) ), checkable( std::numeric_limits<T>::max() ) );
+  CHECK_EQ( checkable( compact_roundtrip<T>( T{0} ) ), checkable( T{0} ) );
+  CHECK_EQ( checkable( compact_roundtrip<T>( T{1} ) ), checkable( T{1} ) );
+}
+
+inline void test_compact_encoding()
+{
+  // small integers take a single byte, whatever their type
+  CHECK_EQ( compact_size( std::uint64_t{0} ), 1 );
+  CHECK_EQ( compact_size( std::uint64_t{127} ), 1 );
+  CHECK_EQ( compact_size( std::uint64_t{128} ), 2 );
+  CHECK_EQ( compact_size( std::int32_t{-1} ), 1 );
+  CHECK_EQ( compact_size( std::int32_t{63} ), 1 );
+  CHECK_EQ( compact_size( std::int32_t{-64} ), 1 );
+  CHECK_EQ( compact_size( std::int32_t{64} ), 2 );
+  CHECK_EQ( compact_size( std::numeric_limits<std::uint64_t>::max() ), 10 );
+  CHECK_EQ( compact_size( std::numeric_limits<std::int64_t>::lowest() ), 10 );
+
+  // one byte types and floating point keep their size
+  CHECK_EQ( compact_size( true ), 1 );
+  CHECK_EQ( compact_size( 'x' ), 1 );
+  CHECK_EQ( compact_size( 1.0f ), 4 );
+  CHECK_EQ( compact_size( 1.0 ), 8 );
+
+  // size tags are varints as well
+  CHECK_EQ( compact_size( std::string("abc") ), 4 );
+  CHECK_EQ( compact_size( std::vector<int>{ 1, -1, 300 } ), 1 + 1 + 1 + 2 );
+  CHECK_EQ( compact_size( std::vector<double>( 3 ) ), 1 + 3 * 8 );
+
+  // floating point is always stored as little endian
+  std::ostringstream os;
+  {
+    cereal::CompactBinaryOutputArchive oar(os);
+    oar( 1.0f );
+  }
+  CHECK_EQ( os.str(), std::string( "\x00\x00\x80\x3f", 4 ) );
+}
+
+inline void test_compact_range_errors()
+{
+  CHECK_THROWS_AS( compact_roundtrip<std::uint16_t>( std::uint32_t{70000} ), cereal::Exception );
+  CHECK_THROWS_AS( compact_roundtrip<std::int16_t>( std::int32_t{-40000} ), cereal::Exception );
+  CHECK_THROWS_AS( compact_roundtrip<std::uint32_t>( std::uint64_t{1} << 40 ), cereal::Exception );
+  CHECK_EQ( compact_roundtrip<std::int64_t>( std::int16_t{-12345} ), -12345 );
+  CHECK_EQ( compact_roundtrip<std::uint64_t>( std::uint16_t{65535} ), 65535u );
+
+  // a varint that never terminates
+  std::istringstream is( std::string( 11, '\xff' ) );
+  cereal::CompactBinaryInputArchive iar(is);
+  std::uint64_t value;
+  CHECK_THROWS_AS( iar( value ), cereal::Exception );
+
+  // truncated input
+  std::istringstream truncated( std::string( 1, '\x80' ) );
+  cereal::CompactBinaryInputArchive tiar(truncated);
+  CHECK_THROWS_AS( tiar( value ), cereal::Exception );
+}
+
+#endif // CEREAL_TEST_COMPACT_BINARY_ARCHIVE_H_
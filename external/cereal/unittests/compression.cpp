@@ -0,0 +1,71 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "compression.hpp"
+
+TEST_SUITE_BEGIN("compression");
+
+TEST_CASE("lz_codec")
+{
+  test_codec( cereal::LZCodec() );
+}
+
+#ifdef CEREAL_USE_ZLIB
+TEST_CASE("zlib_codec")
+{
+  test_codec( cereal::ZlibCodec() );
+}
+#endif // CEREAL_USE_ZLIB
+
+TEST_CASE("lz_codec_corrupt")
+{
+  cereal::LZCodec codec;
+  std::string const text( 1000, 'a' );
+  std::vector<char> compressed( codec.maxCompressedSize( text.size() ) );
+  compressed.resize( codec.compress( text.data(), text.size(), compressed.data() ) );
+
+  std::string decompressed( text.size(), '\0' );
+  // too short an output, a truncated input, and a match reaching before the start of the block
+  CHECK_THROWS_AS( codec.decompress( compressed.data(), compressed.size(), &decompressed[0], text.size() - 1 ), cereal::Exception );
+  CHECK_THROWS_AS( codec.decompress( compressed.data(), compressed.size() - 1, &decompressed[0], text.size() ), cereal::Exception );
+
+  char const badOffset[] = { 0x10, 'a', 0x05, 0x00 };
+  CHECK_THROWS_AS( codec.decompress( badOffset, sizeof(badOffset), &decompressed[0], 5 ), cereal::Exception );
+}
+
+TEST_CASE("binary_compressed")
+{
+  test_compressed_archive<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+TEST_CASE("portable_binary_compressed")
+{
+  test_compressed_archive<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,295 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_COMPRESSION_H_
+#define CEREAL_TEST_COMPRESSION_H_
+#include "common.hpp"
+
+struct CompressionData
+{
+  std::vector<std::int32_t>            ids;
+  std::vector<double>                  values;
+  std::vector<std::string>             names;
+  std::map<std::string, std::uint16_t> counts;
+  std::shared_ptr<StructInternalSplit> p1;
+  std::shared_ptr<StructInternalSplit> p2;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( ids, values, names, counts, p1, p2 );
+  }
+
+  bool operator==( CompressionData const & other ) const
+  {
+    return ids == other.ids && values == other.values && names == other.names && counts == other.counts &&
+           *p1 == *other.p1 && *p2 == *other.p2 && ( p1 == p2 ) == ( other.p1 == other.p2 );
+  }
+};
+
+inline std::ostream & operator<<( std::ostream & os, CompressionData const & c )
+{
+  return os << "[ids: " << c.ids.size() << " values: " << c.values.size() << " names: " << c.names.size() << "]";
+}
+
+//! Creates data that compresses well, as repeated names and small ids do
+inline CompressionData random_compression_data( std::mt19937 & gen, std::size_t size )
+{
+  std::vector<std::string> words;
+  for( int i = 0; i < 32; ++i )
+    words.push_back( random_basic_string<char>( gen ) );
+
+  CompressionData data;
+  for( std::size_t i = 0; i < size; ++i )
+  {
+    data.ids.push_back( static_cast<std::int32_t>( random_index( 0, 1000, gen ) ) );
+    data.values.push_back( static_cast<double>( random_index( 0, 10, gen ) ) / 4 );
+    data.names.push_back( words[random_index( 0, words.size() - 1, gen )] );
+  }
+  for( auto const & w : words )
+    data.counts[w] = random_value<std::uint16_t>( gen );
+
+  data.p1 = std::make_shared<StructInternalSplit>( random_value<int>( gen ), random_value<int>( gen ) );
+  data.p2 = data.p1;
+  return data;
+}
+
+//! Compresses bytes with codec and checks they decompress to the same bytes
+inline void check_codec_roundtrip( cereal::Codec const & codec, std::string const & bytes )
+{
+  std::vector<char> compressed( codec.maxCompressedSize( bytes.size() ) );
+  auto const size = codec.compress( bytes.data(), bytes.size(), compressed.data() );
+  REQUIRE( size <= compressed.size() );
+
+  std::string decompressed( bytes.size(), '\0' );
+  codec.decompress( compressed.data(), size, &decompressed[0], decompressed.size() );
+  CHECK( decompressed == bytes );
+}
+
+inline void test_codec( cereal::Codec const & codec )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  auto random_bytes = [&]( std::size_t size )
+  {
+    std::string bytes( size, '\0' );
+    for( auto & b : bytes )
+      b = static_cast<char>( random_value<std::uint8_t>( gen ) );
+    return bytes;
+  };
+
+  check_codec_roundtrip( codec, "" );
+  check_codec_roundtrip( codec, "a" );
+  check_codec_roundtrip( codec, "abcd" );
+  check_codec_roundtrip( codec, std::string( 100000, 'x' ) );
+  check_codec_roundtrip( codec, random_bytes( 100000 ) );
+
+  // matches at every distance, of every length, with long literal runs between them
+  auto mixed = random_bytes( 1 );
+  while( mixed.size() < 300000 )
+  {
+    auto const literals = random_bytes( random_index( 0, 600, gen ) );
+    mixed += literals;
+    auto const distance = random_index( 1, std::min<std::size_t>( mixed.size(), 70000 ), gen );
+    auto const length = random_index( 1, 1000, gen );
+    for( std::size_t i = 0; i < length; ++i )
+      mixed.push_back( mixed[mixed.size() - distance] );
+  }
+  check_codec_roundtrip( codec, mixed );
+
+  // repetitive data must get smaller
+  std::string text;
+  while( text.size() < 100000 )
+    text += "the quick brown fox jumps over the lazy dog " + std::to_string( text.size() % 97 );
+  std::vector<char> compressed( codec.maxCompressedSize( text.size() ) );
+  CHECK( codec.compress( text.data(), text.size(), compressed.data() ) < text.size() / 4 );
+}
+
+//! A run length codec, to test codecs defined outside of cereal
+class RunLengthCodec : public cereal::Codec
+{
+  public:
+    std::uint8_t id() const override { return 200; }
+
+    std::size_t maxCompressedSize( std::size_t size ) const override { return 2 * size; }
+
+    std::size_t compress( const char * src, std::size_t size, char * dst ) const override
+    {
+      auto const start = dst;
+      for( std::size_t i = 0; i < size; )
+      {
+        std::size_t run = 1;
+        while( i + run < size && run < 255 && src[i + run] == src[i] )
+          ++run;
+
+        *dst++ = static_cast<char>( run );
+        *dst++ = src[i];
+        i += run;
+      }
+      return static_cast<std::size_t>( dst - start );
+    }
+
+    void decompress( const char * src, std::size_t size, char * dst, std::size_t decompressedSize ) const override
+    {
+      auto const end = dst + decompressedSize;
+      for( std::size_t i = 0; i + 1 < size; i += 2 )
+      {
+        auto const run = static_cast<std::uint8_t>( src[i] );
+        if( run > end - dst )
+          throw cereal::Exception("Run length block is corrupt");
+        dst = std::fill_n( dst, run, src[i + 1] );
+      }
+
+      if( dst != end || size % 2 )
+        throw cereal::Exception("Run length block is corrupt");
+    }
+};
+
+//! Creates compressed archives, giving the portable archives options that make them swap bytes
+template <class Archive> struct CompressedArchive;
+
+template <> struct CompressedArchive<cereal::BinaryOutputArchive>
+{
+  static std::unique_ptr<cereal::BinaryOutputArchive> make( std::ostream & os, cereal::Compression const & compression )
+  { return std::unique_ptr<cereal::BinaryOutputArchive>( new cereal::BinaryOutputArchive( os, compression ) ); }
+};
+
+template <> struct CompressedArchive<cereal::BinaryInputArchive>
+{
+  static std::unique_ptr<cereal::BinaryInputArchive> make( std::istream & is, cereal::Compression const & compression )
+  { return std::unique_ptr<cereal::BinaryInputArchive>( new cereal::BinaryInputArchive( is, compression ) ); }
+};
+
+template <> struct CompressedArchive<cereal::PortableBinaryOutputArchive>
+{
+  static std::unique_ptr<cereal::PortableBinaryOutputArchive> make( std::ostream & os, cereal::Compression const & compression )
+  {
+    auto const options = cereal::PortableBinaryOutputArchive::Options::BigEndian();
+    return std::unique_ptr<cereal::PortableBinaryOutputArchive>( new cereal::PortableBinaryOutputArchive( os, options, compression ) );
+  }
+};
+
+template <> struct CompressedArchive<cereal::PortableBinaryInputArchive>
+{
+  static std::unique_ptr<cereal::PortableBinaryInputArchive> make( std::istream & is, cereal::Compression const & compression )
+  {
+    auto const options = cereal::PortableBinaryInputArchive::Options::LittleEndian();
+    return std::unique_ptr<cereal::PortableBinaryInputArchive>( new cereal::PortableBinaryInputArchive( is, options, compression ) );
+  }
+};
+
+template <class OArchive> inline
+std::string save_compressed( CompressionData const & data, cereal::Compression const & compression )
+{
+  std::ostringstream os;
+  {
+    auto oar = CompressedArchive<OArchive>::make( os, compression );
+    (*oar)( data, std::int32_t( 42 ) );
+  }
+  os << "tail";
+
+  return os.str();
+}
+
+template <class IArchive, class OArchive> inline
+void test_compressed_archive()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  auto const o_data = random_compression_data( gen, 20000 );
+
+  std::ostringstream uncompressed;
+  {
+    OArchive oar( uncompressed );
+    oar( o_data );
+  }
+
+  std::vector<cereal::Compression> compressions = {
+    cereal::Compression::LZ( 1 ),
+    cereal::Compression::LZ( 4 ),
+    cereal::Compression( std::make_shared<cereal::LZCodec>(), 1000, 3 ),
+    cereal::Compression( std::make_shared<RunLengthCodec>(), 4096, 2 ),
+    #ifdef CEREAL_USE_ZLIB
+    cereal::Compression::Zlib( 6, 2 ),
+    #endif
+  };
+
+  for( auto const & compression : compressions )
+  {
+    auto const saved = save_compressed<OArchive>( o_data, compression );
+
+    CompressionData i_data;
+    std::int32_t i_int = 0;
+    std::string i_tail( 4, ' ' );
+
+    std::istringstream is( saved );
+    {
+      auto iar = CompressedArchive<IArchive>::make( is, compression );
+      (*iar)( i_data, i_int );
+    }
+    // the input archive stops at the end of its blocks
+    is.read( &i_tail[0], 4 );
+
+    CHECK_EQ( i_data, o_data );
+    CHECK_EQ( i_int, 42 );
+    CHECK_EQ( i_tail, "tail" );
+
+    // neither the threads nor the block size used to load need to match
+    CompressionData i_data_one_thread;
+    std::istringstream is_one_thread( saved );
+    {
+      auto iar = CompressedArchive<IArchive>::make( is_one_thread, cereal::Compression( compression.codec, 1, 1 ) );
+      (*iar)( i_data_one_thread );
+    }
+    CHECK_EQ( i_data_one_thread, o_data );
+  }
+
+  CHECK_LT( save_compressed<OArchive>( o_data, cereal::Compression::LZ() ).size(), uncompressed.str().size() / 2 );
+
+  // the output does not depend on the number of threads
+  CHECK_EQ( save_compressed<OArchive>( o_data, cereal::Compression::LZ( 1 ) ),
+            save_compressed<OArchive>( o_data, cereal::Compression::LZ( 8 ) ) );
+
+  auto const saved = save_compressed<OArchive>( o_data, cereal::Compression::LZ() );
+  auto load = [&]( std::string const & data, cereal::Compression const & compression )
+  {
+    std::istringstream is( data );
+    auto iar = CompressedArchive<IArchive>::make( is, compression );
+    CompressionData i_data;
+    (*iar)( i_data );
+  };
+
+  CHECK_THROWS_AS( load( saved, cereal::Compression( std::make_shared<RunLengthCodec>() ) ), cereal::Exception );
+  CHECK_THROWS_AS( load( saved.substr( 0, saved.size() / 2 ), cereal::Compression::LZ() ), cereal::Exception );
+  CHECK_THROWS_AS( load( uncompressed.str(), cereal::Compression::LZ() ), cereal::Exception );
+
+  // no codec means no compression
+  CHECK_EQ( save_compressed<OArchive>( o_data, cereal::Compression::None() ).size(), uncompressed.str().size() + sizeof(std::int32_t) + 4 );
+}
+
+#endif // CEREAL_TEST_COMPRESSION_H_
@@ -0,0 +1,191 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_CPP17_MEMORY_RESOURCE_H_
+#define CEREAL_TEST_CPP17_MEMORY_RESOURCE_H_
+#include "../common.hpp"
+
+#ifdef CEREAL_HAS_MEMORY_RESOURCE
+#include <memory_resource>
+
+//! A resource that counts its allocations, to check what was allocated from it
+class CountingResource : public std::pmr::memory_resource
+{
+  public:
+    std::size_t allocations = 0;
+    std::size_t outstanding = 0;
+
+  private:
+    void * do_allocate( std::size_t bytes, std::size_t alignment ) override
+    {
+      ++allocations;
+      ++outstanding;
+      return std::pmr::new_delete_resource()->allocate( bytes, alignment );
+    }
+
+    void do_deallocate( void * p, std::size_t bytes, std::size_t alignment ) override
+    {
+      --outstanding;
+      std::pmr::new_delete_resource()->deallocate( p, bytes, alignment );
+    }
+
+    bool do_is_equal( std::pmr::memory_resource const & other ) const noexcept override
+    {
+      return this == &other;
+    }
+};
+
+//! Makes any allocation from the default resource throw while it is in scope
+struct NoDefaultResource
+{
+  NoDefaultResource() : previous( std::pmr::set_default_resource( std::pmr::null_memory_resource() ) ) {}
+  ~NoDefaultResource() { std::pmr::set_default_resource( previous ); }
+
+  std::pmr::memory_resource * previous;
+};
+
+//! A type loaded with load_and_construct that allocates from the archive's resource
+struct PmrConstructed
+{
+  PmrConstructed( std::pmr::string n ) : name( std::move( n ) ) {}
+
+  template <class Archive>
+  void save( Archive & ar ) const
+  {
+    ar( name );
+  }
+
+  template <class Archive>
+  static void load_and_construct( Archive & ar, cereal::construct<PmrConstructed> & construct )
+  {
+    std::pmr::string name( ar.getMemoryResource() );
+    ar( name );
+    construct( std::move( name ) );
+  }
+
+  std::pmr::string name;
+};
+
+template <class IArchive, class OArchive> inline
+void test_memory_resource()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  auto random_string = [&]() { return std::pmr::string( random_basic_string<char>(gen) ); };
+
+  std::pmr::string o_string = random_string();
+
+  std::pmr::vector<std::pmr::string> o_vector;
+  for( int i = 0; i < 20; ++i )
+    o_vector.push_back( random_string() );
+
+  std::pmr::map<std::pmr::string, std::pmr::vector<int>> o_map;
+  for( int i = 0; i < 20; ++i )
+    o_map[random_string()] = { random_value<int>(gen), random_value<int>(gen) };
+
+  std::pmr::unordered_map<int, std::pmr::string> o_unordered_map;
+  for( int i = 0; i < 20; ++i )
+    o_unordered_map[random_value<int>(gen)] = random_string();
+
+  std::pmr::list<std::pmr::string> o_list( o_vector.begin(), o_vector.end() );
+  std::pmr::deque<std::pmr::string> o_deque( o_vector.begin(), o_vector.end() );
+  std::pmr::set<std::pmr::string> o_set( o_vector.begin(), o_vector.end() );
+
+  auto o_shared = std::make_shared<std::pmr::vector<std::pmr::string>>( o_vector );
+  auto o_constructed = std::make_shared<PmrConstructed>( random_string() );
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+
+    oar(o_string, o_vector, o_map, o_unordered_map, o_list, o_deque, o_set);
+    oar(o_shared, o_shared, o_constructed);
+  }
+
+  CountingResource resource;
+  {
+    std::pmr::string i_string( &resource );
+    std::pmr::vector<std::pmr::string> i_vector( &resource );
+    std::pmr::map<std::pmr::string, std::pmr::vector<int>> i_map( &resource );
+    std::pmr::unordered_map<int, std::pmr::string> i_unordered_map( &resource );
+    std::pmr::list<std::pmr::string> i_list( &resource );
+    std::pmr::deque<std::pmr::string> i_deque( &resource );
+    std::pmr::set<std::pmr::string> i_set( &resource );
+
+    std::shared_ptr<std::pmr::vector<std::pmr::string>> i_shared;
+    std::shared_ptr<std::pmr::vector<std::pmr::string>> i_shared2;
+    std::shared_ptr<PmrConstructed> i_constructed;
+
+    std::istringstream is(os.str());
+    {
+      IArchive iar(is);
+      iar.setMemoryResource( &resource );
+      CHECK_EQ( iar.getMemoryResource(), &resource );
+
+      NoDefaultResource noDefault;
+
+      iar(i_string, i_vector, i_map, i_unordered_map, i_list, i_deque, i_set);
+
+      const auto containerAllocations = resource.allocations;
+      iar(i_shared, i_shared2, i_constructed);
+
+      // the objects and the control blocks of both pointers come from the resource
+      CHECK_GT( resource.allocations, containerAllocations + 4 );
+    }
+
+    CHECK_EQ( i_string, o_string );
+    CHECK_EQ( i_vector, o_vector );
+    CHECK_EQ( i_map, o_map );
+    CHECK_EQ( i_unordered_map, o_unordered_map );
+    CHECK_EQ( i_list, o_list );
+    CHECK_EQ( i_deque, o_deque );
+    CHECK_EQ( i_set, o_set );
+    CHECK_EQ( *i_shared, *o_shared );
+    CHECK_EQ( i_shared, i_shared2 );
+    CHECK_EQ( i_constructed->name, o_constructed->name );
+
+    // elements loaded into temporaries before being moved into their container use its resource
+    CHECK_EQ( i_map.begin()->first.get_allocator().resource(), &resource );
+    CHECK_EQ( i_map.begin()->second.get_allocator().resource(), &resource );
+    CHECK_EQ( i_unordered_map.begin()->second.get_allocator().resource(), &resource );
+    CHECK_EQ( i_set.begin()->get_allocator().resource(), &resource );
+    CHECK_EQ( i_vector.front().get_allocator().resource(), &resource );
+    CHECK_EQ( i_list.front().get_allocator().resource(), &resource );
+    CHECK_EQ( i_deque.front().get_allocator().resource(), &resource );
+
+    // loaded pointers pass allocator aware types an allocator using the resource
+    CHECK_EQ( i_shared->get_allocator().resource(), &resource );
+    CHECK_EQ( i_shared->front().get_allocator().resource(), &resource );
+    CHECK_EQ( i_constructed->name.get_allocator().resource(), &resource );
+  }
+
+  // everything allocated was given back when the loaded objects were destroyed
+  CHECK_EQ( resource.outstanding, 0 );
+}
+
+#endif // CEREAL_HAS_MEMORY_RESOURCE
+#endif // CEREAL_TEST_CPP17_MEMORY_RESOURCE_H_
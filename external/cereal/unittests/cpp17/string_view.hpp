@@ -0,0 +1,87 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_CPP17_STRING_VIEW_H_
+#define CEREAL_TEST_CPP17_STRING_VIEW_H_
+#include "../common.hpp"
+
+#ifdef CEREAL_HAS_CPP17
+#include <cereal/archives/binary_buffer.hpp>
+#include <string_view>
+
+inline void test_std_string_view()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<100; ++ii)
+  {
+    std::string const o_str1 = random_basic_string<char>(gen);
+    std::string const o_str2 = random_basic_string<char>(gen);
+    std::string_view const o_view1( o_str1 );
+    std::string_view const o_view2;
+
+    // a view is saved exactly like the string it refers to
+    std::ostringstream os;
+    {
+      cereal::BinaryOutputArchive oar(os);
+      oar(o_str1);
+      oar(o_view1);
+    }
+    CHECK_EQ( os.str().substr( 0, os.str().size() / 2 ), os.str().substr( os.str().size() / 2 ) );
+
+    std::vector<char> buffer;
+    {
+      cereal::BinaryBufferOutputArchive oar(buffer);
+      oar(o_view1);
+      oar(o_view2);
+      oar(o_str2);
+    }
+
+    std::string_view i_view1;
+    std::string_view i_view2;
+    std::string_view i_view3;
+    {
+      cereal::BinaryBufferInputArchive iar(buffer);
+      iar(i_view1);
+      iar(i_view2);
+      iar(i_view3);
+    }
+
+    CHECK_EQ( i_view1, o_view1 );
+    CHECK_EQ( i_view2, o_view2 );
+    CHECK_EQ( i_view3, o_str2 );
+
+    // the views must reference the buffer rather than copies of it
+    auto const inBuffer = [&]( std::string_view v )
+    { return v.data() >= buffer.data() && v.data() + v.size() <= buffer.data() + buffer.size(); };
+    CHECK( inBuffer( i_view1 ) );
+    CHECK( inBuffer( i_view3 ) );
+  }
+}
+
+#endif // CEREAL_HAS_CPP17
+#endif // CEREAL_TEST_CPP17_STRING_VIEW_H_
@@ -0,0 +1,305 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_DELTA_H_
+#define CEREAL_TEST_DELTA_H_
+#include "common.hpp"
+#include <cereal/archives/binary_buffer.hpp>
+#include <cereal/archives/delta.hpp>
+
+struct DeltaState
+{
+  std::string                                       name;
+  std::vector<StructInternalSerialize>              points;
+  std::vector<std::int64_t>                         values;
+  std::map<std::string, std::int32_t>               counts;
+  std::vector<std::shared_ptr<StructInternalSplit>> shared;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( CEREAL_NVP(name), CEREAL_NVP(points), CEREAL_NVP(values), CEREAL_NVP(counts), CEREAL_NVP(shared) );
+  }
+
+  bool operator==( DeltaState const & other ) const
+  {
+    if( shared.size() != other.shared.size() )
+      return false;
+    for( std::size_t i = 0; i < shared.size(); ++i )
+      if( !( *shared[i] == *other.shared[i] ) || ( i > 0 && ( shared[i] == shared[i - 1] ) != ( other.shared[i] == other.shared[i - 1] ) ) )
+        return false;
+
+    return name == other.name && points == other.points && values == other.values && counts == other.counts;
+  }
+};
+
+inline std::ostream & operator<<( std::ostream & os, DeltaState const & s )
+{
+  return os << "[" << s.name << " points: " << s.points.size() << " values: " << s.values.size() << " counts: " << s.counts.size() << "]";
+}
+
+inline DeltaState random_delta_state( std::mt19937 & gen )
+{
+  DeltaState s;
+  s.name = random_basic_string<char>( gen );
+
+  s.points.resize( 2000 );
+  for( auto & p : s.points )
+    p = StructInternalSerialize( random_value<int>( gen ), random_value<int>( gen ) );
+
+  s.values.resize( 5000 );
+  for( auto & v : s.values )
+    v = random_value<std::int64_t>( gen );
+
+  while( s.counts.size() < 1000 )
+    s.counts.emplace( random_basic_string<char>( gen ), random_value<std::int32_t>( gen ) );
+
+  // every other pointer is shared with the one before it
+  for( int i = 0; i < 500; ++i )
+    s.shared.push_back( i % 2 ? s.shared.back() : std::make_shared<StructInternalSplit>( random_value<int>( gen ), random_value<int>( gen ) ) );
+
+  return s;
+}
+
+//! Saves state as a delta against saved, returning the delta
+inline std::string save_delta( cereal::DeltaSnapshot & saved, DeltaState const & state )
+{
+  std::ostringstream os;
+  {
+    cereal::DeltaOutputArchive ar( os, saved );
+    ar( state );
+  }
+  return os.str();
+}
+
+//! Applies delta to loaded, checking that the result loads as state
+inline void check_delta( cereal::DeltaSnapshot & loaded, std::string const & delta, DeltaState const & state )
+{
+  std::istringstream is( delta );
+  loaded.apply( is );
+
+  DeltaState result;
+  {
+    cereal::BinaryBufferInputArchive ar( loaded.data() );
+    ar( result );
+  }
+  CHECK_EQ( result, state );
+}
+
+inline void test_delta_chain()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  auto state = random_delta_state( gen );
+
+  cereal::DeltaSnapshot saved;
+  cereal::DeltaSnapshot loaded;
+
+  // the first delta holds everything, in the format of the binary archive
+  auto const base = save_delta( saved, state );
+  check_delta( loaded, base, state );
+
+  std::ostringstream binary;
+  {
+    cereal::BinaryOutputArchive ar( binary );
+    ar( state );
+  }
+  auto const full = binary.str();
+  CHECK( std::string( saved.data().begin(), saved.data().end() ) == full );
+
+  // nothing changed
+  auto delta = save_delta( saved, state );
+  CHECK( delta.size() < 64 );
+  check_delta( loaded, delta, state );
+
+  // one element of each vector changed
+  state.points[1000].x += 1;
+  state.values[2500] += 1;
+  delta = save_delta( saved, state );
+  CHECK( delta.size() < 300 );
+  check_delta( loaded, delta, state );
+
+  // map entries inserted and erased in the middle of the map
+  state.counts.erase( std::next( state.counts.begin(), 500 ) );
+  state.counts.emplace( "inserted", 1 );
+  delta = save_delta( saved, state );
+  CHECK( delta.size() < 300 );
+  check_delta( loaded, delta, state );
+
+  // a shared object changed, and elements appended
+  state.shared[200]->y += 1;
+  state.points.emplace_back( 1, 2 );
+  state.values.push_back( 3 );
+  delta = save_delta( saved, state );
+  CHECK( delta.size() < 300 );
+  check_delta( loaded, delta, state );
+
+  // an element inserted at the front moves everything after it
+  state.name += "longer";
+  state.points.insert( state.points.begin(), StructInternalSerialize( 3, 4 ) );
+  delta = save_delta( saved, state );
+  CHECK( delta.size() < full.size() );
+  check_delta( loaded, delta, state );
+
+  // everything changed
+  state = random_delta_state( gen );
+  delta = save_delta( saved, state );
+  check_delta( loaded, delta, state );
+}
+
+inline void test_delta_applied_snapshot()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  auto state = random_delta_state( gen );
+
+  cereal::DeltaSnapshot saved;
+  cereal::DeltaSnapshot loaded;
+  check_delta( loaded, save_delta( saved, state ), state );
+
+  // a snapshot made by applying deltas has no values to match, but its bytes are still compared
+  state.values[100] = 0;
+  auto const delta = save_delta( loaded, state );
+  CHECK( delta.size() < 300 );
+
+  cereal::DeltaSnapshot other;
+  std::istringstream is( save_delta( other, random_delta_state( gen ) ) );
+  CHECK_THROWS_AS( other.apply( is ), cereal::Exception );
+  check_delta( saved, delta, state );
+}
+
+inline void test_delta_errors()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  cereal::DeltaSnapshot saved;
+  auto const base = save_delta( saved, random_delta_state( gen ) );
+  auto const delta = save_delta( saved, random_delta_state( gen ) );
+
+  // applying a delta to a snapshot it was not saved against
+  cereal::DeltaSnapshot loaded;
+  std::istringstream wrongBase( delta );
+  CHECK_THROWS_AS( loaded.apply( wrongBase ), cereal::Exception );
+
+  std::istringstream truncated( base.substr( 0, base.size() / 2 ) );
+  CHECK_THROWS_AS( loaded.apply( truncated ), cereal::Exception );
+
+  auto corrupt = base;
+  corrupt[corrupt.size() / 2] ^= 0x40;
+  std::istringstream corrupted( corrupt );
+  CHECK_THROWS_AS( loaded.apply( corrupted ), cereal::Exception );
+
+  // a result size far beyond what the delta holds
+  auto huge = base;
+  std::size_t sizeEnd = 5 + 1 + 8;
+  while( static_cast<unsigned char>( huge[sizeEnd] ) & 0x80 )
+    ++sizeEnd;
+  huge.replace( 5 + 1 + 8, sizeEnd + 1 - ( 5 + 1 + 8 ), "\xff\xff\xff\xff\xff\xff\xff\xff\x3f" );
+  std::istringstream hugeSize( huge );
+  CHECK_THROWS_AS( loaded.apply( hugeSize ), cereal::Exception );
+
+  // a huge result size and a literal as huge, holding only a few bytes
+  std::ostringstream hugeLiteral;
+  {
+    auto & buffer = *hugeLiteral.rdbuf();
+    buffer.sputn( cereal::delta_detail::header, sizeof( cereal::delta_detail::header ) );
+    cereal::delta_detail::writeVarint( buffer, 0 );
+    cereal::delta_detail::write64( buffer, cereal::delta_detail::hash( nullptr, 0 ) );
+    cereal::delta_detail::writeVarint( buffer, std::uint64_t( 1 ) << 62 );
+    cereal::delta_detail::write64( buffer, 0 );
+    cereal::delta_detail::writeVarint( buffer, cereal::delta_detail::Literal );
+    cereal::delta_detail::writeVarint( buffer, std::uint64_t( 1 ) << 62 );
+    buffer.sputn( "abc", 3 );
+  }
+  std::istringstream hugeLiteralIs( hugeLiteral.str() );
+  CHECK_THROWS_AS( loaded.apply( hugeLiteralIs ), cereal::Exception );
+
+  std::istringstream notDelta( "not a delta" );
+  CHECK_THROWS_AS( loaded.apply( notDelta ), cereal::Exception );
+
+  // failed deltas leave the snapshot as it was
+  CHECK( loaded.data().empty() );
+  std::istringstream is( base );
+  loaded.apply( is );
+  CHECK( !loaded.data().empty() );
+}
+
+// Saves a few values, then throws
+struct DeltaThrower
+{
+  template <class Archive>
+  void save( Archive & ar ) const
+  {
+    std::vector<std::int64_t> values( 100, 1 );
+    ar( CEREAL_NVP(values) );
+    throw std::runtime_error( "saving failed" );
+  }
+};
+
+inline void test_delta_throwing_save()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  auto const state = random_delta_state( gen );
+
+  cereal::DeltaSnapshot saved;
+  cereal::DeltaSnapshot loaded;
+  check_delta( loaded, save_delta( saved, state ), state );
+  auto const before = saved.data();
+
+  // an exception leaving the archive's scope leaves the stream and the snapshot as they were
+  std::ostringstream os;
+  try
+  {
+    cereal::DeltaOutputArchive ar( os, saved );
+    ar( state, DeltaThrower() );
+  }
+  catch( std::runtime_error const & ) {}
+
+  CHECK( os.str().empty() );
+  CHECK( os.good() );
+  CHECK( saved.data() == before );
+
+  // an exception caught within it leaves the stream bad, as the delta cannot be finished
+  {
+    cereal::DeltaOutputArchive ar( os, saved );
+    ar( state );
+    CHECK_THROWS_AS( ar( DeltaThrower() ), std::runtime_error );
+  }
+
+  CHECK( os.str().empty() );
+  CHECK( os.bad() );
+  CHECK( saved.data() == before );
+
+  // the snapshot is still the base for the next delta
+  check_delta( loaded, save_delta( saved, state ), state );
+}
+
+#endif // CEREAL_TEST_DELTA_H_
@@ -0,0 +1,93 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_JSON_ARCHIVE_H_
+#define CEREAL_TEST_JSON_ARCHIVE_H_
+#include "common.hpp"
+
+inline void test_json_insitu()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<100; ++ii)
+  {
+    std::map<std::string, std::vector<std::string>> o_map;
+    for( size_t i = 0, n = random_index( 0, 20, gen ); i < n; ++i )
+      o_map[random_value<std::string>(gen)].resize( random_index( 0, 5, gen ), random_value<std::string>(gen) );
+    auto const o_string = random_value<std::string>(gen);
+    auto const o_double = random_value<double>(gen);
+    auto const o_int    = random_value<std::int64_t>(gen);
+
+    std::ostringstream os;
+    {
+      cereal::JSONOutputArchive oar(os);
+      oar( cereal::make_nvp( "map", o_map ),
+           cereal::make_nvp( "string", o_string ),
+           cereal::make_nvp( "double", o_double ),
+           cereal::make_nvp( "int", o_int ) );
+    }
+
+    auto const json = os.str();
+    std::vector<char> buffer( json.begin(), json.end() );
+    buffer.push_back( '\0' );
+
+    std::map<std::string, std::vector<std::string>> i_map;
+    std::string i_string;
+    double i_double;
+    std::int64_t i_int;
+    {
+      cereal::JSONInputArchive iar( buffer.data() );
+      iar( cereal::make_nvp( "int", i_int ),
+           cereal::make_nvp( "map", i_map ),
+           cereal::make_nvp( "string", i_string ),
+           cereal::make_nvp( "double", i_double ) );
+    }
+
+    CHECK_EQ( i_map, o_map );
+    CHECK_EQ( i_string, o_string );
+    CHECK_EQ( i_double, doctest::Approx(o_double).epsilon(1e-5) );
+    CHECK_EQ( i_int, o_int );
+  }
+}
+
+// With duplicate names, searching finds the first one, with or without an index
+inline void test_json_duplicate_names( size_t members )
+{
+  std::string json = "{";
+  for( size_t i = 0; i < members; ++i )
+    json += "\"m" + std::to_string( i ) + "\": " + std::to_string( i ) + ", ";
+  json += "\"dup\": 1, \"dup\": 2}";
+
+  std::istringstream is( json );
+  cereal::JSONInputArchive iar( is );
+
+  int dup = 0;
+  iar( cereal::make_nvp( "dup", dup ) );
+  CHECK_EQ( dup, 1 );
+}
+
+#endif // CEREAL_TEST_JSON_ARCHIVE_H_
@@ -0,0 +1,117 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "json_stream_archive.hpp"
+#include "pod.hpp"
+#include "vector.hpp"
+#include "map.hpp"
+#include "basic_string.hpp"
+#include "structs.hpp"
+#include "memory.hpp"
+#include "polymorphic.hpp"
+#include "versioning.hpp"
+#include "unordered_loads.hpp"
+
+TEST_SUITE_BEGIN("json_stream_archive");
+
+TEST_CASE("json_stream_nested")
+{
+  test_json_stream_nested();
+}
+
+TEST_CASE("json_stream_large_arrays")
+{
+  test_json_stream_large_arrays();
+}
+
+TEST_CASE("json_stream_skipping")
+{
+  test_json_stream_skipping();
+}
+
+TEST_CASE("json_stream_errors")
+{
+  test_json_stream_errors();
+}
+
+TEST_CASE("json_stream_pod")
+{
+  test_pod<cereal::JSONStreamInputArchive, cereal::JSONOutputArchive>();
+}
+
+TEST_CASE("json_stream_vector")
+{
+  test_vector<cereal::JSONStreamInputArchive, cereal::JSONOutputArchive>();
+}
+
+TEST_CASE("json_stream_map")
+{
+  test_map<cereal::JSONStreamInputArchive, cereal::JSONOutputArchive>();
+}
+
+TEST_CASE("json_stream_map_memory")
+{
+  test_map_memory<cereal::JSONStreamInputArchive, cereal::JSONOutputArchive>();
+}
+
+TEST_CASE("json_stream_string")
+{
+  test_string_basic<cereal::JSONStreamInputArchive, cereal::JSONOutputArchive>();
+}
+
+TEST_CASE("json_stream_structs")
+{
+  test_structs<cereal::JSONStreamInputArchive, cereal::JSONOutputArchive>();
+}
+
+TEST_CASE("json_stream_memory")
+{
+  test_memory<cereal::JSONStreamInputArchive, cereal::JSONOutputArchive>();
+}
+
+TEST_CASE("json_stream_default_construction")
+{
+  test_default_construction<cereal::JSONStreamInputArchive, cereal::JSONOutputArchive>();
+}
+
+TEST_CASE("json_stream_polymorphic")
+{
+  test_polymorphic<cereal::JSONStreamInputArchive, cereal::JSONOutputArchive>();
+}
+
+TEST_CASE("json_stream_versioning")
+{
+  test_versioning<cereal::JSONStreamInputArchive, cereal::JSONOutputArchive>();
+}
+
+TEST_CASE("json_stream_unordered_loads")
+{
+  test_unordered_loads<cereal::JSONStreamInputArchive, cereal::JSONOutputArchive>();
+  test_unordered_loads_wide<cereal::JSONStreamInputArchive, cereal::JSONOutputArchive>();
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,223 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_JSON_STREAM_ARCHIVE_H_
+#define CEREAL_TEST_JSON_STREAM_ARCHIVE_H_
+#include <cereal/archives/json_stream.hpp>
+#include "common.hpp"
+
+struct json_stream_nested
+{
+  std::string name;
+  std::vector<std::map<std::string, std::vector<double>>> tables;
+  std::vector<std::vector<int>> grid;
+  int id;
+
+  template <class Archive>
+  void save( Archive & ar ) const
+  {
+    ar( CEREAL_NVP(name), CEREAL_NVP(tables), CEREAL_NVP(grid), CEREAL_NVP(id) );
+  }
+
+  // loads members in a different order than they were saved
+  template <class Archive>
+  void load( Archive & ar )
+  {
+    ar( CEREAL_NVP(id), CEREAL_NVP(grid), CEREAL_NVP(name), CEREAL_NVP(tables) );
+  }
+
+  bool operator==( json_stream_nested const & other ) const
+  {
+    return name == other.name && tables == other.tables && grid == other.grid && id == other.id;
+  }
+};
+
+std::ostream& operator<<(std::ostream& os, json_stream_nested const & s)
+{
+  os << "[name: " << s.name << " id: " << s.id << " tables: " << s.tables.size() << " grid: " << s.grid.size() << "]";
+  return os;
+}
+
+template <class T> inline
+std::string save_json( T const & data )
+{
+  std::ostringstream os;
+  {
+    cereal::JSONOutputArchive oar(os);
+    oar( data );
+  }
+  return os.str();
+}
+
+inline json_stream_nested random_json_stream_nested( std::mt19937 & gen )
+{
+  json_stream_nested n;
+  n.name = random_basic_string<char>( gen );
+  n.id = random_value<int>( gen );
+
+  n.tables.resize( random_index( 0, 4, gen ) );
+  for( auto & table : n.tables )
+    for( size_t i = 0, size = random_index( 0, 4, gen ); i < size; ++i )
+    {
+      auto & values = table[random_basic_string<char>( gen )];
+      values.resize( random_index( 0, 4, gen ) );
+      for( auto & v : values )
+        v = random_value<double>( gen );
+    }
+
+  n.grid.resize( random_index( 0, 4, gen ) );
+  for( auto & row : n.grid )
+  {
+    row.resize( random_index( 0, 4, gen ) );
+    for( auto & v : row )
+      v = random_value<int>( gen );
+  }
+
+  return n;
+}
+
+// Loads nested data out of order, which replays buffered members, from seekable and unseekable streams
+inline void test_json_stream_nested()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<100; ++ii)
+  {
+    std::vector<json_stream_nested> o_data( random_index( 0, 10, gen ) );
+    for( auto & d : o_data )
+      d = random_json_stream_nested( gen );
+
+    auto const json = save_json( o_data );
+
+    std::vector<json_stream_nested> i_data;
+    {
+      std::istringstream is( json );
+      cereal::JSONStreamInputArchive iar(is);
+      iar( i_data );
+    }
+    check_collection( i_data, o_data );
+
+    std::vector<json_stream_nested> i_data_unseekable;
+    {
+      unseekable_stringbuf buffer( json );
+      std::istream is( &buffer );
+      cereal::JSONStreamInputArchive iar(is);
+      iar( i_data_unseekable );
+    }
+    check_collection( i_data_unseekable, o_data );
+  }
+}
+
+// Counts arrays larger than the internal read buffer, which requires reading ahead in the stream,
+// or buffering the array if the stream cannot be repositioned
+inline void test_json_stream_large_arrays()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<std::vector<std::string>> o_data( 3 );
+  for( auto & strings : o_data )
+  {
+    strings.resize( random_index( 10000, 20000, gen ) );
+    for( auto & s : strings )
+      s = random_basic_string<char>( gen ) + "\"],{";
+  }
+
+  auto const json = save_json( o_data );
+  REQUIRE( json.size() > 256 * 1024 );
+
+  std::vector<std::vector<std::string>> i_data;
+  {
+    std::istringstream is( json );
+    cereal::JSONStreamInputArchive iar(is);
+    iar( i_data );
+  }
+
+  REQUIRE( i_data.size() == o_data.size() );
+  for( size_t i = 0; i < o_data.size(); ++i )
+    CHECK( i_data[i] == o_data[i] );
+
+  std::vector<std::vector<std::string>> i_data_unseekable;
+  {
+    unseekable_stringbuf buffer( json );
+    std::istream is( &buffer );
+    cereal::JSONStreamInputArchive iar(is);
+    iar( i_data_unseekable );
+  }
+
+  CHECK( i_data_unseekable == o_data );
+}
+
+// Members that are not loaded are skipped
+inline void test_json_stream_skipping()
+{
+  std::istringstream is( R"({ "value0": { "a": [1, [2, 3], {"b": 4}], "c": "}", "d": 5 }, "value1": 6 })" );
+  cereal::JSONStreamInputArchive iar(is);
+
+  int d = 0, value1 = 0;
+  iar.startNode();
+  iar( cereal::make_nvp( "d", d ) );
+  iar.finishNode();
+  iar( value1 );
+
+  CHECK_EQ( d, 5 );
+  CHECK_EQ( value1, 6 );
+
+  int missing;
+  CHECK_THROWS_AS( iar( missing ), cereal::Exception );
+}
+
+inline void test_json_stream_errors()
+{
+  {
+    std::istringstream is( R"({ "value0": [1, 2,, 3] })" );
+    cereal::JSONStreamInputArchive iar(is);
+    std::vector<int> v;
+    CHECK_THROWS_AS( iar( v ), cereal::Exception );
+  }
+
+  {
+    std::istringstream is( R"({ "value0": "text" })" );
+    cereal::JSONStreamInputArchive iar(is);
+    int i;
+    CHECK_THROWS_AS( iar( i ), cereal::Exception );
+  }
+
+  {
+    std::istringstream is( R"({ "value0": -1 })" );
+    cereal::JSONStreamInputArchive iar(is);
+    std::uint32_t i;
+    CHECK_THROWS_AS( iar( i ), cereal::Exception );
+  }
+
+  {
+    std::istringstream is( "3" );
+    CHECK_THROWS_AS( cereal::JSONStreamInputArchive iar(is), cereal::Exception );
+  }
+}
+
+#endif // CEREAL_TEST_JSON_STREAM_ARCHIVE_H_
@@ -0,0 +1,73 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "memcpy.hpp"
+
+TEST_SUITE_BEGIN("memcpy");
+
+TEST_CASE("memcpy_layout")
+{
+  test_memcpy_layout();
+}
+
+TEST_CASE("binary_memcpy")
+{
+  test_memcpy<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+TEST_CASE("portable_binary_memcpy")
+{
+  test_memcpy<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+TEST_CASE("portable_binary_memcpy_endianness")
+{
+  test_memcpy_portable_endianness();
+}
+
+TEST_CASE("compact_binary_memcpy")
+{
+  test_memcpy<cereal::CompactBinaryInputArchive, cereal::CompactBinaryOutputArchive>();
+}
+
+TEST_CASE("json_memcpy")
+{
+  test_memcpy<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+TEST_CASE("random_access_memcpy")
+{
+  // a block is indexed by its stride rather than the offset of each element
+  test_memcpy<cereal::RandomAccessInputArchive, cereal::RandomAccessOutputArchive>( false );
+}
+
+TEST_CASE("binary_buffer_and_random_access_memcpy")
+{
+  test_memcpy_buffer_and_random_access();
+}
+
+TEST_SUITE_END();
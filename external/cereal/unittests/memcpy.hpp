@@ -0,0 +1,346 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_MEMCPY_H_
+#define CEREAL_TEST_MEMCPY_H_
+#include "common.hpp"
+#include <cereal/archives/binary_buffer.hpp>
+#include <cereal/archives/compact_binary.hpp>
+#include <cereal/archives/random_access.hpp>
+#include <algorithm>
+#include <cstring>
+
+// Each of these types is marked memcpy serializable when Memcpy is true, and is otherwise
+// identical, so the two can be compared byte for byte
+template <bool Memcpy>
+struct MemcpyPoint
+{
+  float x, y, z;
+  std::int32_t id;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( x, y, CEREAL_NVP(z), id );
+  }
+
+  bool operator==( MemcpyPoint const & other ) const
+  {
+    return x == other.x && y == other.y && z == other.z && id == other.id;
+  }
+};
+
+template <bool Memcpy>
+struct MemcpyNested
+{
+  MemcpyPoint<Memcpy> point;
+  std::uint16_t flags[2];
+  std::int32_t weight;
+
+  bool operator==( MemcpyNested const & other ) const
+  {
+    return point == other.point && flags[0] == other.flags[0] && flags[1] == other.flags[1] && weight == other.weight;
+  }
+};
+
+template <class Archive, bool Memcpy> inline
+void save( Archive & ar, MemcpyNested<Memcpy> const & n )
+{
+  ar( n.point, n.flags, n.weight );
+}
+
+template <class Archive, bool Memcpy> inline
+void load( Archive & ar, MemcpyNested<Memcpy> & n )
+{
+  ar( n.point, n.flags, n.weight );
+}
+
+// Padding between the members, so always serialized one element at a time
+template <bool Memcpy>
+struct MemcpyPadded
+{
+  std::uint8_t tag;
+  double value;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( tag, value );
+  }
+
+  bool operator==( MemcpyPadded const & other ) const
+  {
+    return tag == other.tag && value == other.value;
+  }
+};
+
+// The class version is saved outside of the object, so always serialized one element at a time
+template <bool Memcpy>
+struct MemcpyVersioned
+{
+  std::int32_t value;
+
+  template <class Archive>
+  void serialize( Archive & ar, std::uint32_t const )
+  {
+    ar( value );
+  }
+
+  bool operator==( MemcpyVersioned const & other ) const
+  {
+    return value == other.value;
+  }
+};
+
+CEREAL_MEMCPY_SERIALIZABLE( MemcpyPoint<true> )
+CEREAL_MEMCPY_SERIALIZABLE( MemcpyNested<true> )
+CEREAL_MEMCPY_SERIALIZABLE( MemcpyPadded<true> )
+CEREAL_MEMCPY_SERIALIZABLE( MemcpyVersioned<true> )
+CEREAL_CLASS_VERSION( MemcpyVersioned<true>, 3 )
+CEREAL_CLASS_VERSION( MemcpyVersioned<false>, 3 )
+
+inline void random_memcpy_value( MemcpyPoint<true> & p, std::mt19937 & gen )
+{
+  p.x = random_value<float>(gen);
+  p.y = random_value<float>(gen);
+  p.z = random_value<float>(gen);
+  p.id = random_value<std::int32_t>(gen);
+}
+
+inline void random_memcpy_value( MemcpyNested<true> & n, std::mt19937 & gen )
+{
+  random_memcpy_value( n.point, gen );
+  n.flags[0] = random_value<std::uint16_t>(gen);
+  n.flags[1] = random_value<std::uint16_t>(gen);
+  n.weight = random_value<std::int32_t>(gen);
+}
+
+inline void random_memcpy_value( MemcpyPadded<true> & p, std::mt19937 & gen )
+{
+  p.tag = random_value<std::uint8_t>(gen);
+  p.value = random_value<double>(gen);
+}
+
+inline void random_memcpy_value( MemcpyVersioned<true> & v, std::mt19937 & gen )
+{
+  v.value = random_value<std::int32_t>(gen);
+}
+
+template <class T> inline
+bool memcpy_equal( T const * t, T const * u, std::size_t count )
+{
+  return std::equal( t, t + count, u );
+}
+
+// Copies values between the memcpy serializable and plain variants of a type
+template <class T, class U> inline
+void memcpy_copy( T const * from, U * to, std::size_t count )
+{
+  static_assert( sizeof(T) == sizeof(U), "memcpy_copy copies between types with the same layout" );
+  if( count > 0 )
+    std::memcpy( static_cast<void *>( to ), from, count * sizeof(T) );
+}
+
+// Saves containers of a memcpy serializable type and of its plain variant, which must
+// produce the same output unless the archive indexes elements differently when they are
+// saved as one block, then loads them back through the memcpy serializable path
+template <class IArchive, class OArchive, template <bool> class T> inline
+void test_memcpy_type( std::mt19937 & gen, std::size_t size, bool sameOutput )
+{
+  std::vector<T<true>> o_vector( size );
+  for( auto & v : o_vector )
+    random_memcpy_value( v, gen );
+
+  std::array<T<true>, 7> o_array;
+  for( auto & v : o_array )
+    random_memcpy_value( v, gen );
+
+  std::valarray<T<true>> o_valarray( 5 );
+  for( auto & v : o_valarray )
+    random_memcpy_value( v, gen );
+
+  std::vector<T<false>> o_plainVector( size );
+  std::array<T<false>, 7> o_plainArray;
+  std::valarray<T<false>> o_plainValarray( 5 );
+  memcpy_copy( o_vector.data(), o_plainVector.data(), size );
+  memcpy_copy( o_array.data(), o_plainArray.data(), 7 );
+  memcpy_copy( &o_valarray[0], &o_plainValarray[0], 5 );
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_vector, o_array, o_valarray, o_vector );
+  }
+
+  std::ostringstream plainOs;
+  {
+    OArchive oar(plainOs);
+    oar( o_plainVector, o_plainArray, o_plainValarray, o_plainVector );
+  }
+
+  if( sameOutput )
+    CHECK_EQ( os.str(), plainOs.str() );
+
+  // the second vector loads into one that is already large enough
+  std::vector<T<true>> i_vector;
+  std::array<T<true>, 7> i_array;
+  std::valarray<T<true>> i_valarray;
+  std::vector<T<true>> i_sizedVector( size + 3 );
+
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( i_vector, i_array, i_valarray, i_sizedVector );
+  }
+
+  CHECK_EQ( i_vector.size(), size );
+  CHECK( memcpy_equal( i_vector.data(), o_vector.data(), size ) );
+  CHECK( memcpy_equal( i_array.data(), o_array.data(), 7 ) );
+  CHECK_EQ( i_valarray.size(), 5 );
+  CHECK( memcpy_equal( &i_valarray[0], &o_valarray[0], 5 ) );
+  CHECK_EQ( i_sizedVector.size(), size );
+  CHECK( memcpy_equal( i_sizedVector.data(), o_vector.data(), size ) );
+}
+
+template <class IArchive, class OArchive> inline
+void test_memcpy( bool sameOutput = true )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  // the largest size spans several of the chunks that vectors are loaded in
+  for( std::size_t size : {0, 1, 100, 1000} )
+  {
+    test_memcpy_type<IArchive, OArchive, MemcpyPoint>( gen, size, sameOutput );
+    test_memcpy_type<IArchive, OArchive, MemcpyNested>( gen, size, sameOutput );
+    test_memcpy_type<IArchive, OArchive, MemcpyPadded>( gen, size, sameOutput );
+    test_memcpy_type<IArchive, OArchive, MemcpyVersioned>( gen, size, sameOutput );
+  }
+}
+
+inline void test_memcpy_layout()
+{
+  auto const & point = cereal::common_detail::memcpyLayout<MemcpyPoint<true>>();
+  CHECK( point.packed );
+  CHECK( point.fields == std::vector<std::size_t>({4, 4, 4, 4}) );
+
+  auto const & nested = cereal::common_detail::memcpyLayout<MemcpyNested<true>>();
+  CHECK( nested.packed );
+  CHECK( nested.fields == std::vector<std::size_t>({4, 4, 4, 4, 2, 2, 4}) );
+
+  CHECK_FALSE( cereal::common_detail::memcpyLayout<MemcpyPadded<true>>().packed );
+  CHECK_FALSE( cereal::common_detail::memcpyLayout<MemcpyVersioned<true>>().packed );
+}
+
+// Portable binary swaps each member individually when the endianness differs
+inline void test_memcpy_portable_endianness()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<MemcpyNested<true>> o_vector( 1000 );
+  for( auto & v : o_vector )
+    random_memcpy_value( v, gen );
+
+  std::vector<MemcpyNested<false>> o_plainVector( o_vector.size() );
+  memcpy_copy( o_vector.data(), o_plainVector.data(), o_vector.size() );
+
+  for( auto const & options : { cereal::PortableBinaryOutputArchive::Options::LittleEndian(),
+                                cereal::PortableBinaryOutputArchive::Options::BigEndian() } )
+  {
+    std::ostringstream os;
+    {
+      cereal::PortableBinaryOutputArchive oar( os, options );
+      oar( o_vector );
+    }
+
+    std::ostringstream plainOs;
+    {
+      cereal::PortableBinaryOutputArchive oar( plainOs, options );
+      oar( o_plainVector );
+    }
+
+    CHECK_EQ( os.str(), plainOs.str() );
+
+    std::vector<MemcpyNested<true>> i_vector;
+    std::istringstream is( os.str() );
+    {
+      cereal::PortableBinaryInputArchive iar( is );
+      iar( i_vector );
+    }
+
+    CHECK_EQ( i_vector.size(), o_vector.size() );
+    CHECK( memcpy_equal( i_vector.data(), o_vector.data(), o_vector.size() ) );
+  }
+}
+
+// Binary buffer archives read the same data as binary archives, and random access archives
+// can load single elements of a vector saved as one block
+inline void test_memcpy_buffer_and_random_access()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<MemcpyPoint<true>> o_vector( 1000 );
+  for( auto & v : o_vector )
+    random_memcpy_value( v, gen );
+
+  {
+    std::vector<char> buffer;
+    {
+      cereal::BinaryBufferOutputArchive oar( buffer );
+      oar( o_vector );
+    }
+
+    std::vector<MemcpyPoint<true>> i_vector;
+    cereal::BinaryBufferInputArchive iar( buffer.data(), buffer.size() );
+    iar( i_vector );
+
+    CHECK_EQ( i_vector.size(), o_vector.size() );
+    CHECK( memcpy_equal( i_vector.data(), o_vector.data(), o_vector.size() ) );
+  }
+
+  {
+    std::ostringstream os;
+    {
+      cereal::RandomAccessOutputArchive oar( os );
+      oar( cereal::make_nvp( "points", o_vector ) );
+    }
+
+    std::istringstream is( os.str() );
+    cereal::RandomAccessInputArchive iar( is );
+    CHECK_EQ( iar.fieldSize( "points" ), o_vector.size() );
+
+    for( std::size_t index : {0, 1, 500, 999} )
+    {
+      MemcpyPoint<true> point;
+      iar.loadElement( "points", index, point );
+      CHECK( memcpy_equal( &point, &o_vector[index], 1 ) );
+    }
+  }
+}
+
+#endif // CEREAL_TEST_MEMCPY_H_
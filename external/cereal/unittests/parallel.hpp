@@ -0,0 +1,221 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_PARALLEL_H_
+#define CEREAL_TEST_PARALLEL_H_
+#include <cereal/types/parallel.hpp>
+#include <cereal/archives/binary_buffer.hpp>
+#include <cereal/archives/compact_binary.hpp>
+#include "common.hpp"
+
+template <class IArchive, class OArchive> inline
+void test_parallel()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for( std::size_t threads : {1, 2, 4} )
+    for( std::size_t chunkSize : {1, 7, 1000} )
+    {
+      std::vector<int> o_podvector( random_index( 0, 3000, gen ) );
+      for( auto & v : o_podvector )
+        v = random_value<int>( gen );
+
+      std::vector<std::string> o_stringvector( random_index( 0, 100, gen ) );
+      for( auto & s : o_stringvector )
+        s = random_value<std::string>( gen );
+
+      std::vector<StructInternalSerialize> o_iservector( random_index( 0, 100, gen ) );
+      for( auto & s : o_iservector )
+        s = StructInternalSerialize( random_value<int>( gen ), random_value<int>( gen ) );
+
+      std::map<int, std::string> o_podmap;
+      for( int j = 0, size = random_value<int>( gen ) % 100; j < size; ++j )
+        o_podmap.insert( {random_value<int>( gen ), random_value<std::string>( gen )} );
+
+      std::unordered_map<std::string, StructExternalSerialize> o_esermap;
+      for( int j = 0, size = random_value<int>( gen ) % 100; j < size; ++j )
+        o_esermap.insert( {random_value<std::string>( gen ), { random_value<int>( gen ), random_value<int>( gen ) }} );
+
+      int const o_before = random_value<int>( gen ), o_after = random_value<int>( gen );
+
+      std::ostringstream os;
+      {
+        OArchive oar(os);
+
+        oar( o_before );
+        oar( cereal::make_parallel( o_podvector, threads, chunkSize ) );
+        oar( cereal::make_parallel( o_stringvector, threads, chunkSize ) );
+        oar( cereal::make_parallel( o_iservector, threads, chunkSize ) );
+        oar( cereal::make_parallel( o_podmap, threads, chunkSize ) );
+        oar( cereal::make_parallel( o_esermap, threads, chunkSize ) );
+        oar( o_after );
+      }
+
+      int i_before, i_after;
+      std::vector<int> i_podvector;
+      std::vector<std::string> i_stringvector;
+      std::vector<StructInternalSerialize> i_iservector;
+      std::map<int, std::string> i_podmap;
+      std::unordered_map<std::string, StructExternalSerialize> i_esermap;
+
+      // the number of threads loading does not need to match the number saving
+      std::istringstream is(os.str());
+      {
+        IArchive iar(is);
+
+        iar( i_before );
+        iar( cereal::make_parallel( i_podvector, 3 ) );
+        iar( cereal::make_parallel( i_stringvector ) );
+        iar( cereal::make_parallel( i_iservector, 1 ) );
+        iar( cereal::make_parallel( i_podmap, 2 ) );
+        iar( cereal::make_parallel( i_esermap, 5 ) );
+        iar( i_after );
+      }
+
+      CHECK_EQ( i_before, o_before );
+      check_collection( i_podvector, o_podvector );
+      check_collection( i_stringvector, o_stringvector );
+      check_collection( i_iservector, o_iservector );
+      check_collection( i_podmap, o_podmap );
+      CHECK( i_esermap == o_esermap );
+      CHECK_EQ( i_after, o_after );
+    }
+}
+
+// Text archives serialize the container exactly as they would without the wrapper
+template <class IArchive, class OArchive> inline
+void test_parallel_text()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<int> o_podvector( random_index( 0, 100, gen ) );
+  for( auto & v : o_podvector )
+    v = random_value<int>( gen );
+
+  std::map<std::string, int> o_podmap;
+  for( int j = 0; j < 100; ++j )
+    o_podmap.insert( {random_value<std::string>( gen ), random_value<int>( gen )} );
+
+  std::ostringstream parallel, sequential;
+  {
+    OArchive oar(parallel);
+    oar( cereal::make_parallel( o_podvector, 4, 10 ), cereal::make_parallel( o_podmap, 4, 10 ) );
+  }
+  {
+    OArchive oar(sequential);
+    oar( o_podvector, o_podmap );
+  }
+
+  CHECK_EQ( parallel.str(), sequential.str() );
+
+  std::vector<int> i_podvector;
+  std::map<std::string, int> i_podmap;
+
+  std::istringstream is(parallel.str());
+  {
+    IArchive iar(is);
+    iar( cereal::make_parallel( i_podvector ), cereal::make_parallel( i_podmap ) );
+  }
+
+  check_collection( i_podvector, o_podvector );
+  check_collection( i_podmap, o_podmap );
+}
+
+// Chunks are written and read directly in the memory of buffer archives, and are compatible with the binary archives
+inline void test_parallel_buffer()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<std::string> o_stringvector( random_index( 0, 1000, gen ) );
+  for( auto & s : o_stringvector )
+    s = random_value<std::string>( gen );
+
+  std::vector<char> buffer;
+  {
+    cereal::BinaryBufferOutputArchive oar(buffer);
+    oar( cereal::make_parallel( o_stringvector, 4, 10 ) );
+  }
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    oar( cereal::make_parallel( o_stringvector, 2, 10 ) );
+  }
+  CHECK( std::string( buffer.begin(), buffer.end() ) == os.str() );
+
+  std::vector<std::string> i_stringvector;
+  {
+    cereal::BinaryBufferInputArchive iar(buffer);
+    iar( cereal::make_parallel( i_stringvector, 4 ) );
+  }
+  check_collection( i_stringvector, o_stringvector );
+}
+
+struct ParallelThrows
+{
+  int value;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    if( value < 0 )
+      throw cereal::Exception( "negative" );
+    ar( value );
+  }
+};
+
+// Exceptions thrown on any thread are rethrown by the archive
+inline void test_parallel_exceptions()
+{
+  std::vector<ParallelThrows> o_data( 1000 );
+  for( int i = 0; i < 1000; ++i )
+    o_data[static_cast<std::size_t>( i )].value = i;
+  o_data[567].value = -1;
+
+  std::ostringstream os;
+  cereal::BinaryOutputArchive oar(os);
+  CHECK_THROWS_AS( oar( cereal::make_parallel( o_data, 4, 10 ) ), cereal::Exception );
+
+  // a truncated chunk
+  std::vector<int> o_podvector( 1000, 1 );
+  std::ostringstream truncated;
+  {
+    cereal::BinaryOutputArchive tar(truncated);
+    tar( cereal::make_parallel( o_podvector, 4, 100 ) );
+  }
+
+  auto data = truncated.str();
+  data.resize( data.size() - 1 );
+  std::istringstream is( data );
+  cereal::BinaryInputArchive iar(is);
+  std::vector<int> i_podvector;
+  CHECK_THROWS_AS( iar( cereal::make_parallel( i_podvector, 4 ) ), cereal::Exception );
+}
+
+#endif // CEREAL_TEST_PARALLEL_H_
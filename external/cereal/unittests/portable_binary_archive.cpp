@@ -131,4 +131,43 @@ TEST_CASE("portable_binary_archive_default_behavior")
   }
 }
 
+TEST_CASE("portable_binary_archive_swap_bytes_block")
+{
+  using namespace cereal::portable_binary_detail;
+
+  test_swap_bytes_block<2>( &swap_bytes_block_scalar<2> );
+  test_swap_bytes_block<4>( &swap_bytes_block_scalar<4> );
+  test_swap_bytes_block<8>( &swap_bytes_block_scalar<8> );
+  test_swap_bytes_block<16>( &swap_bytes_block_scalar<16> );
+
+  // whichever kernel is picked for this machine
+  test_swap_bytes_block<2>( &swap_bytes_block<2> );
+  test_swap_bytes_block<4>( &swap_bytes_block<4> );
+  test_swap_bytes_block<8>( &swap_bytes_block<8> );
+  test_swap_bytes_block<16>( &swap_bytes_block<16> );
+
+#ifdef CEREAL_PORTABLE_BINARY_X86_SIMD
+  if( __builtin_cpu_supports( "ssse3" ) )
+  {
+    test_swap_bytes_block<2>( &swap_bytes_block_ssse3<2> );
+    test_swap_bytes_block<4>( &swap_bytes_block_ssse3<4> );
+    test_swap_bytes_block<8>( &swap_bytes_block_ssse3<8> );
+    test_swap_bytes_block<16>( &swap_bytes_block_ssse3<16> );
+  }
+
+  if( __builtin_cpu_supports( "avx2" ) )
+  {
+    test_swap_bytes_block<2>( &swap_bytes_block_avx2<2> );
+    test_swap_bytes_block<4>( &swap_bytes_block_avx2<4> );
+    test_swap_bytes_block<8>( &swap_bytes_block_avx2<8> );
+    test_swap_bytes_block<16>( &swap_bytes_block_avx2<16> );
+  }
+#endif // CEREAL_PORTABLE_BINARY_X86_SIMD
+}
+
+TEST_CASE("portable_binary_archive_endian_bulk_conversions")
+{
+  test_endian_bulk_serialization();
+}
+
 TEST_SUITE_END();
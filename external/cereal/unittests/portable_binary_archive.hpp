@@ -153,4 +153,79 @@ void test_endian_serialization( typename IArchive::Options const & iOptions, typ
   }
 }
 
+// Checks a block byte swapping kernel against swapping every element on its own
+template <std::size_t DataSize> inline
+void test_swap_bytes_block( cereal::portable_binary_detail::swap_bytes_block_function kernel )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for( std::size_t elements = 0; elements < 100; ++elements )
+  {
+    std::vector<std::uint8_t> expected( elements * DataSize );
+    for( auto & b : expected )
+      b = random_value<std::uint8_t>(gen);
+
+    auto data = expected;
+    for( std::size_t i = 0; i < expected.size(); i += DataSize )
+      cereal::portable_binary_detail::swap_bytes<DataSize>( expected.data() + i );
+
+    kernel( data.data(), data.size() );
+    CHECK( data == expected );
+  }
+}
+
+// Saves large arithmetic containers with the opposite endianness and loads them back
+inline void test_endian_bulk_serialization()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  auto const opposite = cereal::portable_binary_detail::is_little_endian() ?
+    cereal::PortableBinaryOutputArchive::Options::BigEndian() :
+    cereal::PortableBinaryOutputArchive::Options::LittleEndian();
+
+  for( size_t i = 0; i < 10; ++i )
+  {
+    std::vector<double> o_double( random_index( 0, 5000, gen ) );
+    for( auto & elem : o_double )
+      elem = random_value<double>(gen);
+
+    std::vector<std::uint16_t> o_uint16( random_index( 0, 5000, gen ) );
+    for( auto & elem : o_uint16 )
+      elem = random_value<std::uint16_t>(gen);
+
+    std::array<std::uint32_t, 1027> o_uint32;
+    for( auto & elem : o_uint32 )
+      elem = random_value<std::uint32_t>(gen);
+
+    std::ostringstream os;
+    {
+      cereal::PortableBinaryOutputArchive oar(os, opposite);
+      oar( o_double, o_uint16, o_uint32 );
+    }
+
+    // the first value of the array sits at the very end of the archive, minus the rest of the array
+    std::uint32_t o_first = o_uint32.front();
+    swapBytes( o_first );
+    std::uint32_t i_first;
+    std::memcpy( &i_first, os.str().data() + os.str().size() - sizeof(o_uint32), sizeof(i_first) );
+    CHECK_EQ( i_first, o_first );
+
+    std::vector<double> i_double;
+    std::vector<std::uint16_t> i_uint16;
+    std::array<std::uint32_t, 1027> i_uint32;
+
+    std::istringstream is(os.str());
+    {
+      cereal::PortableBinaryInputArchive iar(is);
+      iar( i_double, i_uint16, i_uint32 );
+    }
+
+    CHECK( i_double == o_double );
+    CHECK( i_uint16 == o_uint16 );
+    CHECK( i_uint32 == o_uint32 );
+  }
+}
+
 #endif // CEREAL_TEST_PORTABLE_BINARY_ARCHIVE_H_
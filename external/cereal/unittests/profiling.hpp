@@ -0,0 +1,185 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_PROFILING_H_
+#define CEREAL_TEST_PROFILING_H_
+
+// profiling must be enabled in every translation unit, so before anything includes cereal
+#define CEREAL_PROFILING 1
+#include "common.hpp"
+#include <thread>
+
+struct ProfiledTree
+{
+  std::int32_t value = 0;
+  std::vector<ProfiledTree> children;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( value, children );
+  }
+};
+
+inline cereal::ProfileEntry const * find_profile_entry( std::vector<cereal::ProfileEntry> const & entries, std::string const & name )
+{
+  for( auto const & e : entries )
+    if( e.name == name )
+      return &e;
+  return nullptr;
+}
+
+template <class T> inline
+cereal::ProfileEntry const & profile_entry( std::vector<cereal::ProfileEntry> const & entries )
+{
+  auto const e = find_profile_entry( entries, cereal::util::demangledName<T>() );
+  REQUIRE( e != nullptr );
+  return *e;
+}
+
+//! headerSize is what the archive writes before the data, e.g. the endianness of portable archives
+template <class OArchive, class IArchive> inline
+void test_profile_binary( std::size_t headerSize )
+{
+  std::vector<StructInternalSerialize> const data( 100, StructInternalSerialize( 1, 2 ) );
+
+  cereal::Profile::reset();
+  std::ostringstream os;
+  {
+    OArchive oar( os );
+    oar( data );
+  }
+
+  auto const saved = cereal::Profile::collect();
+
+  auto const & vec = profile_entry<std::vector<StructInternalSerialize>>( saved.tree() );
+  CHECK( vec.calls == 1 );
+  CHECK( vec.bytes == os.str().size() - headerSize );
+  CHECK( vec.inclusiveNs >= vec.exclusiveNs );
+
+  auto const & element = profile_entry<StructInternalSerialize>( vec.children );
+  CHECK( element.calls == 100 );
+  CHECK( element.bytes == 100 * 2 * sizeof( int ) );
+  CHECK( element.inclusiveNs <= vec.inclusiveNs );
+  CHECK( profile_entry<int>( element.children ).calls == 200 );
+
+  auto const flat = saved.flat();
+  CHECK( profile_entry<int>( flat ).calls == 200 );
+  CHECK( profile_entry<int>( flat ).bytes == 200 * sizeof( int ) );
+  for( std::size_t i = 1; i < flat.size(); ++i )
+    CHECK( flat[i - 1].exclusiveNs >= flat[i].exclusiveNs );
+
+  cereal::Profile::reset();
+  std::vector<StructInternalSerialize> loaded;
+  {
+    std::istringstream is( os.str() );
+    IArchive iar( is );
+    iar( loaded );
+  }
+
+  auto const read = cereal::Profile::collect();
+  CHECK( profile_entry<std::vector<StructInternalSerialize>>( read.tree() ).bytes == os.str().size() - headerSize );
+  CHECK( profile_entry<StructInternalSerialize>( read.flat() ).calls == 100 );
+}
+
+inline void test_profile_recursive()
+{
+  ProfiledTree tree;
+  tree.children.resize( 3 );
+  tree.children[0].children.resize( 2 );
+
+  cereal::Profile::reset();
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os );
+    oar( tree );
+  }
+
+  auto const profile = cereal::Profile::collect();
+  auto const & outer = profile_entry<ProfiledTree>( profile.tree() );
+  CHECK( outer.calls == 1 );
+  CHECK( profile_entry<ProfiledTree>( profile_entry<std::vector<ProfiledTree>>( outer.children ).children ).calls == 3 );
+
+  // nested calls count, but their bytes and time are already part of the outermost one
+  auto const entries = profile.flat();
+  auto const & flat = profile_entry<ProfiledTree>( entries );
+  CHECK( flat.calls == 6 );
+  CHECK( flat.bytes == os.str().size() );
+  CHECK( flat.inclusiveNs == doctest::Approx( outer.inclusiveNs ) );
+}
+
+inline void test_profile_threads()
+{
+  cereal::Profile::reset();
+
+  auto const save = []()
+  {
+    std::ostringstream os;
+    cereal::BinaryOutputArchive oar( os );
+    oar( StructInternalSerialize( 1, 2 ) );
+  };
+
+  std::thread a( save );
+  std::thread b( save );
+  a.join();
+  b.join();
+  save();
+
+  auto const profile = cereal::Profile::collect();
+  REQUIRE( profile.tree().size() == 1 );
+  CHECK( profile_entry<StructInternalSerialize>( profile.tree() ).calls == 3 );
+
+  cereal::Profile::reset();
+  CHECK( cereal::Profile::collect().tree().empty() );
+}
+
+inline void test_profile_report()
+{
+  cereal::Profile::reset();
+  std::ostringstream os;
+  {
+    cereal::JSONOutputArchive oar( os );
+    oar( cereal::make_nvp( "data", std::vector<StructInternalSerialize>( 3 ) ) );
+  }
+
+  auto const profile = cereal::Profile::collect();
+
+  // text archives count calls and time, but not bytes
+  auto const & vec = profile_entry<std::vector<StructInternalSerialize>>( profile.tree() );
+  CHECK( vec.calls == 1 );
+  CHECK( vec.bytes == 0 );
+  CHECK( profile_entry<StructInternalSerialize>( vec.children ).calls == 3 );
+
+  std::ostringstream flat;
+  profile.printFlat( flat );
+  CHECK( flat.str().find( cereal::util::demangledName<StructInternalSerialize>() ) != std::string::npos );
+
+  std::ostringstream tree;
+  profile.printTree( tree );
+  CHECK( tree.str().find( "  " + cereal::util::demangledName<StructInternalSerialize>() ) != std::string::npos );
+}
+
+#endif // CEREAL_TEST_PROFILING_H_
@@ -0,0 +1,93 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "random_access_archive.hpp"
+#include "pod.hpp"
+#include "vector.hpp"
+#include "map.hpp"
+#include "basic_string.hpp"
+#include "structs.hpp"
+#include "versioning.hpp"
+
+TEST_SUITE_BEGIN("random_access_archive");
+
+TEST_CASE("random_access")
+{
+  test_random_access();
+}
+
+TEST_CASE("random_access_sequential")
+{
+  test_random_access_sequential();
+}
+
+TEST_CASE("random_access_errors")
+{
+  test_random_access_errors();
+}
+
+TEST_CASE("random_access_pod")
+{
+  test_pod<cereal::RandomAccessInputArchive, cereal::RandomAccessOutputArchive>();
+}
+
+TEST_CASE("random_access_vector")
+{
+  test_vector<cereal::RandomAccessInputArchive, cereal::RandomAccessOutputArchive>();
+}
+
+TEST_CASE("random_access_map")
+{
+  test_map<cereal::RandomAccessInputArchive, cereal::RandomAccessOutputArchive>();
+}
+
+TEST_CASE("random_access_map_memory")
+{
+  test_map_memory<cereal::RandomAccessInputArchive, cereal::RandomAccessOutputArchive>();
+}
+
+TEST_CASE("random_access_string")
+{
+  test_string_all<cereal::RandomAccessInputArchive, cereal::RandomAccessOutputArchive>();
+}
+
+TEST_CASE("random_access_structs")
+{
+  test_structs<cereal::RandomAccessInputArchive, cereal::RandomAccessOutputArchive>();
+}
+
+TEST_CASE("random_access_polymorphic")
+{
+  test_random_access_polymorphic();
+}
+
+TEST_CASE("random_access_versioning")
+{
+  test_versioning<cereal::RandomAccessInputArchive, cereal::RandomAccessOutputArchive>();
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,374 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_RANDOM_ACCESS_ARCHIVE_H_
+#define CEREAL_TEST_RANDOM_ACCESS_ARCHIVE_H_
+#include <cereal/archives/random_access.hpp>
+#include <cereal/types/polymorphic.hpp>
+#include "common.hpp"
+
+struct random_access_record
+{
+  std::uint32_t id;
+  std::string name;
+  std::vector<double> values;
+  std::shared_ptr<std::vector<int>> shared;
+  std::shared_ptr<std::vector<int>> alias;
+
+  template <class Archive>
+  void serialize( Archive & ar, std::uint32_t const version )
+  {
+    ar( CEREAL_NVP(id), CEREAL_NVP(name), CEREAL_NVP(values), CEREAL_NVP(shared), CEREAL_NVP(alias) );
+    CHECK_EQ( version, 3u );
+  }
+
+  bool operator==( random_access_record const & other ) const
+  {
+    return id == other.id && name == other.name && values == other.values &&
+           *shared == *other.shared && alias == shared && other.alias == other.shared;
+  }
+};
+
+CEREAL_CLASS_VERSION(random_access_record, 3)
+
+std::ostream& operator<<(std::ostream& os, random_access_record const & r)
+{
+  os << "[id: " << r.id << " name: " << r.name << " values: " << r.values.size() << "]";
+  return os;
+}
+
+inline random_access_record make_random_access_record( std::mt19937 & gen )
+{
+  random_access_record r;
+  r.id = random_value<std::uint32_t>( gen );
+  r.name = random_basic_string<char>( gen );
+  r.values.resize( random_index( 0, 10, gen ) );
+  for( auto & v : r.values )
+    v = random_value<double>( gen );
+  r.shared = std::make_shared<std::vector<int>>( random_index( 0, 10, gen ), random_value<int>( gen ) );
+  r.alias = r.shared;
+  return r;
+}
+
+struct random_access_base
+{
+  virtual ~random_access_base() = default;
+  virtual int get() const = 0;
+
+  template <class Archive>
+  void serialize( Archive & ) {}
+};
+
+struct random_access_derived : random_access_base
+{
+  random_access_derived() = default;
+  random_access_derived( int x_ ) : x( x_ ) {}
+  int x;
+
+  int get() const override { return x; }
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( cereal::base_class<random_access_base>( this ), x );
+  }
+};
+
+CEREAL_REGISTER_TYPE(random_access_derived)
+
+struct random_access_data
+{
+  std::vector<random_access_record> records;
+  std::vector<std::int64_t> numbers;
+  std::string text;
+  std::map<std::string, random_access_record> sorted;
+  std::unordered_map<std::uint32_t, std::string> unsorted;
+  std::vector<std::vector<int>> nested;
+  double scalar;
+};
+
+inline random_access_data make_random_access_data( std::mt19937 & gen )
+{
+  random_access_data d;
+  for( size_t i = 0; i < 200; ++i )
+    d.records.push_back( make_random_access_record( gen ) );
+  for( size_t i = 0; i < 1000; ++i )
+    d.numbers.push_back( random_value<std::int64_t>( gen ) );
+  d.text = random_basic_string<char>( gen );
+  for( size_t i = 0; i < 100; ++i )
+    d.sorted.emplace( random_basic_string<char>( gen ), make_random_access_record( gen ) );
+  for( size_t i = 0; i < 100; ++i )
+    d.unsorted.emplace( random_value<std::uint32_t>( gen ), random_basic_string<char>( gen ) );
+  for( size_t i = 0; i < 20; ++i )
+    d.nested.emplace_back( random_index( 0, 10, gen ), random_value<int>( gen ) );
+  d.scalar = random_value<double>( gen );
+  return d;
+}
+
+inline std::string save_random_access( random_access_data const & d )
+{
+  std::ostringstream os;
+  {
+    cereal::RandomAccessOutputArchive oar(os);
+    oar( cereal::make_nvp( "records", d.records ),
+         cereal::make_nvp( "numbers", d.numbers ),
+         cereal::make_nvp( "text", d.text ),
+         cereal::make_nvp( "sorted", d.sorted ),
+         cereal::make_nvp( "unsorted", d.unsorted ),
+         d.nested,
+         d.scalar );
+  }
+  return os.str();
+}
+
+inline void check_random_access( cereal::RandomAccessInputArchive & iar, random_access_data const & d, std::mt19937 & gen )
+{
+  CHECK( iar.hasField( "records" ) );
+  CHECK( iar.hasField( "value0" ) );
+  CHECK( iar.hasField( "value1" ) );
+  CHECK_FALSE( iar.hasField( "missing" ) );
+
+  CHECK_EQ( iar.fieldSize( "records" ), d.records.size() );
+  CHECK_EQ( iar.fieldSize( "numbers" ), d.numbers.size() );
+  CHECK_EQ( iar.fieldSize( "text" ), d.text.size() );
+  CHECK_EQ( iar.fieldSize( "sorted" ), d.sorted.size() );
+  CHECK_EQ( iar.fieldSize( "value0" ), d.nested.size() );
+
+  // fields, in any order
+  double scalar;
+  iar.loadField( "value1", scalar );
+  CHECK_EQ( scalar, d.scalar );
+
+  std::vector<std::vector<int>> nested;
+  iar.loadField( "value0", nested );
+  CHECK_EQ( nested, d.nested );
+
+  std::string text;
+  iar.loadField( "text", text );
+  CHECK_EQ( text, d.text );
+
+  std::unordered_map<std::uint32_t, std::string> unsorted;
+  iar.loadField( "unsorted", unsorted );
+  CHECK_EQ( unsorted, d.unsorted );
+
+  // single elements
+  for( size_t i = 0; i < 50; ++i )
+  {
+    auto const index = random_index( 0, d.records.size() - 1, gen );
+    random_access_record record;
+    iar.loadElement( "records", index, record );
+    CHECK_EQ( record, d.records[index] );
+
+    auto const number = random_index( 0, d.numbers.size() - 1, gen );
+    std::int64_t n;
+    iar.loadElement( "numbers", number, n );
+    CHECK_EQ( n, d.numbers[number] );
+
+    auto const inner = random_index( 0, d.nested.size() - 1, gen );
+    std::vector<int> v;
+    iar.loadElement( "value0", inner, v );
+    CHECK_EQ( v, d.nested[inner] );
+  }
+
+  // ranges of elements
+  std::vector<random_access_record> records;
+  iar.loadElements( "records", 10, 25, records );
+  check_collection( records, std::vector<random_access_record>( d.records.begin() + 10, d.records.begin() + 35 ) );
+
+  std::vector<std::int64_t> numbers;
+  iar.loadElements( "numbers", 900, 100, numbers );
+  check_collection( numbers, std::vector<std::int64_t>( d.numbers.begin() + 900, d.numbers.end() ) );
+
+  iar.loadElements( "numbers", d.numbers.size(), 0, numbers );
+  CHECK( numbers.empty() );
+
+  // map lookups
+  for( auto const & i : d.sorted )
+  {
+    random_access_record record;
+    CHECK( iar.loadMapValue( "sorted", i.first, record ) );
+    CHECK_EQ( record, i.second );
+  }
+
+  for( auto const & i : d.unsorted )
+  {
+    std::string value;
+    CHECK( iar.loadMapValue( "unsorted", i.first, value ) );
+    CHECK_EQ( value, i.second );
+  }
+
+  random_access_record record;
+  CHECK_FALSE( iar.loadMapValue( "sorted", std::string( "\x7f\x7f missing" ), record ) );
+  CHECK_FALSE( iar.loadMapValue( "sorted", std::string(), record ) );
+}
+
+inline void test_random_access()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for( size_t i = 0; i < 10; ++i )
+  {
+    auto const d = make_random_access_data( gen );
+    auto const saved = save_random_access( d );
+
+    {
+      std::istringstream is( saved );
+      cereal::RandomAccessInputArchive iar( is );
+      check_random_access( iar, d, gen );
+    }
+
+    {
+      cereal::RandomAccessInputArchive iar( saved.data(), saved.size() );
+      check_random_access( iar, d, gen );
+    }
+  }
+}
+
+// Loading on demand does not disturb sequential loading
+inline void test_random_access_sequential()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  auto const d = make_random_access_data( gen );
+  auto const saved = save_random_access( d );
+
+  // the archive may be preceded by other data in the stream
+  std::istringstream is( "prefix" + saved );
+  std::string prefix( 6, '\0' );
+  is.read( &prefix[0], 6 );
+
+  cereal::RandomAccessInputArchive iar( is );
+  random_access_data i;
+
+  iar( i.records );
+  check_random_access( iar, d, gen );
+  iar( i.numbers, i.text );
+  check_random_access( iar, d, gen );
+  iar( i.sorted, i.unsorted, i.nested, i.scalar );
+
+  check_collection( i.records, d.records );
+  check_collection( i.numbers, d.numbers );
+  CHECK_EQ( i.text, d.text );
+  CHECK_EQ( i.sorted, d.sorted );
+  CHECK_EQ( i.unsorted, d.unsorted );
+  CHECK_EQ( i.nested, d.nested );
+  CHECK_EQ( i.scalar, d.scalar );
+}
+
+inline void test_random_access_errors()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  auto const d = make_random_access_data( gen );
+  auto const saved = save_random_access( d );
+  cereal::RandomAccessInputArchive iar( saved.data(), saved.size() );
+
+  random_access_record record;
+  CHECK_THROWS_AS( iar.loadField( "missing", record ), cereal::Exception );
+  CHECK_THROWS_AS( iar.fieldSize( "value1" ), cereal::Exception );
+  CHECK_THROWS_AS( iar.loadElement( "records", d.records.size(), record ), cereal::Exception );
+
+  std::vector<std::int64_t> numbers;
+  CHECK_THROWS_AS( iar.loadElements( "numbers", 1, d.numbers.size(), numbers ), cereal::Exception );
+
+  std::int32_t narrow;
+  CHECK_THROWS_AS( iar.loadElement( "numbers", 0, narrow ), cereal::Exception );
+
+  CHECK_THROWS_AS( cereal::RandomAccessInputArchive( saved.data(), saved.size() - 1 ), cereal::Exception );
+  CHECK_THROWS_AS( cereal::RandomAccessInputArchive( saved.data(), 4 ), cereal::Exception );
+
+  unseekable_stringbuf buffer( saved );
+  std::istream is( &buffer );
+  CHECK_THROWS_AS( cereal::RandomAccessInputArchive iar2( is ), cereal::Exception );
+
+  // a directory position or field count in the footer that points past the footer
+  auto const footer = saved.size() - 2 * sizeof(std::uint64_t) - 8;
+  for( std::uint64_t const corrupt : { std::uint64_t( 1 ) << 32, std::uint64_t( footer + 1 ), std::uint64_t( -1 ) } )
+  {
+    auto directory = saved;
+    std::memcpy( &directory[footer], &corrupt, sizeof(corrupt) );
+    CHECK_THROWS_AS( cereal::RandomAccessInputArchive( directory.data(), directory.size() ), cereal::Exception );
+
+    auto fields = saved;
+    std::memcpy( &fields[footer + sizeof(std::uint64_t)], &corrupt, sizeof(corrupt) );
+    CHECK_THROWS_AS( cereal::RandomAccessInputArchive( fields.data(), fields.size() ), cereal::Exception );
+  }
+
+  // a stream that cannot be written to is left bad rather than holding an archive without an index
+  struct full_streambuf : std::streambuf {} full;
+  std::ostream os( &full );
+  {
+    cereal::RandomAccessOutputArchive oar( os );
+  }
+  CHECK( os.bad() );
+}
+
+// Each element of a container names its polymorphic types and shared pointers on its own
+inline void test_random_access_polymorphic()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<std::pair<std::shared_ptr<random_access_base>, std::shared_ptr<random_access_base>>> o_pointers;
+  for( size_t i = 0; i < 100; ++i )
+  {
+    std::shared_ptr<random_access_base> p = std::make_shared<random_access_derived>( random_value<int>( gen ) );
+    o_pointers.emplace_back( p, i % 2 ? p : std::make_shared<random_access_derived>( random_value<int>( gen ) ) );
+  }
+
+  std::ostringstream os;
+  {
+    cereal::RandomAccessOutputArchive oar(os);
+    oar( cereal::make_nvp( "pointers", o_pointers ) );
+  }
+
+  std::istringstream is( os.str() );
+  cereal::RandomAccessInputArchive iar( is );
+  for( size_t i = 0; i < 100; ++i )
+  {
+    auto const index = random_index( 0, o_pointers.size() - 1, gen );
+    std::pair<std::shared_ptr<random_access_base>, std::shared_ptr<random_access_base>> i_pointer;
+    iar.loadElement( "pointers", index, i_pointer );
+
+    CHECK_EQ( i_pointer.first->get(), o_pointers[index].first->get() );
+    CHECK_EQ( i_pointer.second->get(), o_pointers[index].second->get() );
+    CHECK_EQ( i_pointer.first == i_pointer.second, index % 2 == 1 );
+  }
+
+  decltype(o_pointers) i_pointers;
+  iar( i_pointers );
+  REQUIRE_EQ( i_pointers.size(), o_pointers.size() );
+  for( size_t i = 0; i < o_pointers.size(); ++i )
+  {
+    CHECK_EQ( i_pointers[i].first->get(), o_pointers[i].first->get() );
+    CHECK_EQ( i_pointers[i].first == i_pointers[i].second, i % 2 == 1 );
+  }
+}
+
+#endif // CEREAL_TEST_RANDOM_ACCESS_ARCHIVE_H_
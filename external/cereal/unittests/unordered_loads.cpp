@@ -39,4 +39,29 @@ TEST_CASE("json_unordered_loads")
   test_unordered_loads<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
 }
 
+TEST_CASE("xml_unordered_loads_wide")
+{
+  test_unordered_loads_wide<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+TEST_CASE("json_unordered_loads_wide")
+{
+  test_unordered_loads_wide<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+TEST_CASE("xml_unordered_loads_pointers")
+{
+  test_unordered_loads_pointers<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+TEST_CASE("json_unordered_loads_pointers")
+{
+  test_unordered_loads_pointers<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+TEST_CASE("binary_unordered_loads_pointer_ids")
+{
+  test_unordered_loads_pointer_ids();
+}
+
 TEST_SUITE_END();
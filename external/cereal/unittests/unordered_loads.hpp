@@ -146,4 +146,116 @@ void test_unordered_loads()
   }
 }
 
+// Loads many members of a single node in a random order, which makes
+// archives that index wide nodes use their index
+template <class IArchive, class OArchive> inline
+void test_unordered_loads_wide()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<10; ++ii)
+  {
+    // names are generated in order so that they are unique
+    std::vector<std::string> names( random_index( 1, 200, gen ) );
+    for( size_t i = 0; i < names.size(); ++i )
+      names[i] = random_basic_string<char>( gen ) + std::to_string( i );
+
+    std::vector<int> o_values( names.size() );
+    for( auto & value : o_values )
+      value = random_value<int>( gen );
+
+    std::ostringstream os;
+    {
+      OArchive oar(os);
+      for( size_t i = 0; i < names.size(); ++i )
+        oar( cereal::make_nvp( names[i], o_values[i] ) );
+    }
+
+    std::vector<size_t> order( names.size() );
+    for( size_t i = 0; i < order.size(); ++i )
+      order[i] = i;
+    std::shuffle( order.begin(), order.end(), gen );
+
+    std::vector<int> i_values( names.size() );
+    std::istringstream is(os.str());
+    {
+      IArchive iar(is);
+      for( auto i : order )
+        iar( cereal::make_nvp( names[i], i_values[i] ) );
+
+      int missing;
+      CHECK_THROWS_AS( iar( cereal::make_nvp( "not a name", missing ) ), cereal::Exception );
+    }
+
+    check_collection( i_values, o_values );
+  }
+}
+
+// Loads shared pointers in a different order than they were saved, so that
+// pointer ids are registered out of order
+template <class IArchive, class OArchive> inline
+void test_unordered_loads_pointers()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<100; ++ii)
+  {
+    auto const o_first = std::make_shared<int>( random_value<int>( gen ) );
+    auto const o_second = std::make_shared<int>( random_value<int>( gen ) );
+    auto const o_third = std::make_shared<int>( random_value<int>( gen ) );
+
+    std::ostringstream os;
+    {
+      OArchive oar(os);
+      oar( cereal::make_nvp( "first", o_first ),
+           cereal::make_nvp( "second", o_second ),
+           cereal::make_nvp( "third", o_third ),
+           cereal::make_nvp( "again", o_first ) );
+    }
+
+    std::shared_ptr<int> i_first, i_second, i_third, i_again;
+
+    std::istringstream is(os.str());
+    {
+      IArchive iar(is);
+      iar( cereal::make_nvp( "third", i_third ),
+           cereal::make_nvp( "first", i_first ),
+           cereal::make_nvp( "again", i_again ),
+           cereal::make_nvp( "second", i_second ) );
+    }
+
+    CHECK_EQ( *i_first, *o_first );
+    CHECK_EQ( *i_second, *o_second );
+    CHECK_EQ( *i_third, *o_third );
+    CHECK_EQ( i_again, i_first );
+  }
+}
+
+// Pointer ids read from the input that do not follow the ids before them, as corrupt input may
+// hold, are kept aside rather than growing the table of loaded pointers to the size of the id
+inline void test_unordered_loads_pointer_ids()
+{
+  auto const load = []( std::vector<std::uint32_t> const & words, std::shared_ptr<int> & first, std::shared_ptr<int> & second )
+  {
+    std::string const data( reinterpret_cast<const char *>( words.data() ), words.size() * sizeof(std::uint32_t) );
+    std::istringstream is( data );
+    cereal::BinaryInputArchive iar( is );
+    iar( first, second );
+  };
+
+  // a new pointer with id 0x7ffffff0 and the value 42, then a reference to it
+  std::shared_ptr<int> first, second;
+  load( { 0xfffffff0u, 42u, 0x7ffffff0u }, first, second );
+  REQUIRE( first );
+  CHECK_EQ( *first, 42 );
+  CHECK_EQ( second, first );
+
+  // a new pointer whose value is missing, and a reference to a pointer never loaded
+  CHECK_THROWS_AS( load( { 0xfffffff0u }, first, second ), cereal::Exception );
+  CHECK_THROWS_AS( load( { 0x7ffffff0u }, first, second ), cereal::Exception );
+  CHECK_THROWS_AS( load( { 0x80000005u, 1u, 0x7ffffff0u }, first, second ), cereal::Exception );
+}
+
 #endif // CEREAL_TEST_UNORDERED_LOADS_H_
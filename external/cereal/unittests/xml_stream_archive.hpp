@@ -0,0 +1,338 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_XML_STREAM_ARCHIVE_H_
+#define CEREAL_TEST_XML_STREAM_ARCHIVE_H_
+#include <cereal/archives/xml_stream.hpp>
+#include "common.hpp"
+
+struct xml_stream_record
+{
+  std::string name;
+  std::string padded;
+  std::string markup;
+  std::vector<int> values;
+  std::vector<std::string> empty;
+  std::map<std::string, std::vector<double>> tables;
+  std::array<uint8_t, 8> bytes;
+  bool flag;
+  char c;
+
+  template <class Archive>
+  void save( Archive & ar ) const
+  {
+    ar( CEREAL_NVP(name), CEREAL_NVP(padded), CEREAL_NVP(markup), CEREAL_NVP(values),
+        CEREAL_NVP(empty), CEREAL_NVP(tables), CEREAL_NVP(flag), c );
+    ar.saveBinaryValue( bytes.data(), bytes.size(), "bytes" );
+  }
+
+  // loads members in a different order than they were saved
+  template <class Archive>
+  void load( Archive & ar )
+  {
+    ar( CEREAL_NVP(tables), CEREAL_NVP(name), CEREAL_NVP(padded), CEREAL_NVP(markup),
+        CEREAL_NVP(values), CEREAL_NVP(empty), CEREAL_NVP(flag), c );
+    ar.loadBinaryValue( bytes.data(), bytes.size(), "bytes" );
+  }
+
+  bool operator==( xml_stream_record const & other ) const
+  {
+    return name == other.name && padded == other.padded && markup == other.markup && values == other.values &&
+           empty == other.empty && tables == other.tables && bytes == other.bytes && flag == other.flag && c == other.c;
+  }
+};
+
+std::ostream& operator<<(std::ostream& os, xml_stream_record const & s)
+{
+  os << "[name: " << s.name << " markup: " << s.markup << " values: " << s.values.size() << " tables: " << s.tables.size() << "]";
+  return os;
+}
+
+inline xml_stream_record random_xml_stream_record( std::mt19937 & gen )
+{
+  xml_stream_record r;
+  r.name = random_basic_string<char>( gen );
+  r.padded = std::string( random_index( 0, 2, gen ), ' ' ) + random_basic_string<char>( gen ) + std::string( random_index( 0, 2, gen ), '\t' );
+  r.markup = "<a href=\"x\">'" + random_basic_string<char>( gen ) + "' & </a>";
+
+  r.values.resize( random_index( 0, 10, gen ) );
+  for( auto & v : r.values )
+    v = random_value<int>( gen );
+
+  for( size_t i = 0, size = random_index( 0, 4, gen ); i < size; ++i )
+  {
+    auto & values = r.tables[random_basic_string<char>( gen )];
+    values.resize( random_index( 0, 4, gen ) );
+    for( auto & v : values )
+      v = random_value<double>( gen );
+  }
+
+  for( auto & b : r.bytes )
+    b = random_value<uint8_t>( gen );
+
+  r.flag = random_value<int>( gen ) % 2 == 0;
+  r.c = random_value<char>( gen ) % 2 == 0 ? '<' : 'x';
+  return r;
+}
+
+template <class OArchive, class T> inline
+std::string save_xml( T const & data, cereal::XMLOutputArchive::Options const & options = cereal::XMLOutputArchive::Options::Default() )
+{
+  std::ostringstream os;
+  {
+    OArchive oar(os, options);
+    oar( data );
+  }
+  return os.str();
+}
+
+template <class OArchive> inline
+void save_xml_mixed( OArchive & ar )
+{
+  ar( 1, std::string( " two " ) );
+  ar.startNode();
+  ar.saveValue( 3 );
+  ar.appendAttribute( "quote", "\"'" );
+  ar.saveValue( 4 );
+  ar.startNode();
+  ar.finishNode();
+  ar.saveValue( std::string( "" ) );
+  ar.finishNode();
+}
+
+// The streaming archive writes exactly what the XMLOutputArchive writes
+inline void test_xml_stream_output()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  cereal::XMLOutputArchive::Options const options[] = {
+    cereal::XMLOutputArchive::Options::Default(),
+    cereal::XMLOutputArchive::Options().indent( false ),
+    cereal::XMLOutputArchive::Options().precision( 5 ).outputType( true ).sizeAttributes( false ) };
+
+  for(int ii=0; ii<100; ++ii)
+  {
+    std::vector<xml_stream_record> o_data( random_index( 0, 10, gen ) );
+    for( auto & d : o_data )
+      d = random_xml_stream_record( gen );
+
+    for( auto const & o : options )
+      CHECK_EQ( save_xml<cereal::XMLStreamOutputArchive>( o_data, o ), save_xml<cereal::XMLOutputArchive>( o_data, o ) );
+  }
+
+  // values and children mixed in one node, attributes after a value
+  std::ostringstream dom, streaming;
+  {
+    cereal::XMLOutputArchive ar( dom );
+    save_xml_mixed( ar );
+  }
+  {
+    cereal::XMLStreamOutputArchive ar( streaming );
+    save_xml_mixed( ar );
+  }
+  CHECK_EQ( streaming.str(), dom.str() );
+
+  // an empty archive
+  std::ostringstream empty_dom, empty_streaming;
+  {
+    cereal::XMLOutputArchive ar( empty_dom );
+  }
+  {
+    cereal::XMLStreamOutputArchive ar( empty_streaming );
+  }
+  CHECK_EQ( empty_streaming.str(), empty_dom.str() );
+}
+
+// Either XML input archive loads the output of either XML output archive, with the streaming
+// input archive reading from seekable and unseekable streams
+inline void test_xml_stream_cross_loading()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<100; ++ii)
+  {
+    std::vector<xml_stream_record> o_data( random_index( 0, 10, gen ) );
+    for( auto & d : o_data )
+      d = random_xml_stream_record( gen );
+
+    auto const dom = save_xml<cereal::XMLOutputArchive>( o_data, cereal::XMLOutputArchive::Options().indent( false ) );
+    auto const streaming = save_xml<cereal::XMLStreamOutputArchive>( o_data );
+
+    std::vector<xml_stream_record> i_dom;
+    {
+      std::istringstream is( streaming );
+      cereal::XMLInputArchive iar(is);
+      iar( i_dom );
+    }
+    check_collection( i_dom, o_data );
+
+    std::vector<xml_stream_record> i_streaming;
+    {
+      std::istringstream is( dom );
+      cereal::XMLStreamInputArchive iar(is);
+      iar( i_streaming );
+    }
+    check_collection( i_streaming, o_data );
+
+    std::vector<xml_stream_record> i_unseekable;
+    {
+      unseekable_stringbuf buffer( streaming );
+      std::istream is( &buffer );
+      cereal::XMLStreamInputArchive iar(is);
+      iar( i_unseekable );
+    }
+    check_collection( i_unseekable, o_data );
+  }
+}
+
+// Counts nodes larger than the internal read buffer, which requires reading ahead in the stream,
+// or buffering the node if the stream cannot be repositioned
+inline void test_xml_stream_large_nodes()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<std::vector<std::string>> o_data( 3 );
+  for( auto & strings : o_data )
+  {
+    strings.resize( random_index( 10000, 20000, gen ) );
+    for( auto & s : strings )
+      s = random_basic_string<char>( gen ) + "</value0>/>'\"";
+  }
+
+  auto const xml = save_xml<cereal::XMLStreamOutputArchive>( o_data );
+  REQUIRE( xml.size() > 256 * 1024 );
+
+  std::vector<std::vector<std::string>> i_data;
+  {
+    std::istringstream is( xml );
+    cereal::XMLStreamInputArchive iar(is);
+    iar( i_data );
+  }
+  CHECK( i_data == o_data );
+
+  std::vector<std::vector<std::string>> i_data_unseekable;
+  {
+    unseekable_stringbuf buffer( xml );
+    std::istream is( &buffer );
+    cereal::XMLStreamInputArchive iar(is);
+    iar( i_data_unseekable );
+  }
+  CHECK( i_data_unseekable == o_data );
+}
+
+// Parses XML that cereal does not write itself, as rapidxml does
+inline void test_xml_stream_parsing()
+{
+  std::istringstream is(
+    "<?xml version=\"1.0\"?>\n<!DOCTYPE cereal [ <!ELEMENT cereal ANY> ]>\n<!-- comment -->\n"
+    "<cereal>\n"
+    "  <a>  &lt;&#65;&#x42;&amp;&unknown; </a>\n"
+    "  <b xml:space='preserve'>  x  </b>\n"
+    "  <c><!-- <d>1</d> --><?skip <d>2</d> ?><d>3</d><e/><d>4</d></c>\n"
+    "  <f><g><h>5</h></g><i>6</i></f>\n"
+    "  <j>7</j>\n"
+    "</cereal>" );
+  cereal::XMLStreamInputArchive iar(is);
+
+  std::string a, b;
+  std::vector<int> c;
+  int i = 0, j = 0;
+  iar( cereal::make_nvp( "a", a ), cereal::make_nvp( "b", b ) );
+
+  size_t size = 0;
+  iar.setNextName( "c" );
+  iar.startNode();
+  iar( cereal::make_size_tag( size ) );
+  CHECK_EQ( size, 3 );
+  iar( cereal::make_nvp( "d", j ) );
+  CHECK_EQ( j, 3 );
+  iar.finishNode();
+
+  // h is skipped
+  iar.setNextName( "f" );
+  iar.startNode();
+  CHECK_EQ( std::string( iar.getNodeName() ), "g" );
+  iar( cereal::make_nvp( "i", i ) );
+  iar.finishNode();
+  iar( cereal::make_nvp( "j", j ) );
+
+  CHECK_EQ( a, "<AB&&unknown;" );
+  CHECK_EQ( b, "  x  " );
+  CHECK_EQ( i, 6 );
+  CHECK_EQ( j, 7 );
+
+  CHECK_THROWS_AS( iar( i ), cereal::Exception );
+}
+
+inline void test_xml_stream_errors()
+{
+  {
+    std::istringstream is( "<cereal><value0>1</value0>" );
+    cereal::XMLStreamInputArchive iar(is);
+    int i;
+    iar( i );
+    CHECK_EQ( i, 1 );
+    CHECK_THROWS_AS( iar( i ), cereal::Exception );
+  }
+
+  {
+    std::istringstream is( "<cereal><value0 size=dynamic></value0></cereal>" );
+    cereal::XMLStreamInputArchive iar(is);
+    std::vector<int> v;
+    CHECK_THROWS_AS( iar( v ), cereal::Exception );
+  }
+
+  {
+    std::istringstream is( "<cereal><value0>text</value0></cereal>" );
+    cereal::XMLStreamInputArchive iar(is);
+    int i;
+    CHECK_THROWS_AS( iar( i ), std::exception );
+  }
+
+  {
+    std::istringstream is( "<other></other>" );
+    CHECK_THROWS_AS( cereal::XMLStreamInputArchive iar(is), cereal::Exception );
+  }
+
+  {
+    std::istringstream is( "" );
+    CHECK_THROWS_AS( cereal::XMLStreamInputArchive iar(is), cereal::Exception );
+  }
+
+  {
+    std::ostringstream os;
+    cereal::XMLStreamOutputArchive oar(os);
+    oar.startNode();
+    oar.startNode();
+    oar.finishNode();
+    CHECK_THROWS_AS( oar.appendAttribute( "late", "attribute" ), cereal::Exception );
+  }
+}
+
+#endif // CEREAL_TEST_XML_STREAM_ARCHIVE_H_
@@ -1,18 +1,26 @@
 #include <cereal/access.hpp>
+#include <cereal/archives/binary.hpp>
 #include <cereal/archives/json.hpp>
+#include <cereal/archives/portable_binary.hpp>
 #include <cereal/cereal.hpp>
+#include <cereal/types/array.hpp>
 #include <cereal/types/utility.hpp>
 #include <cereal/types/vector.hpp>
 
 #include <boost/mpl/list.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <ostream>
 #include <random>
 #include <sstream>
+#include <string_view>
 #include <type_traits>
 #include <typeinfo>
 #include <utility>
+#include <vector>
 
 namespace
 {
@@ -49,6 +57,15 @@ inline typename std::enable_if<std::is_same<T, std::string>::value, std::string>
     return s;
 }
 
+template <std::size_t N>
+inline std::array<char, N> random_chars(std::mt19937& gen)
+{
+    std::array<char, N> a{};
+    for (char& c : a)
+        c = static_cast<char>(std::uniform_int_distribution<int>('A', 'Z')(gen));
+    return a;
+}
+
 namespace v1
 {
 struct simple_data
@@ -270,6 +287,110 @@ std::ostream& operator<<(std::ostream& str, const simple_data& a)
 }
 } // namespace v7
 
+// v8 to v10 are trivially copyable variants of simple_data, with c held inline
+namespace v8
+{
+struct simple_data
+{
+    template <class Archive>
+    void serialize(Archive& ar)
+    {
+        ar(cereal::make_nvp("a", a), cereal::make_nvp("b", b), cereal::make_nvp("c", c));
+    }
+
+    bool operator==(const simple_data&) const = default;
+
+    int a{random_value<int>(gen)};
+    int b{random_value<int>(gen)};
+    std::array<char, 16> c{random_chars<16>(gen)};
+};
+
+std::ostream& operator<<(std::ostream& str, const simple_data& a)
+{
+    str << "a=" << a.a << " b=" << a.b << " c=" << std::string_view{a.c.data(), a.c.size()};
+
+    return str;
+}
+} // namespace v8
+
+namespace v9
+{
+struct simple_data
+{
+    bool operator==(const simple_data&) const = default;
+
+    std::int64_t a{random_value<std::int64_t>(gen)};
+    double b{random_value<double>(gen)};
+    float c{random_value<float>(gen)};
+    std::int32_t d{random_value<std::int32_t>(gen)};
+};
+
+template <class Archive>
+void save(Archive& archive, const simple_data& a)
+{
+    archive(a.a, a.b, a.c, a.d);
+}
+
+template <class Archive>
+void load(Archive& archive, simple_data& a)
+{
+    archive(a.a, a.b, a.c, a.d);
+}
+
+std::ostream& operator<<(std::ostream& str, const simple_data& a)
+{
+    str << "a=" << a.a << " b=" << a.b << " c=" << a.c << " d=" << a.d;
+
+    return str;
+}
+} // namespace v9
+
+// identical to v8, but serialized one element at a time
+namespace v10
+{
+struct simple_data
+{
+    template <class Archive>
+    void serialize(Archive& ar)
+    {
+        ar(cereal::make_nvp("a", a), cereal::make_nvp("b", b), cereal::make_nvp("c", c));
+    }
+
+    bool operator==(const simple_data&) const = default;
+
+    int a{random_value<int>(gen)};
+    int b{random_value<int>(gen)};
+    std::array<char, 16> c{random_chars<16>(gen)};
+};
+
+std::ostream& operator<<(std::ostream& str, const simple_data& a)
+{
+    str << "a=" << a.a << " b=" << a.b << " c=" << std::string_view{a.c.data(), a.c.size()};
+
+    return str;
+}
+} // namespace v10
+} // namespace
+
+CEREAL_MEMCPY_SERIALIZABLE(v8::simple_data)
+CEREAL_MEMCPY_SERIALIZABLE(v9::simple_data)
+
+namespace
+{
+template <class OArchive, class IArchive, class T>
+void roundtrip(const std::vector<T>& from, std::vector<T>& to)
+{
+    std::stringstream ss{};
+    {
+        OArchive archive{ss};
+        archive(from);
+    }
+    {
+        IArchive archive{ss};
+        archive(to);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE(cereal_tests)
 
 using test_types = boost::mpl::list<v1::simple_data,
@@ -278,7 +399,12 @@ using test_types = boost::mpl::list<v1::simple_data,
                                     v4::simple_data,
                                     v5::simple_data,
                                     v6::simple_data,
-                                    v7::simple_data>;
+                                    v7::simple_data,
+                                    v8::simple_data,
+                                    v9::simple_data,
+                                    v10::simple_data>;
+
+using pod_types = boost::mpl::list<v8::simple_data, v9::simple_data, v10::simple_data>;
 
 BOOST_AUTO_TEST_CASE_TEMPLATE(serialize_types, A, test_types)
 {
@@ -305,6 +431,21 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(serialize_types, A, test_types)
     }
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(serialize_pod_vectors, A, pod_types)
+{
+    static_assert(std::is_trivially_copyable_v<A>);
+
+    const std::vector<A> a(1000);
+
+    std::vector<A> b{};
+    roundtrip<cereal::BinaryOutputArchive, cereal::BinaryInputArchive>(a, b);
+    BOOST_CHECK(a == b);
+
+    std::vector<A> c{};
+    roundtrip<cereal::PortableBinaryOutputArchive, cereal::PortableBinaryInputArchive>(a, c);
+    BOOST_CHECK(a == c);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace